@@ -2850,6 +2850,13 @@ struct OrtApi {
    *  Use -1 to allow ORT to choose the default 1GB for max_power_of_two_extend_bytes.
    *  Ultimately, the allocation size is determined by the allocation memory request.
    *  Further allocation sizes are governed by the arena extend strategy.
+   * "max_thread_cache_bytes": Maximum bytes of small chunks (up to 4KB) each thread keeps for reuse without locking
+   *  the arena. Frees are returned to the arena in batches. Use it when many threads run sessions that share the
+   *  allocator. Use -1 to allow ORT to choose the default 0, which disables the per-thread cache.
+   * "use_slab_arena": 1 to serve allocations up to 4KB from slabs of fixed size blocks (64 bytes to 4KB in powers
+   *  of two) in O(1), and larger allocations from the arena as usual. It helps models with many small tensors like
+   *  shapes and indices. Only used for CPU accessible memory, and can't be combined with "max_thread_cache_bytes".
+   *  Use -1 to allow ORT to choose the default 0.
    *
    * \param[in] arena_config_keys Keys to configure the arena
    * \param[in] arena_config_values Values to configure the arena
@@ -5186,6 +5193,26 @@ struct OrtApi {
    * \since Version 1.22.
    */
   const OrtHardwareDevice*(ORT_API_CALL* EpDevice_Device)(_In_ const OrtEpDevice* ep_device);
+
+  /** \brief Set all strings at once in a string tensor from a single buffer
+   *
+   * The inverse of OrtApi::GetStringTensorContent, with the same layout: the strings are stored back to back in
+   * \p s, not null-terminated, and string i spans [offsets[i], offsets[i + 1]), the last one ending at \p s_len.
+   * Unlike OrtApi::FillStringTensor, the caller does not need to build an array of null-terminated strings and
+   * the length of each string is not recomputed.
+   *
+   * \param[in,out] value A tensor of type ONNX_TENSOR_ELEMENT_DATA_TYPE_STRING
+   * \param[in] s Buffer with the UTF-8 encoded strings
+   * \param[in] s_len Number of bytes in \p s
+   * \param[in] offsets Array of start offsets of the strings in \p s, in increasing order
+   * \param[in] offsets_len Number of elements in offsets (Must match the size of \p value's tensor shape)
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.23.
+   */
+  ORT_API2_STATUS(FillStringTensorFromBuffer, _Inout_ OrtValue* value, _In_reads_(s_len) const char* s,
+                  size_t s_len, _In_reads_(offsets_len) const size_t* offsets, size_t offsets_len);
 };
 
 /*
@@ -1789,6 +1789,16 @@ struct ValueImpl : ConstValueImpl<T> {
   /// <param name="s_len">[in] Count of strings in s (Must match the size of \p value's tensor shape)</param>
   void FillStringTensor(const char* const* s, size_t s_len);
 
+  /// <summary>
+  /// Set all strings at once in a string tensor from a buffer laid out as by GetStringTensorContent()
+  /// </summary>
+  /// <param name="buffer">[in] UTF-8 encoded strings stored back to back, not null terminated</param>
+  /// <param name="buffer_length">[in] length of the buffer in bytes</param>
+  /// <param name="offsets">[in] start offset of each string in the buffer</param>
+  /// <param name="offsets_count">[in] count of offsets (Must match the size of the tensor shape)</param>
+  void FillStringTensorFromBuffer(const char* buffer, size_t buffer_length, const size_t* offsets,
+                                  size_t offsets_count);  ///< Wraps OrtApi::FillStringTensorFromBuffer
+
   /// <summary>
   /// Set a single string in a string tensor
   /// </summary>
@@ -1915,6 +1915,12 @@ void ValueImpl<T>::FillStringTensor(const char* const* s, size_t s_len) {
   ThrowOnError(GetApi().FillStringTensor(this->p_, s, s_len));
 }
 
+template <typename T>
+void ValueImpl<T>::FillStringTensorFromBuffer(const char* buffer, size_t buffer_length, const size_t* offsets,
+                                              size_t offsets_count) {
+  ThrowOnError(GetApi().FillStringTensorFromBuffer(this->p_, buffer, buffer_length, offsets, offsets_count));
+}
+
 template <typename T>
 void ValueImpl<T>::FillStringTensorElement(const char* s, size_t index) {
   ThrowOnError(GetApi().FillStringTensorElement(this->p_, s, index));
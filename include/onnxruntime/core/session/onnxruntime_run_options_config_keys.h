@@ -46,6 +46,11 @@ static const char* const kOrtRunOptionsConfigQnnRpcControlLatency = "qnn.rpc_con
 // Set QNN Lora Config File for apply Lora in QNN context binary
 static const char* const kOrtRunOptionsConfigQnnLoraConfig = "qnn.lora_config";
 
+// Set to '1' to drop the values carried between runs by a session with kOrtSessionOptionsStatefulOutputInputPairs
+// before the run, like at the start of a new stream. The run must feed the carried inputs.
+// Per default it will be set to '0'
+static const char* const kOrtRunOptionsConfigResetSessionState = "session.reset_state";
+
 // Set graph annotation id for CUDA EP. Use with enable_cuda_graph=true.
 // The value should be an integer. If the value is not set, the default value is 0 and
 // ORT session only captures one cuda graph before another capture is requested.
@@ -342,6 +342,60 @@ static const char* const kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16 = "mlas
 // If not provided, default is 4.
 static const char* const kOrtSessionOptionsQDQMatMulNBitsAccuracyLevel = "session.qdq_matmulnbits_accuracy_level";
 
+// Size in bytes of the cache of prompt past state in GreedySearch and Sampling operators for GPT models on CPU.
+// The cache is shared by Run calls of a session. A prompt of a single sequence sharing its first tokens with a cached
+// prompt (like a system prompt shared by requests) only computes the tokens after them. Least recently used prompts
+// are evicted when the cache exceeds the size.
+// If not provided, default is "0", which disables the cache.
+static const char* const kOrtSessionOptionsGenerationPrefixCacheSizeInBytes =
+    "session.generation_prefix_cache_size_in_bytes";
+
+// Cache memory patterns per shape bucket instead of per exact input shapes, for models with dynamic input shapes like
+// variable sequence lengths. Each dimension of the inputs is rounded up to a power of two to find the bucket, and
+// the pattern of a bucket is planned with the largest size of each tensor seen in its runs, so that most runs use
+// the preallocated memory pattern block even if their shapes differ. Up to twice the memory of an exact pattern may
+// be used. Only used when memory pattern is enabled.
+// "0": memory patterns are cached per exact input shapes. [DEFAULT]
+// "1": memory patterns are cached per shape bucket.
+static const char* const kOrtSessionOptionsMemoryPatternShapeBucketing = "session.memory_pattern_shape_bucketing";
+
+// Path of a profiling output file (see SessionOptions::enable_profiling) of prior runs of the model, which provides
+// the costs of nodes for ExecutionMode::ORT_PARALLEL. When all nodes of the main graph run on CPU, ORT_PARALLEL executes
+// them with the inter-op thread pool as soon as their inputs are ready, and the ready node with the longest critical
+// path runs first. The critical path uses the average kernel time of each node in the file.
+// If not provided, every node has the same cost.
+static const char* const kOrtSessionOptionsParallelExecutorNodeCostsFile = "session.parallel_executor_node_costs_file";
+
+// Pin the session to a NUMA node, so that the kernels run close to the memory they use.
+// The per-session intra-op and inter-op thread pools are pinned to the logical processors of the node; when their size
+// is 0, they get one thread per physical core of the node. The memory of the default CPU execution provider, including
+// the initializers and prepacked weights, is placed on the node. Has no effect with global thread pools, when the
+// intra-op thread affinities are set, or when the platform doesn't report NUMA information.
+// "-1": not pinned. [DEFAULT]
+// "<n>": pinned to NUMA node n.
+static const char* const kOrtSessionOptionsNumaNode = "session.numa_node";
+
+// Use a replica of the pre-packed weights of the shared prepacked weights container that is placed on the NUMA node of
+// the session (see kOrtSessionOptionsNumaNode), instead of the single copy shared by all sessions. The container keeps
+// one replica per NUMA node, shared by the sessions pinned to that node, so the weight reads of the kernels stay on the
+// node at the cost of one copy of the pre-packed weights per node. Only used when the session is pinned to a NUMA node
+// and a prepacked weights container is provided.
+// "0": the sessions share a single copy of the pre-packed weights. [DEFAULT]
+// "1": the sessions use the replica of their NUMA node.
+static const char* const kOrtSessionOptionsNumaReplicatePrepackedWeights = "session.numa_replicate_prepacked_weights";
+
+// Carry the values of model outputs to model inputs between the Run calls of the session, for step-wise models like
+// streaming speech models that feed their recurrent state or attention caches from one chunk to the next.
+// The value of a carried output stays on the device its input is consumed on, and is fed to the next run when the
+// caller doesn't feed the input; the caller only fetches the output if it needs the value. When the carried values
+// keep the same shape, the runs alternate between two buffers per pair instead of allocating an output per run.
+// The runs of the session are serialized. The carried inputs must be fed by the first run, and by the runs that reset
+// the carried values with kOrtRunOptionsConfigResetSessionState.
+// Expects a list of semi-colon separated pairs of an output name and an input name of the same type, separated by colon:
+// "output_0:input_0;output_1:input_1"
+// If not provided, default is "", which doesn't carry any value.
+static const char* const kOrtSessionOptionsStatefulOutputInputPairs = "session.stateful_output_input_pairs";
+
 // THIS OPTION IS NOT A REGULAR SESSION OPTION SINCE IT CAN BE MODIFIED AT ANY TIME
 // Meant to be used with SetEpDynamicOptions
 // Specify the type of workload for this session.
@@ -102,6 +102,22 @@ struct GroupQueryAttentionParameters : AttentionParameters {
   int* zero_ptr;
 };
 
+// Parameters for paged attention.
+struct PagedAttentionParameters : AttentionParameters {
+  int token_count;             // number of new tokens of all sequences in the batch
+  int kv_hidden_size;          // hidden size of key or value
+  int kv_num_heads;            // number of heads of key or value
+  int rotary_dim;              // rotary embedding dimension
+  int local_window_size;       // The window size excludes current token. It only includes tokens on the left side.
+  int block_size;              // number of tokens stored in one block of the kv cache
+  int num_blocks;              // number of blocks in the kv cache pool
+  int max_num_blocks_per_seq;  // shape of block_table is [batch_size, max_num_blocks_per_seq]
+  int max_query_len;           // max number of new tokens of one sequence
+  bool is_packed_qkv;          // whether qkv is packed
+  bool rotary_interleaved;     // whether to use interleaved rotary embedding
+  float softcap;
+};
+
 // Parameters for sparse attention.
 struct SparseAttentionParameters : AttentionParameters {
   int kv_hidden_size;              // hidden size of key or value
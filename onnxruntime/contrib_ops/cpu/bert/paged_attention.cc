@@ -0,0 +1,351 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/bert/paged_attention.h"
+#include "contrib_ops/cpu/bert/paged_attention_helper.h"
+#include "contrib_ops/cpu/bert/attention_helper.h"
+#include "contrib_ops/cpu/bert/rotary_embedding.h"
+#include "contrib_ops/cpu/bert/rotary_embedding_helper.h"
+
+#include "core/common/safeint.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/util/math.h"
+
+#include <algorithm>
+#include <vector>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+// These ops are internal-only, so register outside of onnx
+#define REGISTER_KERNEL_TYPED(T)                                       \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                       \
+      PagedAttention,                                                  \
+      kMSDomain,                                                       \
+      1,                                                               \
+      T,                                                               \
+      kCpuExecutionProvider,                                           \
+      KernelDefBuilder()                                               \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())       \
+          .TypeConstraint("M", DataTypeImpl::GetTensorType<int32_t>()) \
+          .MayInplace(3, 1)                                            \
+          .MayInplace(4, 2),                                           \
+      PagedAttention<T>);
+
+REGISTER_KERNEL_TYPED(float)
+REGISTER_KERNEL_TYPED(MLFloat16)
+
+template <typename T>
+PagedAttention<T>::PagedAttention(const OpKernelInfo& info)
+    : OpKernel(info), GQAAttentionBase(info, true) {}
+
+template <typename T>
+Status PagedAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* query = context->Input<Tensor>(0);
+  const Tensor* key = context->Input<Tensor>(1);
+  const Tensor* value = context->Input<Tensor>(2);
+  const Tensor* key_cache = context->Input<Tensor>(3);
+  const Tensor* value_cache = context->Input<Tensor>(4);
+  const Tensor* cumulative_sequence_length = context->Input<Tensor>(5);
+  const Tensor* past_seqlens = context->Input<Tensor>(6);
+  const Tensor* block_table = context->Input<Tensor>(7);
+  const Tensor* cos_cache = context->Input<Tensor>(8);
+  const Tensor* sin_cache = context->Input<Tensor>(9);
+
+  PagedAttentionParameters parameters = {};
+  ORT_RETURN_IF_ERROR(paged_attention_helper::CheckInputs(query,
+                                                          key,
+                                                          value,
+                                                          key_cache,
+                                                          value_cache,
+                                                          cumulative_sequence_length,
+                                                          past_seqlens,
+                                                          block_table,
+                                                          cos_cache,
+                                                          sin_cache,
+                                                          &parameters,
+                                                          num_heads_,
+                                                          kv_num_heads_,
+                                                          scale_,
+                                                          softcap_,
+                                                          local_window_size_));
+  if (do_rotary_ && cos_cache == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cos_cache' and 'sin_cache' are required when do_rotary is 1.");
+  }
+
+  const int token_count = parameters.token_count;
+  const int head_size = parameters.head_size;
+  const bool packed_qkv = parameters.is_packed_qkv;
+
+  Tensor* output = context->Output(0, {static_cast<int64_t>(token_count), static_cast<int64_t>(parameters.hidden_size)});
+  Tensor* key_cache_out = context->Output(1, key_cache->Shape());
+  Tensor* value_cache_out = context->Output(2, value_cache->Shape());
+
+  // The cache is updated in place. It is only copied when the output could not reuse the input buffer,
+  // which is the case when the cache is not bound to both the input and the output.
+  if (key_cache_out->MutableDataRaw() != key_cache->DataRaw()) {
+    memcpy(key_cache_out->MutableDataRaw(), key_cache->DataRaw(), key_cache->SizeInBytes());
+  }
+  if (value_cache_out->MutableDataRaw() != value_cache->DataRaw()) {
+    memcpy(value_cache_out->MutableDataRaw(), value_cache->DataRaw(), value_cache->SizeInBytes());
+  }
+
+  if (token_count == 0) {
+    return Status::OK();
+  }
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+  auto* tp = context->GetOperatorThreadPool();
+
+  const int32_t* cumulative_seqlens_data = cumulative_sequence_length->Data<int32_t>();
+  const int32_t* past_seqlens_data = past_seqlens->Data<int32_t>();
+  const int32_t* block_table_data = block_table->Data<int32_t>();
+
+  // Q, K and V are rows of tokens. They are interleaved in the same rows when qkv is packed.
+  const int q_stride = packed_qkv ? (num_heads_ + 2 * kv_num_heads_) * head_size : num_heads_ * head_size;
+  const int kv_stride = packed_qkv ? q_stride : kv_num_heads_ * head_size;
+  const T* q = query->Data<T>();
+  const T* k = packed_qkv ? q + num_heads_ * head_size : key->Data<T>();
+  const T* v = packed_qkv ? q + (num_heads_ + kv_num_heads_) * head_size : value->Data<T>();
+
+  IAllocatorUniquePtr<T> rotary_q;
+  IAllocatorUniquePtr<T> rotary_k;
+  if (do_rotary_) {
+    // The position of a new token is its offset in the sequence after the past tokens.
+    std::vector<int64_t> position_ids(token_count);
+    for (int b = 0; b < parameters.batch_size; b++) {
+      for (int t = cumulative_seqlens_data[b]; t < cumulative_seqlens_data[b + 1]; t++) {
+        position_ids[t] = static_cast<int64_t>(past_seqlens_data[b]) + t - cumulative_seqlens_data[b];
+      }
+    }
+
+    // All tokens are treated as one sequence of length token_count with explicit position ids.
+    rotary_embedding_helper::RotaryParameters rotary_params = {};
+    rotary_params.batch_size = 1;
+    rotary_params.sequence_length = token_count;
+    rotary_params.hidden_size = parameters.hidden_size;
+    rotary_params.head_size = head_size;
+    rotary_params.rotary_embedding_dim = parameters.rotary_dim;
+    rotary_params.num_heads = num_heads_;
+    rotary_params.max_sequence_length = parameters.total_sequence_length;  // unused
+    rotary_params.seq_stride = q_stride;
+    rotary_params.head_stride = head_size;
+    rotary_params.batch_stride = 0;
+    rotary_params.position_ids_format = 1;
+    rotary_params.transposed = false;
+
+    rotary_q = IAllocator::MakeUniquePtr<T>(allocator, SafeInt<size_t>(token_count) * q_stride);
+    ORT_RETURN_IF_ERROR(RunRotaryEmbedding<T>(tp, rotary_params, q, position_ids.data(), cos_cache->Data<T>(),
+                                              sin_cache->Data<T>(), rotary_q.get(), rotary_interleaved_));
+
+    T* k_rotary = nullptr;
+    if (packed_qkv) {
+      k_rotary = rotary_q.get() + num_heads_ * head_size;
+    } else {
+      rotary_k = IAllocator::MakeUniquePtr<T>(allocator, SafeInt<size_t>(token_count) * kv_stride);
+      k_rotary = rotary_k.get();
+    }
+    rotary_params.num_heads = kv_num_heads_;
+    rotary_params.hidden_size = parameters.kv_hidden_size;
+    rotary_params.seq_stride = kv_stride;
+    ORT_RETURN_IF_ERROR(RunRotaryEmbedding<T>(tp, rotary_params, k, position_ids.data(), cos_cache->Data<T>(),
+                                              sin_cache->Data<T>(), k_rotary, rotary_interleaved_));
+    q = rotary_q.get();
+    k = k_rotary;
+  }
+
+  T* key_cache_data = key_cache_out->MutableData<T>();
+  T* value_cache_data = value_cache_out->MutableData<T>();
+  WriteToCache(k, v, kv_stride, cumulative_seqlens_data, past_seqlens_data, block_table_data,
+               key_cache_data, value_cache_data, parameters, tp);
+
+  return ComputeAttention(q, q_stride, cumulative_seqlens_data, past_seqlens_data, block_table_data,
+                          key_cache_data, value_cache_data, output->MutableData<T>(), parameters, allocator, tp);
+}
+
+template <typename T>
+void PagedAttention<T>::WriteToCache(const T* k, const T* v, int kv_stride, const int32_t* cumulative_seqlens,
+                                     const int32_t* past_seqlens, const int32_t* block_table, T* key_cache,
+                                     T* value_cache, const PagedAttentionParameters& parameters,
+                                     ThreadPool* tp) const {
+  const int block_size = parameters.block_size;
+  const size_t kv_hidden_size = static_cast<size_t>(parameters.kv_hidden_size);
+  const size_t bytes_per_token = kv_hidden_size * sizeof(T);
+
+  TensorOpCost unit_cost;
+  unit_cost.bytes_loaded = static_cast<double>(2 * parameters.max_query_len * bytes_per_token);
+  unit_cost.bytes_stored = unit_cost.bytes_loaded;
+  unit_cost.compute_cycles = 0;
+
+  ThreadPool::TryParallelFor(tp, parameters.batch_size, unit_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+    for (std::ptrdiff_t b = begin; b != end; ++b) {
+      const int32_t* sequence_blocks = block_table + b * parameters.max_num_blocks_per_seq;
+      for (int t = cumulative_seqlens[b]; t < cumulative_seqlens[b + 1]; t++) {
+        const int position = past_seqlens[b] + t - cumulative_seqlens[b];
+        const ptrdiff_t slot = SafeInt<ptrdiff_t>(sequence_blocks[position / block_size]) * block_size +
+                               position % block_size;
+        memcpy(key_cache + slot * kv_hidden_size, k + static_cast<ptrdiff_t>(t) * kv_stride, bytes_per_token);
+        memcpy(value_cache + slot * kv_hidden_size, v + static_cast<ptrdiff_t>(t) * kv_stride, bytes_per_token);
+      }
+    }
+  });
+}
+
+template <typename T>
+Status PagedAttention<T>::ComputeAttention(const T* q, int q_stride, const int32_t* cumulative_seqlens,
+                                           const int32_t* past_seqlens, const int32_t* block_table,
+                                           const T* key_cache, const T* value_cache, T* output,
+                                           const PagedAttentionParameters& parameters, AllocatorPtr allocator,
+                                           ThreadPool* tp) const {
+  const int head_size = parameters.head_size;
+  const int block_size = parameters.block_size;
+  const int hidden_size = parameters.hidden_size;
+  const size_t kv_num_heads_factor = static_cast<size_t>(num_heads_ / kv_num_heads_);
+  const int cache_row_stride = parameters.kv_hidden_size;  // stride between tokens of one head in a block
+  const ptrdiff_t cache_block_stride = SafeInt<ptrdiff_t>(block_size) * cache_row_stride;
+  const float alpha = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+
+  const size_t loop_len = static_cast<size_t>(parameters.batch_size) * num_heads_;
+
+  TensorOpCost unit_cost;
+  const double max_query_len = static_cast<double>(parameters.max_query_len);
+  const double max_total_len = static_cast<double>(parameters.total_sequence_length);
+  unit_cost.compute_cycles = 4.0 * max_query_len * max_total_len * head_size;
+  unit_cost.bytes_loaded = (max_query_len + 2.0 * max_total_len) * head_size * sizeof(T);
+  unit_cost.bytes_stored = max_query_len * (max_total_len * sizeof(float) + head_size * sizeof(T));
+
+  ThreadPool::TryParallelFor(tp, loop_len, unit_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+    for (std::ptrdiff_t i = begin; i != end; ++i) {
+      const size_t batch_index = i / num_heads_;
+      const size_t head_index = i % num_heads_;
+      const size_t kv_head_index = head_index / kv_num_heads_factor;
+      const int token_offset = cumulative_seqlens[batch_index];
+      const int query_len = cumulative_seqlens[batch_index + 1] - token_offset;
+      if (query_len == 0) {
+        continue;
+      }
+      const int past_len = past_seqlens[batch_index];
+      const int total_len = past_len + query_len;
+      const int32_t* sequence_blocks = block_table + batch_index * parameters.max_num_blocks_per_seq;
+
+      // Blocks before the local window of the first new token are never attended to.
+      const int first_key = (local_window_size_ >= 0 && past_len > local_window_size_)
+                                ? past_len - local_window_size_
+                                : 0;
+      const int first_block = first_key / block_size;
+      const int end_block = (total_len + block_size - 1) / block_size;
+
+      // Scratch: scores (S x T), and for float16 also Q (S x H), one block of K or V (L x H) and output (S x H).
+      const size_t scores_elements = static_cast<size_t>(query_len) * total_len;
+      size_t scratch_elements = scores_elements;
+      if constexpr (!std::is_same<T, float>::value) {
+        scratch_elements += static_cast<size_t>(2 * query_len + block_size) * head_size;
+      }
+      auto scratch = allocator->Alloc(scratch_elements * sizeof(float));
+      BufferUniquePtr scratch_buffer(scratch, BufferDeleter(allocator));
+      float* scores = static_cast<float*>(scratch);
+
+      const T* q_head = q + static_cast<ptrdiff_t>(token_offset) * q_stride + head_index * head_size;
+      T* output_head = output + static_cast<ptrdiff_t>(token_offset) * hidden_size + head_index * head_size;
+      const ptrdiff_t kv_head_offset = static_cast<ptrdiff_t>(kv_head_index) * head_size;
+
+      // Compute Q*K' block by block:
+      //   A: Q                S x H
+      //   B: K' of a block    H x L    (rows of a block are strided by kv_num_heads x H)
+      //   C: scores           S x L    (columns [block * L, block * L + L) of S x T)
+      float* q_fp32 = nullptr;
+      float* kv_fp32 = nullptr;
+      float* output_fp32 = nullptr;
+      if constexpr (!std::is_same<T, float>::value) {
+        q_fp32 = scores + scores_elements;
+        kv_fp32 = q_fp32 + static_cast<size_t>(query_len) * head_size;
+        output_fp32 = kv_fp32 + static_cast<size_t>(block_size) * head_size;
+        for (int s = 0; s < query_len; s++) {
+          MlasConvertHalfToFloatBuffer(q_head + static_cast<ptrdiff_t>(s) * q_stride, q_fp32 + s * head_size,
+                                       head_size);
+        }
+      }
+
+      for (int block = first_block; block < end_block; block++) {
+        const int key_start = block * block_size;
+        const int rows = std::min(block_size, total_len - key_start);
+        const T* k_block = key_cache + sequence_blocks[block] * cache_block_stride + kv_head_offset;
+        if constexpr (std::is_same<T, float>::value) {
+          math::GemmEx<float, ThreadPool>(CblasNoTrans, CblasTrans, query_len, rows, head_size, alpha, q_head,
+                                          q_stride, k_block, cache_row_stride, 0.0f, scores + key_start,
+                                          total_len, nullptr);
+        } else {
+          for (int r = 0; r < rows; r++) {
+            MlasConvertHalfToFloatBuffer(k_block + static_cast<ptrdiff_t>(r) * cache_row_stride,
+                                         kv_fp32 + r * head_size, head_size);
+          }
+          math::GemmEx<float, ThreadPool>(CblasNoTrans, CblasTrans, query_len, rows, head_size, alpha, q_fp32,
+                                          head_size, kv_fp32, head_size, 0.0f, scores + key_start,
+                                          total_len, nullptr);
+        }
+      }
+
+      // Causal (and local window) softmax for each new token.
+      for (int s = 0; s < query_len; s++) {
+        float* row = scores + static_cast<ptrdiff_t>(s) * total_len;
+        const int causal_len = past_len + s + 1;
+        const int window_start = (local_window_size_ >= 0 && causal_len > local_window_size_ + 1)
+                                     ? causal_len - local_window_size_ - 1
+                                     : 0;
+        const int window_size = causal_len - window_start;
+
+        std::fill(row, row + window_start, 0.0f);
+        if (softcap_ > 0.f) {
+          ComputeAttentionSoftcapInplace(row + window_start, window_size, softcap_);
+        }
+        if (use_smooth_softmax_) {
+          ComputeSmoothSoftmaxInplace(row + window_start, 1, window_size, nullptr);
+        } else {
+          ComputeAttentionSoftmaxInplace(row + window_start, 1, window_size, nullptr);
+        }
+        std::fill(row + causal_len, row + total_len, 0.0f);
+      }
+
+      // Compute scores * V block by block, accumulating into the output of the head:
+      //   A: scores           S x L
+      //   B: V of a block     L x H
+      //   C: output           S x H
+      for (int block = first_block; block < end_block; block++) {
+        const int key_start = block * block_size;
+        const int rows = std::min(block_size, total_len - key_start);
+        const T* v_block = value_cache + sequence_blocks[block] * cache_block_stride + kv_head_offset;
+        const float beta = block == first_block ? 0.0f : 1.0f;
+        if constexpr (std::is_same<T, float>::value) {
+          math::GemmEx<float, ThreadPool>(CblasNoTrans, CblasNoTrans, query_len, head_size, rows, 1.0f,
+                                          scores + key_start, total_len, v_block, cache_row_stride, beta,
+                                          output_head, hidden_size, nullptr);
+        } else {
+          for (int r = 0; r < rows; r++) {
+            MlasConvertHalfToFloatBuffer(v_block + static_cast<ptrdiff_t>(r) * cache_row_stride,
+                                         kv_fp32 + r * head_size, head_size);
+          }
+          math::GemmEx<float, ThreadPool>(CblasNoTrans, CblasNoTrans, query_len, head_size, rows, 1.0f,
+                                          scores + key_start, total_len, kv_fp32, head_size, beta,
+                                          output_fp32, head_size, nullptr);
+        }
+      }
+
+      if constexpr (!std::is_same<T, float>::value) {
+        for (int s = 0; s < query_len; s++) {
+          MlasConvertFloatToHalfBuffer(output_fp32 + s * head_size,
+                                       output_head + static_cast<ptrdiff_t>(s) * hidden_size, head_size);
+        }
+      }
+    }
+  });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+#include "contrib_ops/cpu/bert/attention_parameters.h"
+#include "gqa_attention_base.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Group query attention over a paged kv cache. K and V of all sequences live in fixed size blocks of a shared
+// pool (num_blocks, block_size, kv_num_heads, head_size), and each sequence addresses its blocks through a row of
+// block_table. New tokens are appended to the blocks in place, so the pool can be bound to both the cache input and
+// output with IOBinding and shared by many sequences of different lengths.
+template <typename T>
+class PagedAttention final : public OpKernel, public GQAAttentionBase {
+ public:
+  PagedAttention(const OpKernelInfo& info);
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  // Write new K and V of every sequence into the cache slots after its past tokens.
+  void WriteToCache(const T* k, const T* v, int kv_stride, const int32_t* cumulative_seqlens,
+                    const int32_t* past_seqlens, const int32_t* block_table, T* key_cache, T* value_cache,
+                    const PagedAttentionParameters& parameters, concurrency::ThreadPool* tp) const;
+
+  // Compute attention of the new tokens against the cached K and V block by block.
+  Status ComputeAttention(const T* q, int q_stride, const int32_t* cumulative_seqlens, const int32_t* past_seqlens,
+                          const int32_t* block_table, const T* key_cache, const T* value_cache, T* output,
+                          const PagedAttentionParameters& parameters, AllocatorPtr allocator,
+                          concurrency::ThreadPool* tp) const;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,246 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+
+#include "core/common/common.h"
+#include "core/providers/common.h"
+#include "contrib_ops/cpu/bert/attention_common.h"
+#include "contrib_ops/cpu/bert/attention_parameters.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace paged_attention_helper {
+
+template <typename T = Tensor>
+Status CheckInputs(const T* query,
+                   const T* key,
+                   const T* value,
+                   const T* key_cache,
+                   const T* value_cache,
+                   const T* cumulative_sequence_length,
+                   const T* past_seqlens,
+                   const T* block_table,
+                   const T* cos_cache,
+                   const T* sin_cache,
+                   void* parameters,
+                   int num_heads,
+                   int kv_num_heads,
+                   float scale,
+                   float softcap,
+                   int local_window_size) {
+  // Note: Here T is token_count (number of new tokens of all sequences), B is batch_size,
+  //       P is num_blocks and L is block_size.
+  //     query            (Q)       : (T, D) or (T, (D_q + 2 D_kv))
+  //     key              (K)       : (T, D_kv) or nullptr
+  //     value            (V)       : (T, D_kv) or nullptr
+  //     key_cache                  : (P, L, N_k, H)
+  //     value_cache                : (P, L, N_k, H)
+  //     cumulative_sequence_length : (B + 1)
+  //     past_seqlens               : (B)
+  //     block_table                : (B, max_num_blocks_per_seq)
+  const bool is_packed_qkv = key == nullptr;
+
+  const auto& query_dims = query->Shape().GetDims();
+  if (query_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'query' is expected to have 2 dimensions, got ",
+                           query_dims.size());
+  }
+
+  if (num_heads % kv_num_heads != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "num_heads must be a multiple of kv_num_heads. Got num_heads % kv_num_heads == ",
+                           num_heads % kv_num_heads);
+  }
+
+  int token_count = static_cast<int>(query_dims[0]);
+  int q_hidden_size = static_cast<int>(query_dims[1]);
+  int head_size = 0;
+  int kv_hidden_size = 0;
+
+  if (!is_packed_qkv) {
+    head_size = q_hidden_size / num_heads;
+    if (head_size * num_heads != q_hidden_size) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'query' dimension 1 shall be a multiple of num_heads.");
+    }
+    if (value == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'key' and 'value' shall be both present, or both absent in the case of packed qkv.");
+    }
+    const auto& key_dims = key->Shape().GetDims();
+    const auto& value_dims = value->Shape().GetDims();
+    if (key_dims.size() != 2 || value_dims.size() != 2) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'key' and 'value' are expected to have 2 dimensions");
+    }
+    if (key_dims[0] != token_count || value_dims[0] != token_count) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'query', 'key' and 'value' shall have same dim 0 (token count)");
+    }
+    kv_hidden_size = static_cast<int>(key_dims[1]);
+    if (value_dims[1] != kv_hidden_size || kv_hidden_size != head_size * kv_num_heads) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'key' and 'value' dimension 1 shall be kv_num_heads * head_size, got ",
+                             key_dims[1], " and ", value_dims[1]);
+    }
+  } else {
+    head_size = q_hidden_size / (num_heads + 2 * kv_num_heads);
+    if (head_size * (num_heads + 2 * kv_num_heads) != q_hidden_size) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Packed QKV dimension 1 shall be a multiple of (num_heads + 2 * kv_num_heads).");
+    }
+    if (value != nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'key' and 'value' shall be both present, or both absent in the case of packed qkv.");
+    }
+    q_hidden_size = head_size * num_heads;
+    kv_hidden_size = head_size * kv_num_heads;
+  }
+
+  if (head_size == 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "head_size shall be greater than 0.");
+  }
+
+  // Check the paged kv cache
+  const auto& key_cache_dims = key_cache->Shape().GetDims();
+  const auto& value_cache_dims = value_cache->Shape().GetDims();
+  if (key_cache_dims.size() != 4 || value_cache_dims.size() != 4) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'key_cache' and 'value_cache' are expected to have 4 dimensions");
+  }
+  for (size_t i = 0; i < 4; i++) {
+    if (key_cache_dims[i] != value_cache_dims[i]) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'key_cache' and 'value_cache' shall have the same shape");
+    }
+  }
+  const int num_blocks = static_cast<int>(key_cache_dims[0]);
+  const int block_size = static_cast<int>(key_cache_dims[1]);
+  if (block_size <= 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "block_size (dimension 1 of 'key_cache') shall be positive.");
+  }
+  if (key_cache_dims[2] != kv_num_heads) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'key_cache' dimension 2 should be same as kv_num_heads, got ", key_cache_dims[2]);
+  }
+  if (key_cache_dims[3] != head_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'key_cache' dimension 3 should be same as head_size, got ", key_cache_dims[3]);
+  }
+
+  // Check sequence lengths and block table
+  const auto& cumulative_dims = cumulative_sequence_length->Shape().GetDims();
+  if (cumulative_dims.size() != 1 || cumulative_dims[0] < 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cumulative_sequence_length' is expected to be 1D with shape (batch_size + 1)");
+  }
+  const int batch_size = static_cast<int>(cumulative_dims[0]) - 1;
+
+  const auto& past_seqlens_dims = past_seqlens->Shape().GetDims();
+  if (past_seqlens_dims.size() != 1 || past_seqlens_dims[0] != batch_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'past_seqlens' is expected to be 1D with shape (batch_size)");
+  }
+
+  const auto& block_table_dims = block_table->Shape().GetDims();
+  if (block_table_dims.size() != 2 || block_table_dims[0] != batch_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'block_table' is expected to be 2D with shape (batch_size, max_num_blocks_per_seq)");
+  }
+  const int max_num_blocks_per_seq = static_cast<int>(block_table_dims[1]);
+
+  const int32_t* cumulative_data = cumulative_sequence_length->template Data<int32_t>();
+  const int32_t* past_seqlens_data = past_seqlens->template Data<int32_t>();
+  const int32_t* block_table_data = block_table->template Data<int32_t>();
+  if (cumulative_data[0] != 0 || cumulative_data[batch_size] != token_count) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cumulative_sequence_length' shall start with 0 and end with the token count ",
+                           token_count, ", got ", cumulative_data[0], " and ", cumulative_data[batch_size]);
+  }
+
+  int max_query_len = 0;
+  int max_total_len = 0;
+  for (int b = 0; b < batch_size; b++) {
+    const int query_len = cumulative_data[b + 1] - cumulative_data[b];
+    if (query_len < 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'cumulative_sequence_length' shall be non-decreasing.");
+    }
+    if (past_seqlens_data[b] < 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'past_seqlens' shall be non-negative, got ", past_seqlens_data[b]);
+    }
+    const int total_len = past_seqlens_data[b] + query_len;
+    const int num_used_blocks = (total_len + block_size - 1) / block_size;
+    if (num_used_blocks > max_num_blocks_per_seq) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Sequence ", b, " needs ", num_used_blocks, " blocks but 'block_table' only has ",
+                             max_num_blocks_per_seq, " entries per sequence.");
+    }
+    const int32_t* sequence_blocks = block_table_data + static_cast<ptrdiff_t>(b) * max_num_blocks_per_seq;
+    for (int i = 0; i < num_used_blocks; i++) {
+      if (sequence_blocks[i] < 0 || sequence_blocks[i] >= num_blocks) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                               "Input 'block_table' has out of range block id ", sequence_blocks[i],
+                               " for sequence ", b, ". It shall be in the range [0, ", num_blocks, ").");
+      }
+    }
+    max_query_len = std::max(max_query_len, query_len);
+    max_total_len = std::max(max_total_len, total_len);
+  }
+
+  int rotary_dim = 0;
+  if (cos_cache != nullptr && sin_cache != nullptr) {
+    const auto& cos_dims = cos_cache->Shape().GetDims();
+    const auto& sin_dims = sin_cache->Shape().GetDims();
+    if (cos_dims.size() != 2 || sin_dims.size() != 2) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'cos_cache' and 'sin_cache' are expected to have 2 dimensions");
+    }
+    if (cos_dims[0] < max_total_len || sin_dims[0] < max_total_len) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "cos_cache and sin_cache dimension 0 shall not be less than the longest total sequence length ",
+                             max_total_len);
+    }
+    if (cos_dims[1] > head_size / 2 || cos_dims[1] != sin_dims[1]) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "cos_cache and sin_cache dimension 1 must be the same and <= head_size / 2.");
+    }
+    rotary_dim = static_cast<int>(cos_dims[1] * 2);
+  } else if (cos_cache != nullptr || sin_cache != nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cos_cache' and 'sin_cache' shall be both present or both absent.");
+  }
+
+  if (parameters != nullptr) {
+    PagedAttentionParameters* output_parameters = reinterpret_cast<PagedAttentionParameters*>(parameters);
+    output_parameters->batch_size = batch_size;
+    output_parameters->token_count = token_count;
+    output_parameters->max_query_len = max_query_len;
+    output_parameters->total_sequence_length = max_total_len;  // longest past + new sequence length of the batch
+    output_parameters->hidden_size = q_hidden_size;
+    output_parameters->num_heads = num_heads;
+    output_parameters->head_size = head_size;
+    output_parameters->kv_hidden_size = kv_hidden_size;
+    output_parameters->kv_num_heads = kv_num_heads;
+    output_parameters->rotary_dim = rotary_dim;
+    output_parameters->local_window_size = local_window_size;
+    output_parameters->block_size = block_size;
+    output_parameters->num_blocks = num_blocks;
+    output_parameters->max_num_blocks_per_seq = max_num_blocks_per_seq;
+    output_parameters->is_packed_qkv = is_packed_qkv;
+    output_parameters->is_unidirectional = true;
+    output_parameters->scale = scale;
+    output_parameters->softcap = softcap;
+    output_parameters->qkv_format = Q_K_V_BSNH;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace paged_attention_helper
+}  // namespace contrib
+}  // namespace onnxruntime
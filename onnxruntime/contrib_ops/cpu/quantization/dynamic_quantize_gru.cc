@@ -0,0 +1,310 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+
+#include "core/common/narrow.h"
+#include "core/providers/cpu/rnn/deep_cpu_gru.h"
+#include "core/providers/cpu/rnn/gru_base.h"
+#include "core/providers/cpu/rnn/rnn_helpers.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+using namespace rnn::detail;
+
+class DynamicQuantizeGRU : public OpKernel, public GRUBase {
+ public:
+  DynamicQuantizeGRU(const OpKernelInfo& info) : OpKernel(info), GRUBase(info) {}
+
+  Status PrePack(const Tensor& tensor, int input_idx,
+                 AllocatorPtr alloc, /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                   int input_idx,
+                                   /*out*/ bool& used_shared_buffers) override;
+
+  Status Compute(OpKernelContext* context) const override;
+
+  ~DynamicQuantizeGRU() override = default;
+
+ private:
+  // Packs the columns [column, column + N) of the weights of each direction,
+  // weights: [num_directions, K, ldb]
+  Status TryPackWeights(const Tensor& weights, size_t column, size_t N, PackedWeights& packed_weights,
+                        bool& is_packed, bool& is_weight_signed, AllocatorPtr& alloc);
+
+  Status ValidateQuantizationParameter(const Tensor& scale, const Tensor& zero_point, bool is_signed,
+                                       const char* weight_name) const;
+
+  PackedWeights packed_W_;
+  PackedWeights packed_R_ZR_;
+  PackedWeights packed_R_H_;
+  bool is_W_signed_;
+  bool is_R_signed_;
+};
+
+Status DynamicQuantizeGRU::TryPackWeights(const Tensor& weights, size_t column, size_t N,
+                                          PackedWeights& packed_weights, bool& is_packed,
+                                          bool& is_weight_signed, AllocatorPtr& alloc) {
+  const auto& shape = weights.Shape();
+  if (shape.NumDimensions() != 3) {
+    return Status::OK();
+  }
+
+  // weights: [num_directions, input_size, 3*hidden_size]
+  // recurrence weights: [num_directions, hidden_size, 3*hidden_size]
+  const size_t K = static_cast<size_t>(shape[1]);
+  const size_t ldb = static_cast<size_t>(shape[2]);
+
+  if ((shape[0] != num_directions_) || (ldb != static_cast<size_t>(hidden_size_) * 3)) {
+    return Status::OK();
+  }
+
+  is_weight_signed = weights.IsDataType<int8_t>();
+  const size_t packed_weights_size = MlasGemmPackBSize(N, K, false /*AIsSigned*/, is_weight_signed);
+  if (packed_weights_size == 0) {
+    return Status::OK();
+  }
+
+  size_t packed_weights_data_size = SafeInt<size_t>(packed_weights_size) * num_directions_;
+
+  packed_weights.buffer_ = IAllocator::MakeUniquePtr<void>(alloc, packed_weights_data_size, true);
+
+  auto* packed_weights_data = packed_weights.buffer_.get();
+
+  // Initialize memory to 0 as there could be some padding associated with pre-packed
+  // buffer memory and we don not want it uninitialized and generate different hashes
+  // if and when we try to cache this pre-packed buffer for sharing between sessions.
+  memset(packed_weights_data, 0, packed_weights_data_size);
+
+  packed_weights.buffer_size_ = packed_weights_data_size;
+  packed_weights.weights_size_ = packed_weights_size;
+  packed_weights.shape_ = shape;
+
+  const auto* weights_data = static_cast<const uint8_t*>(weights.DataRaw()) + column;
+  for (int i = 0; i < num_directions_; i++) {
+    MlasGemmPackB(N, K, weights_data, ldb, false /*AIsSigned*/, is_weight_signed, packed_weights_data);
+    packed_weights_data = static_cast<uint8_t*>(packed_weights_data) + packed_weights_size;
+    weights_data += ldb * K;
+  }
+
+  is_packed = true;
+  return Status::OK();
+}
+
+Status DynamicQuantizeGRU::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                                   /*out*/ bool& is_packed,
+                                   /*out*/ PrePackedWeights* prepacked_weights) {
+  is_packed = false;
+
+  const bool share_prepacked_weights = (prepacked_weights != nullptr);
+  const size_t hidden_size = static_cast<size_t>(hidden_size_);
+
+  if (input_idx == 1) {
+    ORT_RETURN_IF_ERROR(TryPackWeights(tensor, 0, 3 * hidden_size, packed_W_, is_packed, is_W_signed_, alloc));
+
+    if (is_packed && share_prepacked_weights) {
+      prepacked_weights->buffers_.push_back(std::move(packed_W_.buffer_));
+      prepacked_weights->buffer_sizes_.push_back(packed_W_.buffer_size_);
+    }
+  } else if (input_idx == 2) {
+    // the recurrence weights of the update and reset gates and of the hidden gate are applied separately,
+    // so they are packed in two buffers
+    bool is_ZR_packed = false;
+    ORT_RETURN_IF_ERROR(TryPackWeights(tensor, 0, 2 * hidden_size, packed_R_ZR_, is_ZR_packed, is_R_signed_, alloc));
+    if (is_ZR_packed) {
+      ORT_RETURN_IF_ERROR(TryPackWeights(tensor, 2 * hidden_size, hidden_size, packed_R_H_, is_packed,
+                                         is_R_signed_, alloc));
+      if (!is_packed) {
+        packed_R_ZR_.buffer_.reset();
+      }
+    }
+
+    if (is_packed && share_prepacked_weights) {
+      prepacked_weights->buffers_.push_back(std::move(packed_R_ZR_.buffer_));
+      prepacked_weights->buffer_sizes_.push_back(packed_R_ZR_.buffer_size_);
+      prepacked_weights->buffers_.push_back(std::move(packed_R_H_.buffer_));
+      prepacked_weights->buffer_sizes_.push_back(packed_R_H_.buffer_size_);
+    }
+  }
+
+  return Status::OK();
+}
+
+Status DynamicQuantizeGRU::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                                     int input_idx,
+                                                     /*out*/ bool& used_shared_buffers) {
+  used_shared_buffers = false;
+
+  if (input_idx == 1) {
+    used_shared_buffers = true;
+    packed_W_.buffer_ = std::move(prepacked_buffers[0]);
+  } else if (input_idx == 2) {
+    used_shared_buffers = true;
+    packed_R_ZR_.buffer_ = std::move(prepacked_buffers[0]);
+    packed_R_H_.buffer_ = std::move(prepacked_buffers[1]);
+  }
+
+  return Status::OK();
+}
+
+Status DynamicQuantizeGRU::ValidateQuantizationParameter(const Tensor& scale, const Tensor& zero_point,
+                                                         bool is_signed, const char* weight_name) const {
+  for (const auto* shape : {&scale.Shape(), &zero_point.Shape()}) {
+    if ((shape->NumDimensions() != 1 && shape->NumDimensions() != 2) ||
+        (shape->NumDimensions() == 2 && (*shape)[1] != static_cast<int64_t>(hidden_size_) * 3) ||
+        (*shape)[0] != num_directions_) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Quantization parameters of input ", weight_name, " must have shape {", num_directions_,
+                             "} for per-tensor/layer quantization or shape {", num_directions_, ", 3*", hidden_size_,
+                             "} for per-channel quantization. Actual:", *shape);
+    }
+  }
+
+  if (scale.Shape() != zero_point.Shape()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Scale and zero point of input ", weight_name,
+                           " must have the same shape.");
+  }
+
+  // the quantized GEMM takes a single zero point for all the columns
+  if (zero_point.Shape().NumDimensions() == 2) {
+    const auto zero_points = gsl::make_span(static_cast<const uint8_t*>(zero_point.DataRaw()),
+                                            narrow<size_t>(zero_point.Shape().Size()));
+    for (const uint8_t zp : zero_points) {
+      if (is_signed ? zp != 0 : zp != zero_points[0]) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "DynamicQuantizeGRU : ", weight_name,
+                               is_signed ? " zero point must be zero" : " zero point must be constant");
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
+Status DynamicQuantizeGRU::Compute(OpKernelContext* context) const {
+  const Tensor& X = *context->Input<Tensor>(0);
+  // weights. [num_directions, input_size, 3*hidden_size]
+  const Tensor* W = packed_W_.buffer_ ? nullptr : context->Input<Tensor>(1);
+  // recurrence weights. [num_directions, hidden_size, 3*hidden_size]
+  const Tensor* R = packed_R_ZR_.buffer_ ? nullptr : context->Input<Tensor>(2);
+
+  const auto& W_shape = (W != nullptr) ? W->Shape() : packed_W_.shape_;
+  const auto& R_shape = (R != nullptr) ? R->Shape() : packed_R_ZR_.shape_;
+
+  const int64_t input_size = X.Shape().NumDimensions() == 3 ? X.Shape()[2] : 0;
+  if (W_shape.NumDimensions() != 3 || W_shape[0] != num_directions_ || W_shape[1] != input_size ||
+      W_shape[2] != 3 * static_cast<int64_t>(hidden_size_)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input W must have shape {", num_directions_, ",",
+                           input_size, ",3*", hidden_size_, "}. Actual:", W_shape);
+  }
+  if (R_shape.NumDimensions() != 3 || R_shape[0] != num_directions_ || R_shape[1] != hidden_size_ ||
+      R_shape[2] != 3 * static_cast<int64_t>(hidden_size_)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input R must have shape {", num_directions_, ",",
+                           hidden_size_, ",3*", hidden_size_, "}. Actual:", R_shape);
+  }
+
+  const Tensor* w_scale = context->Input<Tensor>(6);
+  const Tensor* w_zp = context->Input<Tensor>(7);
+  const Tensor* r_scale = context->Input<Tensor>(8);
+  const Tensor* r_zp = context->Input<Tensor>(9);
+
+  const bool is_W_signed = (W != nullptr) ? W->IsDataType<int8_t>() : is_W_signed_;
+  const bool is_R_signed = (R != nullptr) ? R->IsDataType<int8_t>() : is_R_signed_;
+
+  ORT_RETURN_IF_ERROR(ValidateQuantizationParameter(*w_scale, *w_zp, is_W_signed, "W"));
+  ORT_RETURN_IF_ERROR(ValidateQuantizationParameter(*r_scale, *r_zp, is_R_signed, "R"));
+
+  const size_t hidden_size = static_cast<size_t>(hidden_size_);
+  const bool is_W_per_channel = w_scale->Shape().NumDimensions() == 2;
+  const bool is_R_per_channel = r_scale->Shape().NumDimensions() == 2;
+  const size_t W_scale_size = is_W_per_channel ? 3 * hidden_size : 1;
+  const size_t R_scale_size = is_R_per_channel ? 3 * hidden_size : 1;
+
+  const float* W_scale_data = w_scale->Data<float>();
+  const float* R_scale_data = r_scale->Data<float>();
+  const uint8_t* W_zp_data = static_cast<const uint8_t*>(w_zp->DataRaw());
+  const uint8_t* R_zp_data = static_cast<const uint8_t*>(r_zp->DataRaw());
+
+  // per-channel parameters of R are split as its columns, the ones of the hidden gate follow the ones of the
+  // update and reset gates
+  const size_t R_H_offset = is_R_per_channel ? 2 * hidden_size : 0;
+
+  QuantizationParameter quant_para_W_1(W_scale_data, W_zp_data, is_W_signed, W_scale_size);
+  QuantizationParameter quant_para_R_ZR_1(R_scale_data, R_zp_data, is_R_signed,
+                                          is_R_per_channel ? 2 * hidden_size : 1);
+  QuantizationParameter quant_para_R_H_1(R_scale_data + R_H_offset, R_zp_data + R_H_offset, is_R_signed,
+                                         is_R_per_channel ? hidden_size : 1);
+
+  QuantizationParameter quant_para_W_2(quant_para_W_1);
+  QuantizationParameter quant_para_R_ZR_2(quant_para_R_ZR_1);
+  QuantizationParameter quant_para_R_H_2(quant_para_R_H_1);
+
+  const size_t W_size_per_direction = SafeInt<size_t>(W_shape[1]) * W_shape[2];
+  const uint8_t* W_data = W != nullptr ? static_cast<const uint8_t*>(W->DataRaw()) : nullptr;
+
+  // R[zr] and R[h] are interleaved in the rows of R, which the quantized GEMM can't read with a stride.
+  // if R isn't prepacked, copy each of them to contiguous rows.
+  const size_t R_ZR_size_per_direction = 2 * hidden_size * hidden_size;
+  const size_t R_H_size_per_direction = hidden_size * hidden_size;
+  IAllocatorUniquePtr<uint8_t> R_split_ptr;
+  const uint8_t* R_ZR_data = nullptr;
+  const uint8_t* R_H_data = nullptr;
+  if (R != nullptr) {
+    AllocatorPtr alloc;
+    ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+    const size_t num_directions = static_cast<size_t>(num_directions_);
+    R_split_ptr = IAllocator::MakeUniquePtr<uint8_t>(alloc, SafeInt<size_t>(num_directions) * 3 * hidden_size * hidden_size);
+
+    uint8_t* R_ZR_split = R_split_ptr.get();
+    uint8_t* R_H_split = R_ZR_split + num_directions * R_ZR_size_per_direction;
+    const uint8_t* R_row = static_cast<const uint8_t*>(R->DataRaw());
+    for (size_t row = 0; row < num_directions * hidden_size; ++row, R_row += 3 * hidden_size) {
+      std::copy_n(R_row, 2 * hidden_size, R_ZR_split + row * 2 * hidden_size);
+      std::copy_n(R_row + 2 * hidden_size, hidden_size, R_H_split + row * hidden_size);
+    }
+
+    R_ZR_data = R_ZR_split;
+    R_H_data = R_H_split;
+  }
+
+  GemmWeights<uint8_t> W_1(0, W_data, W_size_per_direction, packed_W_, &quant_para_W_1);
+  GemmWeights<uint8_t> R_ZR_1(0, R_ZR_data, R_ZR_size_per_direction, packed_R_ZR_, &quant_para_R_ZR_1);
+  GemmWeights<uint8_t> R_H_1(0, R_H_data, R_H_size_per_direction, packed_R_H_, &quant_para_R_H_1);
+
+  GemmWeights<uint8_t> W_2;
+  GemmWeights<uint8_t> R_ZR_2;
+  GemmWeights<uint8_t> R_H_2;
+
+  if (direction_ == Direction::kBidirectional) {
+    quant_para_W_2.scale += W_scale_size;
+    quant_para_R_ZR_2.scale += R_scale_size;
+    quant_para_R_H_2.scale += R_scale_size;
+
+    quant_para_W_2.zero_point += W_scale_size;  // zero_point and scale have same size
+    quant_para_R_ZR_2.zero_point += R_scale_size;
+    quant_para_R_H_2.zero_point += R_scale_size;
+
+    W_2.Init(1, W_data, W_size_per_direction, packed_W_, &quant_para_W_2);
+    R_ZR_2.Init(1, R_ZR_data, R_ZR_size_per_direction, packed_R_ZR_, &quant_para_R_ZR_2);
+    R_H_2.Init(1, R_H_data, R_H_size_per_direction, packed_R_H_, &quant_para_R_H_2);
+  }
+
+  return GRUBase::ComputeImpl<float, uint8_t>(*context, W_1, W_2, R_ZR_1, R_ZR_2, R_H_1, R_H_2);
+}
+
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    DynamicQuantizeGRU,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<int32_t>())
+        .TypeConstraint("T2", {DataTypeImpl::GetTensorType<uint8_t>(), DataTypeImpl::GetTensorType<int8_t>()}),
+    DynamicQuantizeGRU);
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -182,6 +182,9 @@ struct IGenerationParameters {
   int min_tokens_to_keep = 1;
   bool custom_sampling = false;
 
+  // Parameters for speculative decoding
+  int num_speculative_tokens = 0;
+
   // Parameters for whisper model
   bool decoder_output_cross_qk = false;
   gsl::span<const int32_t> extra_decoding_ids;
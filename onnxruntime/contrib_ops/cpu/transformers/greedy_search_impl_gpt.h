@@ -3,10 +3,14 @@
 
 #pragma once
 #include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <vector>
 
 #include "core/common/span_utils.h"
 #include "contrib_ops/cpu/transformers/greedy_search_impl_base.h"
+#include "contrib_ops/cpu/transformers/prefix_cache.h"
+#include "contrib_ops/cpu/transformers/sequences.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -21,6 +25,22 @@ std::pair<Status, std::unique_ptr<GptSubgraph>> CreateGptSubgraphAndUpdateParame
     const std::string& attribute_name,
     const SessionState& subgraph_session_state,
     /*out*/ BeamSearchParameters& parameters);
+
+// Copies the logits of the last position to scores. Logits has shape (1, sequence_length, vocab_size).
+inline void GetLastTokenScores(const Tensor& logits, gsl::span<float> scores) {
+  const auto& dims = logits.Shape().GetDims();
+  const size_t vocab_size = static_cast<size_t>(dims[2]);
+  const size_t offset = static_cast<size_t>(dims[1] - 1) * vocab_size;
+  if (logits.IsDataType<MLFloat16>()) {
+    const MLFloat16* data = logits.Data<MLFloat16>() + offset;
+    for (size_t i = 0; i < vocab_size; i++) {
+      scores[i] = data[i].ToFloat();
+    }
+    return;
+  }
+
+  gsl::copy(gsl::make_span(logits.Data<float>() + offset, vocab_size), scores);
+}
 }  // namespace gpt_details
 
 // Greedy search implementation for GPT-2 model.
@@ -79,12 +99,45 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
   }
 #endif
 
+  // Set the draft subgraph used to propose tokens for speculative decoding.
+  void SetDraftDecoder(const SessionState* draft_decoder_session_state,
+                       GptSubgraph* draft_gpt_subgraph,
+                       const FeedsFetchesManager* draft_feeds_fetches_manager) {
+    draft_decoder_session_state_ = draft_decoder_session_state;
+    draft_gpt_subgraph_ = draft_gpt_subgraph;
+    draft_feeds_fetches_manager_ = draft_feeds_fetches_manager;
+  }
+
+  // Set the cache of past state of prompts shared by Run calls.
+  void SetPrefixCache(PrefixCache* prefix_cache) {
+    prefix_cache_ = prefix_cache;
+  }
+
   // Execute beam search in iterations util stopping criteria is reached.
   // In each iteration, GPT subgraph is called, and next token for each sequence is generated.
   Status Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
                  const FeedsFetchesManager& feeds_fetches_manager);
 
  private:
+  // Speculative decoding for a single sequence on CPU. In each iteration, the draft subgraph proposes up to
+  // num_speculative_tokens tokens one by one, then the GPT subgraph computes logits of all of them in one run.
+  // Both the draft and the verified tokens are selected after the logits processors. Verified tokens are accepted
+  // until the first one that differs from the draft, so the output is the same as greedy search without a draft.
+  Status ExecuteSpeculative(const FeedsFetchesManager* init_run_feeds_fetches_manager,
+                            const FeedsFetchesManager& feeds_fetches_manager);
+
+  // Run a GPT subgraph on tokens that follow the first past_length tokens of the sequence. Past state in fetches of
+  // the previous run is truncated to past_length, which drops the entries of tokens that are not used any more.
+  Status ExecuteSubgraphWithPast(const SessionState& session_state,
+                            const FeedsFetchesManager& feeds_fetches_manager,
+                            const GptSubgraph& subgraph,
+                            gsl::span<const int32_t> tokens,
+                            int past_length,
+                            int position_offset,
+                            gsl::span<const int32_t> prompt_attention_mask,
+                            std::vector<OrtValue>& feeds,
+                            std::vector<OrtValue>& fetches);
+
   // Prepare the inputs for first inference of subgraph
   Status CreateInitialFeeds(gsl::span<int32_t>& sequence_lengths,
                             OrtValue& expanded_input_ids,
@@ -101,6 +154,28 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
       gsl::span<const int32_t> next_tokens,
       int past_sequence_length);
 
+  // Run the first iteration with past state of the first prefix_length tokens of a cached prompt, which are the
+  // first tokens of the prompt. When the whole prompt is cached, the subgraph is not run and the outputs are taken
+  // from the cache.
+  Status ExecuteWithCachedPrefix(const PrefixCacheEntry& cached_prefix,
+                                 size_t prefix_length,
+                                 const FeedsFetchesManager* init_run_feeds_fetches_manager,
+                                 const FeedsFetchesManager& feeds_fetches_manager,
+                                 gsl::span<const int32_t> prompt,
+                                 std::vector<OrtValue>& feeds,
+                                 std::vector<OrtValue>& fetches);
+
+  // Drop finished sequences from the inputs of next iteration. kept_rows are the rows of current inputs to keep.
+  Status CompactFeeds(std::vector<OrtValue>& next_inputs,
+                      OrtValue& position_ids,
+                      gsl::span<const int32_t> kept_rows);
+
+  // Copy logits of the rows still in the inputs to a buffer with the shape of whole batch, so that logits processing
+  // and token selection are not aware of compaction.
+  void ExpandLogits(const OrtValue& logits,
+                    gsl::span<const int32_t> active_rows,
+                    OrtValue& batch_logits);
+
   const SessionState* init_run_decoder_session_state_ = nullptr;
   GptSubgraph* init_run_gpt_subgraph_ = nullptr;
   GptSubgraph& gpt_subgraph_;
@@ -114,6 +189,12 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
 #endif
   GenerationDeviceHelper::UpdateGptFeedsFunc<T> update_feeds_func_;
 
+  PrefixCache* prefix_cache_ = nullptr;
+
+  const SessionState* draft_decoder_session_state_ = nullptr;
+  GptSubgraph* draft_gpt_subgraph_ = nullptr;
+  const FeedsFetchesManager* draft_feeds_fetches_manager_ = nullptr;
+
   const void* cuda_device_prop_ = nullptr;
   int cuda_device_arch_ = 0;
 };
@@ -187,12 +268,431 @@ Status GreedySearchGpt<T, ParametersT>::UpdateFeeds(
                             false);
 }
 
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::CompactFeeds(std::vector<OrtValue>& next_inputs,
+                                                     OrtValue& position_ids,
+                                                     gsl::span<const int32_t> kept_rows) {
+  const int64_t batch_size = static_cast<int64_t>(kept_rows.size());
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+
+  // input_ids, position_ids and attention_mask have shape (batch_size, *)
+  auto gather_rows = [&](const OrtValue& source, OrtValue& target) {
+    const Tensor& source_tensor = source.Get<Tensor>();
+    TensorShape shape = source_tensor.Shape();
+    const size_t row_size = static_cast<size_t>(shape.SizeFromDimension(1));
+    shape[0] = batch_size;
+    Tensor::InitOrtValue(int32_type, shape, this->temp_space_allocator_, target);
+    const int32_t* source_data = source_tensor.Data<int32_t>();
+    int32_t* target_data = target.GetMutable<Tensor>()->MutableData<int32_t>();
+    for (size_t i = 0; i < kept_rows.size(); i++) {
+      std::copy_n(source_data + static_cast<size_t>(kept_rows[i]) * row_size, row_size, target_data + i * row_size);
+    }
+  };
+
+  OrtValue input_ids;
+  gather_rows(next_inputs[0], input_ids);
+  next_inputs[0] = input_ids;
+
+  // The new position_ids owns its buffer instead of using next_positions in greedy state.
+  OrtValue compacted_position_ids;
+  gather_rows(next_inputs[1], compacted_position_ids);
+  position_ids = compacted_position_ids;
+  next_inputs[1] = position_ids;
+
+  OrtValue attention_mask;
+  gather_rows(next_inputs[2], attention_mask);
+  next_inputs[2] = attention_mask;
+
+  // Past state has shape like (2, batch_size, num_heads, past_seq_len, head_size). It is copied as bytes since
+  // its data type could be different from the logits.
+  const size_t first_past_input_index = static_cast<size_t>(gpt_subgraph_.GetFirstPastInputIndex());
+  const size_t num_past_inputs = static_cast<size_t>(gpt_subgraph_.num_layers);
+  for (size_t i = first_past_input_index; i < first_past_input_index + num_past_inputs; ++i) {
+    const Tensor& present = next_inputs[i].Get<Tensor>();
+    TensorShape past_shape = present.Shape();
+    ORT_RETURN_IF(past_shape.NumDimensions() != 5, "Past state is expected to have 5 dimensions");
+    const size_t bytes_per_row = static_cast<size_t>(past_shape.SizeFromDimension(2)) * present.DataType()->Size();
+    const size_t present_key_bytes = static_cast<size_t>(past_shape[1]) * bytes_per_row;
+    const size_t past_key_bytes = kept_rows.size() * bytes_per_row;
+    past_shape[1] = batch_size;
+
+    OrtValue past;
+    Tensor::InitOrtValue(present.DataType(), past_shape, this->temp_space_allocator_, past);
+    const char* present_data = static_cast<const char*>(present.DataRaw());
+    char* past_data = static_cast<char*>(past.GetMutable<Tensor>()->MutableDataRaw());
+    for (size_t j = 0; j < kept_rows.size(); j++) {
+      const size_t offset = static_cast<size_t>(kept_rows[j]) * bytes_per_row;
+      memcpy(past_data + j * bytes_per_row, present_data + offset, bytes_per_row);
+      memcpy(past_data + past_key_bytes + j * bytes_per_row, present_data + present_key_bytes + offset,
+             bytes_per_row);
+    }
+
+    next_inputs[i] = past;
+  }
+
+  return Status::OK();
+}
+
+template <typename T, typename ParametersT>
+void GreedySearchGpt<T, ParametersT>::ExpandLogits(const OrtValue& logits,
+                                                   gsl::span<const int32_t> active_rows,
+                                                   OrtValue& batch_logits) {
+  // Logits has shape (active_rows, input_length, vocab_size). Rows of finished sequences are left as they are since
+  // their next tokens are always the pad token.
+  const TensorShape& logits_shape = logits.Get<Tensor>().Shape();
+  const size_t row_size = static_cast<size_t>(logits_shape.SizeFromDimension(1));
+  if (!batch_logits.IsAllocated() || batch_logits.Get<Tensor>().Shape()[1] != logits_shape[1]) {
+    int64_t dims[] = {this->parameters_->BatchBeamSize(), logits_shape[1], logits_shape[2]};
+    TensorShape shape(&dims[0], 3);
+    Tensor::InitOrtValue(DataTypeImpl::GetType<T>(), shape, this->temp_space_allocator_, batch_logits);
+    gsl::span<T> batch_logits_span = batch_logits.GetMutable<Tensor>()->MutableDataAsSpan<T>();
+    std::fill(batch_logits_span.begin(), batch_logits_span.end(), T{});
+  }
+
+  const T* logits_data = logits.Get<Tensor>().Data<T>();
+  T* batch_logits_data = batch_logits.GetMutable<Tensor>()->MutableData<T>();
+  for (size_t i = 0; i < active_rows.size(); i++) {
+    std::copy_n(logits_data + i * row_size, row_size,
+                batch_logits_data + static_cast<size_t>(active_rows[i]) * row_size);
+  }
+}
+
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::ExecuteWithCachedPrefix(
+    const PrefixCacheEntry& cached_prefix,
+    size_t prefix_length,
+    const FeedsFetchesManager* init_run_feeds_fetches_manager,
+    const FeedsFetchesManager& feeds_fetches_manager,
+    gsl::span<const int32_t> prompt,
+    std::vector<OrtValue>& feeds,
+    std::vector<OrtValue>& fetches) {
+  // The cache owns the buffers, and the subgraph only reads them. Past state of the cached tokens after the prefix is
+  // dropped by ExecuteSubgraphWithPast.
+  const OrtMemoryInfo& location = this->cpu_allocator_->Info();
+  const size_t first_present_output_index = static_cast<size_t>(gpt_subgraph_.GetFirstPresentOutputIndex());
+  fetches.resize(first_present_output_index + cached_prefix.past_data.size());
+  for (size_t i = 0; i < cached_prefix.past_data.size(); i++) {
+    Tensor::InitOrtValue(cached_prefix.past_type, cached_prefix.past_shape,
+                         const_cast<uint8_t*>(cached_prefix.past_data[i].data()), location,
+                         fetches[first_present_output_index + i]);
+  }
+
+  const int past_length = static_cast<int>(prefix_length);
+  if (prefix_length == prompt.size()) {
+    const int64_t vocab_size = static_cast<int64_t>(cached_prefix.logits_data.size() /
+                                                    cached_prefix.logits_type->Size());
+    int64_t logits_dims[] = {1, 1, vocab_size};
+    TensorShape logits_shape(&logits_dims[0], 3);
+    Tensor::InitOrtValue(cached_prefix.logits_type, logits_shape,
+                         const_cast<uint8_t*>(cached_prefix.logits_data.data()), location, fetches[0]);
+    return Status::OK();
+  }
+
+  const bool use_init_run_decoder = init_run_decoder_session_state_ != nullptr;
+  return ExecuteSubgraphWithPast(use_init_run_decoder ? *init_run_decoder_session_state_
+                                                      : this->decoder_session_state_,
+                                 use_init_run_decoder ? *init_run_feeds_fetches_manager : feeds_fetches_manager,
+                                 use_init_run_decoder ? *init_run_gpt_subgraph_ : gpt_subgraph_,
+                                 prompt.subspan(static_cast<size_t>(past_length)),
+                                 past_length,
+                                 0,
+                                 {},
+                                 feeds,
+                                 fetches);
+}
+
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::ExecuteSubgraphWithPast(const SessionState& session_state,
+                                                           const FeedsFetchesManager& feeds_fetches_manager,
+                                                           const GptSubgraph& subgraph,
+                                                           gsl::span<const int32_t> tokens,
+                                                           int past_length,
+                                                           int position_offset,
+                                                           gsl::span<const int32_t> prompt_attention_mask,
+                                                           std::vector<OrtValue>& feeds,
+                                                           std::vector<OrtValue>& fetches) {
+  const int64_t sequence_length = static_cast<int64_t>(tokens.size());
+  const int64_t total_length = past_length + sequence_length;
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+  AllocatorPtr allocator = this->temp_space_allocator_;
+
+  int64_t dims[] = {1, sequence_length};
+  TensorShape input_ids_shape(&dims[0], 2);
+  OrtValue input_ids;
+  Tensor::InitOrtValue(int32_type, input_ids_shape, allocator, input_ids);
+  gsl::copy(tokens, input_ids.GetMutable<Tensor>()->MutableDataAsSpan<int32_t>());
+
+  OrtValue position_ids;
+  Tensor::InitOrtValue(int32_type, input_ids_shape, allocator, position_ids);
+  int32_t* position_data = position_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int64_t i = 0; i < sequence_length; i++) {
+    position_data[i] = static_cast<int32_t>(past_length + i + position_offset);
+  }
+
+  int64_t mask_dims[] = {1, total_length};
+  TensorShape mask_shape(&mask_dims[0], 2);
+  OrtValue attention_mask;
+  Tensor::InitOrtValue(int32_type, mask_shape, allocator, attention_mask);
+  gsl::span<int32_t> mask_data = attention_mask.GetMutable<Tensor>()->MutableDataAsSpan<int32_t>();
+  std::fill(mask_data.begin(), mask_data.end(), 1);
+  gsl::copy(prompt_attention_mask, mask_data);
+
+  feeds[0] = input_ids;
+  feeds[1] = position_ids;
+  feeds[2] = attention_mask;
+
+  // Past state has shape like (2, 1, num_heads, past_seq_len, head_size).
+  const int first_past_input_index = subgraph.GetFirstPastInputIndex();
+  const int first_present_output_index = subgraph.GetFirstPresentOutputIndex();
+  for (int i = 0; i < subgraph.num_layers; i++) {
+    const OrtValue& present_value = fetches[static_cast<size_t>(first_present_output_index) + i];
+    const Tensor& present = present_value.Get<Tensor>();
+    TensorShape past_shape = present.Shape();
+    if (past_shape[3] == past_length) {
+      feeds[static_cast<size_t>(first_past_input_index) + i] = present_value;
+      continue;
+    }
+
+    ORT_RETURN_IF(past_shape[3] < past_length, "Past state has fewer entries than expected");
+    const size_t element_size = present.DataType()->Size();
+    const size_t present_bytes_per_head = static_cast<size_t>(past_shape.SizeFromDimension(3)) * element_size;
+    const size_t past_bytes_per_head = static_cast<size_t>(past_length * past_shape[4]) * element_size;
+    const size_t num_heads = static_cast<size_t>(past_shape.SizeToDimension(3));
+    past_shape[3] = past_length;
+
+    OrtValue past;
+    Tensor::InitOrtValue(present.DataType(), past_shape, allocator, past);
+    const char* present_data = static_cast<const char*>(present.DataRaw());
+    char* past_data = static_cast<char*>(past.GetMutable<Tensor>()->MutableDataRaw());
+    for (size_t j = 0; j < num_heads; j++) {
+      memcpy(past_data + j * past_bytes_per_head, present_data + j * present_bytes_per_head, past_bytes_per_head);
+    }
+    feeds[static_cast<size_t>(first_past_input_index) + i] = past;
+  }
+
+  fetches.clear();
+  return utils::ExecuteSubgraph(session_state,
+                                feeds_fetches_manager,
+                                feeds,
+                                fetches,
+                                {},
+                                ExecutionMode::ORT_SEQUENTIAL,
+                                this->context_.GetTerminateFlag(),
+                                this->context_.Logger(),
+                                this->ort_stream_);
+}
+
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::ExecuteSpeculative(const FeedsFetchesManager* init_run_feeds_fetches_manager,
+                                                           const FeedsFetchesManager& feeds_fetches_manager) {
+  const ParametersT* parameters = this->parameters_;
+
+  int64_t sequences_dims[] = {parameters->batch_size, parameters->max_length};
+  TensorShape sequences_shape(&sequences_dims[0], sizeof(sequences_dims) / sizeof(sequences_dims[0]));
+  Tensor* output_sequences = this->context_.Output(0, sequences_shape);
+
+  GreedySearchState<T> greedy_state;
+  greedy_state.Init(this->cpu_allocator_,
+                    this->temp_space_allocator_,
+                    static_cast<int>(parameters->BatchBeamSize()),
+                    static_cast<int>(parameters->vocab_size),
+                    static_cast<int>(parameters->sequence_length),
+                    static_cast<int>(parameters->max_length),
+                    static_cast<int>(parameters->num_heads),
+                    static_cast<int>(parameters->head_size),
+                    gpt_subgraph_.has_decoder_masked_attention_,
+                    this->IsCuda(),
+                    this->ort_stream_);
+
+  // Not used in greedy search.
+  SamplingState<T> sampling_state;
+
+  std::vector<OrtValue> feeds;
+  std::vector<OrtValue> fetches;
+  IAllocatorUniquePtr<char> buffer;
+  OrtValue expanded_input_ids_in_cpu;
+  ORT_RETURN_IF_ERROR(CreateInitialFeeds(greedy_state.sequence_lengths, expanded_input_ids_in_cpu, feeds, buffer));
+
+  init_greedy_state_func_(&greedy_state,
+                          greedy_state.sequence_lengths,
+                          this->ort_stream_);
+
+  gsl::span<const int32_t> input_ids = expanded_input_ids_in_cpu.Get<Tensor>().DataAsSpan<int32_t>();
+  greedy_state.SetSequence(input_ids,
+                           static_cast<size_t>(parameters->BatchBeamSize()),
+                           parameters->max_length,
+                           parameters->sequence_length);
+
+  // Attention mask of the prompt is kept since later runs build the mask from scratch. Position of a token after the
+  // prompt is its index in the sequence minus the number of padding tokens in the prompt.
+  gsl::span<const int32_t> prompt_mask = feeds[2].Get<Tensor>().DataAsSpan<int32_t>();
+  const std::vector<int32_t> prompt_attention_mask(prompt_mask.begin(), prompt_mask.end());
+  const int position_offset = greedy_state.sequence_lengths[0] - parameters->sequence_length;
+
+  // The draft subgraph only receives the implicit inputs it uses.
+  std::vector<const OrtValue*> draft_implicit_inputs;
+  for (size_t i = 0; i < this->implicit_inputs_.size(); i++) {
+    if (draft_gpt_subgraph_->used_implicit_inputs[i]) {
+      draft_implicit_inputs.push_back(this->implicit_inputs_[i]);
+    }
+  }
+
+  std::vector<OrtValue> draft_feeds;
+  std::vector<OrtValue> draft_fetches;
+  IAllocatorUniquePtr<char> draft_buffer;
+  OrtValue draft_input_ids;
+  std::vector<int32_t> draft_sequence_lengths(1);
+  gsl::span<int32_t> draft_sequence_lengths_span(draft_sequence_lengths);
+  ORT_RETURN_IF_ERROR(draft_gpt_subgraph_->CreateInitialFeeds(*this->context_.Input<Tensor>(0),
+                                                              draft_implicit_inputs,
+                                                              parameters->num_beams,
+                                                              parameters->pad_token_id,
+                                                              draft_sequence_lengths_span,
+                                                              draft_input_ids,
+                                                              this->context_.GetInputOrtValue(6),
+                                                              draft_feeds,
+                                                              this->create_inputs_func_,
+                                                              this->add_to_feeds_func_,
+                                                              draft_buffer,
+                                                              this->ort_stream_));
+
+  // Run the prompt with both subgraphs.
+  const bool use_init_run_decoder = init_run_decoder_session_state_ != nullptr;
+  ORT_RETURN_IF_ERROR(utils::ExecuteSubgraph(use_init_run_decoder ? *init_run_decoder_session_state_
+                                                                  : this->decoder_session_state_,
+                                             use_init_run_decoder ? *init_run_feeds_fetches_manager
+                                                                  : feeds_fetches_manager,
+                                             feeds,
+                                             fetches,
+                                             {},
+                                             ExecutionMode::ORT_SEQUENTIAL,
+                                             this->context_.GetTerminateFlag(),
+                                             this->context_.Logger(),
+                                             this->ort_stream_));
+  ORT_RETURN_IF_ERROR(utils::ExecuteSubgraph(*draft_decoder_session_state_,
+                                             *draft_feeds_fetches_manager_,
+                                             draft_feeds,
+                                             draft_fetches,
+                                             {},
+                                             ExecutionMode::ORT_SEQUENTIAL,
+                                             this->context_.GetTerminateFlag(),
+                                             this->context_.Logger(),
+                                             this->ort_stream_));
+
+  int iteration_counter = 1;
+  gsl::span<int32_t> next_tokens;
+  ORT_RETURN_IF_ERROR(this->GenerateNextToken(fetches[0],
+                                              next_tokens,
+                                              greedy_state,
+                                              sampling_state,
+                                              iteration_counter,
+                                              parameters->eos_token_id));
+
+  // Number of tokens at the beginning of the sequence that have valid entries in past state of each subgraph.
+  int past_length = parameters->sequence_length;
+  int draft_past_length = parameters->sequence_length;
+  int current_length = parameters->sequence_length + 1;
+
+  std::vector<int32_t> draft_tokens;
+  std::vector<int32_t> verify_tokens;
+  draft_tokens.reserve(static_cast<size_t>(parameters->num_speculative_tokens));
+  std::vector<float> draft_scores(static_cast<size_t>(parameters->vocab_size));
+  std::vector<int32_t> draft_sequence_buffer(2 * static_cast<size_t>(parameters->max_length));
+  Sequences draft_sequences;
+  while (current_length < parameters->max_length && !greedy_state.eos_meet[0]) {
+    // The last token of the verification run is selected without a draft, so it needs one more position.
+    const int num_draft_tokens = std::min(parameters->num_speculative_tokens,
+                                          parameters->max_length - current_length - 1);
+
+    // The draft tokens are selected by the logits processors too, with a copy of the sequence that the draft tokens
+    // are appended to, so that the draft proposes what the verification selects when the logits agree.
+    gsl::span<const int32_t> sequence = greedy_state.sequences.GetSequence(0);
+    std::copy(sequence.begin(), sequence.end(), draft_sequence_buffer.begin());
+    draft_sequences.Init(draft_sequence_buffer, 1, current_length, parameters->max_length);
+    draft_tokens.clear();
+    for (int i = 0; i < num_draft_tokens; i++) {
+      gsl::span<const int32_t> tokens = (i == 0) ? sequence.subspan(draft_past_length)
+                                                 : gsl::make_span(&draft_tokens.back(), 1);
+      ORT_RETURN_IF_ERROR(ExecuteSubgraphWithPast(*draft_decoder_session_state_, *draft_feeds_fetches_manager_,
+                                             *draft_gpt_subgraph_, tokens, draft_past_length, position_offset,
+                                             prompt_attention_mask, draft_feeds, draft_fetches));
+      draft_past_length += static_cast<int>(tokens.size());
+
+      gsl::span<float> scores(draft_scores);
+      gpt_details::GetLastTokenScores(draft_fetches[0].Get<Tensor>(), scores);
+      this->logits_processors_.Process(&draft_sequences, scores, iteration_counter + i + 1);
+      draft_tokens.push_back(static_cast<int32_t>(std::max_element(scores.begin(), scores.end()) - scores.begin()));
+      gsl::span<int32_t> draft_token(&draft_tokens.back(), 1);
+      draft_sequences.AppendNextTokenToSequences(draft_token);
+
+      // The draft token is checked as selected, before the verification replaces EOS by the pad token. Tokens after
+      // EOS are never accepted, so there is no need to propose them.
+      if (draft_tokens.back() == parameters->eos_token_id) {
+        break;
+      }
+    }
+    const int num_proposed_tokens = static_cast<int>(draft_tokens.size());
+
+    verify_tokens.assign(sequence.begin() + past_length, sequence.end());
+    verify_tokens.insert(verify_tokens.end(), draft_tokens.begin(), draft_tokens.end());
+    ORT_RETURN_IF_ERROR(ExecuteSubgraphWithPast(this->decoder_session_state_, feeds_fetches_manager, gpt_subgraph_,
+                                           verify_tokens, past_length, position_offset, prompt_attention_mask,
+                                           feeds, fetches));
+
+    // Logits of the last pending token and the draft tokens, one position at a time.
+    const Tensor& logits = fetches[0].Get<Tensor>();
+    const int64_t vocab_size = logits.Shape()[2];
+    const int64_t first_row = static_cast<int64_t>(verify_tokens.size()) - num_proposed_tokens - 1;
+    int64_t row_dims[] = {1, 1, vocab_size};
+    TensorShape row_shape(&row_dims[0], 3);
+    for (int i = 0; i <= num_proposed_tokens; i++) {
+      OrtValue row_logits;
+      Tensor::InitOrtValue(logits.DataType(), row_shape,
+                           const_cast<T*>(logits.Data<T>()) + (first_row + i) * vocab_size,
+                           logits.Location(), row_logits);
+      ORT_RETURN_IF_ERROR(this->GenerateNextToken(row_logits,
+                                                  next_tokens,
+                                                  greedy_state,
+                                                  sampling_state,
+                                                  ++iteration_counter,
+                                                  parameters->eos_token_id));
+      ++current_length;
+
+      if (greedy_state.eos_meet[0] || current_length >= parameters->max_length ||
+          i == num_proposed_tokens || next_tokens[0] != draft_tokens[i]) {
+        break;
+      }
+    }
+
+    // Only the last selected token is not in past state yet.
+    past_length = current_length - 1;
+    draft_past_length = std::min(draft_past_length, current_length - 1);
+  }
+
+  gsl::span<int32_t> output = output_sequences->MutableDataAsSpan<int32_t>();
+  gsl::copy(greedy_state.sequences.GetSequence(0), output.subspan(0, static_cast<size_t>(parameters->max_length)));
+
+  return Status::OK();
+}
+
 template <typename T, typename ParametersT>
 Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
                                                 const FeedsFetchesManager& feeds_fetches_manager) {
   auto status = Status::OK();
   const ParametersT* parameters = this->parameters_;
 
+  // Speculative decoding is implemented for greedy search of a single sequence on CPU. Otherwise the draft subgraph
+  // is not used.
+  if (draft_decoder_session_state_ != nullptr &&
+      std::is_same<ParametersT, GreedySearchParameters>::value &&
+      !this->IsCuda() &&
+      parameters->BatchBeamSize() == 1 &&
+      parameters->num_speculative_tokens > 0 &&
+      !gpt_subgraph_.past_present_share_buffer_ &&
+      !draft_gpt_subgraph_->past_present_share_buffer_) {
+    return ExecuteSpeculative(init_run_feeds_fetches_manager, feeds_fetches_manager);
+  }
+
   // Allocate output tensors.
   int64_t sequences_dims[] = {parameters->batch_size, parameters->max_length};
   TensorShape sequences_shape(&sequences_dims[0], sizeof(sequences_dims) / sizeof(sequences_dims[0]));
@@ -268,6 +768,30 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
                        this->temp_space_allocator_->Info(),
                        position_ids);
 
+  // On CPU, finished sequences are dropped from the subgraph inputs so that the decoder only runs on the sequences
+  // still being generated. active_rows maps each row of the subgraph inputs to its sequence in the batch.
+  const bool compact_batch = !this->IsCuda() &&
+                             !gpt_subgraph_.past_present_share_buffer_ &&
+                             !gpt_subgraph_.has_fixed_batch_size_;
+  const size_t batch_beam_size = static_cast<size_t>(parameters->BatchBeamSize());
+  std::vector<int32_t> active_rows(batch_beam_size);
+  std::iota(active_rows.begin(), active_rows.end(), 0);
+  std::vector<int32_t> active_next_tokens;
+  std::vector<int32_t> kept_rows;
+  OrtValue batch_logits;
+
+  // Prompt of a single sequence without padding can start from past state in the prefix cache.
+  const bool use_prefix_cache = prefix_cache_ != nullptr &&
+                                !this->IsCuda() &&
+                                batch_beam_size == 1 &&
+                                !gpt_subgraph_.past_present_share_buffer_ &&
+                                greedy_state.sequence_lengths[0] == parameters->sequence_length;
+  std::shared_ptr<const PrefixCacheEntry> cached_prefix;
+  size_t cached_prefix_length = 0;
+  if (use_prefix_cache) {
+    cached_prefix = prefix_cache_->Lookup(input_ids, cached_prefix_length);
+  }
+
   int current_length = parameters->sequence_length;
   int iteration_counter = 0;
   while (current_length < parameters->max_length) {
@@ -281,8 +805,13 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
 #endif
 
     // For the first iteration use the init_run_decoder subgraph (if present)
-    if (iteration_counter++ == 0 &&
-        init_run_decoder_session_state_ != nullptr) {
+    const bool is_first_iteration = (iteration_counter++ == 0);
+    if (is_first_iteration && cached_prefix != nullptr) {
+      status = ExecuteWithCachedPrefix(*cached_prefix, cached_prefix_length,
+                                       init_run_feeds_fetches_manager, feeds_fetches_manager,
+                                       input_ids, feeds, fetches);
+    } else if (is_first_iteration &&
+               init_run_decoder_session_state_ != nullptr) {
 #ifdef DEBUG_NODE_INPUTS_OUTPUTS
       const_cast<SessionState*>(this->init_run_decoder_session_state_)->IncrementGraphExecutionCounter();
 #endif
@@ -312,10 +841,23 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
 
     ORT_RETURN_IF_ERROR(status);
 
-    const OrtValue& logits = fetches[0];
+    if (is_first_iteration && use_prefix_cache && cached_prefix_length < input_ids.size()) {
+      const size_t first_present_output_index = static_cast<size_t>(gpt_subgraph_.GetFirstPresentOutputIndex());
+      prefix_cache_->Insert(input_ids,
+                            gsl::make_span(fetches).subspan(first_present_output_index,
+                                                            static_cast<size_t>(gpt_subgraph_.num_layers)),
+                            fetches[0].Get<Tensor>());
+    }
+
+    const OrtValue* logits = &fetches[0];
+    if (active_rows.size() < batch_beam_size) {
+      ExpandLogits(fetches[0], active_rows, batch_logits);
+      logits = &batch_logits;
+    }
+
     gsl::span<int32_t> next_tokens;
 
-    ORT_RETURN_IF_ERROR(this->GenerateNextToken(logits,
+    ORT_RETURN_IF_ERROR(this->GenerateNextToken(*logits,
                                                 next_tokens,
                                                 greedy_state,
                                                 sampling_state,
@@ -361,10 +903,39 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
     if (current_length < parameters->max_length) {
       bool increase_position = (iteration_counter > 1);
 
+      gsl::span<const int32_t> step_next_tokens = ReinterpretAsSpan<const int32_t>(next_tokens);
+      if (active_rows.size() < batch_beam_size) {
+        active_next_tokens.resize(active_rows.size());
+        for (size_t i = 0; i < active_rows.size(); i++) {
+          active_next_tokens[i] = next_tokens[active_rows[i]];
+        }
+        step_next_tokens = active_next_tokens;
+      }
+
       ORT_RETURN_IF_ERROR(UpdateFeeds(fetches, feeds, current_length,
                                       position_ids, increase_position,
-                                      ReinterpretAsSpan<const int32_t>(next_tokens),
+                                      step_next_tokens,
                                       current_length - 1));
+
+      if (compact_batch) {
+        kept_rows.clear();
+        for (size_t i = 0; i < active_rows.size(); i++) {
+          if (!eos_meet[active_rows[i]]) {
+            kept_rows.push_back(static_cast<int32_t>(i));
+          }
+        }
+
+        // Copying the past state costs about the same memory traffic as one decoder step, so wait until at least
+        // one eighth of the rows are finished before compacting.
+        const size_t finished_rows = active_rows.size() - kept_rows.size();
+        if (finished_rows > 0 && finished_rows * 8 >= active_rows.size()) {
+          ORT_RETURN_IF_ERROR(CompactFeeds(feeds, position_ids, kept_rows));
+          for (auto& row : kept_rows) {
+            row = active_rows[row];
+          }
+          active_rows.swap(kept_rows);
+        }
+      }
     }
     if (gpt_subgraph_.past_present_share_buffer_) {
       // clear fetched values before presents[]
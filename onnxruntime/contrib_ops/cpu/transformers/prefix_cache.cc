@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include "core/common/parse_string.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+#include "contrib_ops/cpu/transformers/prefix_cache.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+size_t PrefixCacheEntry::SizeInBytes() const {
+  size_t size = tokens.size() * sizeof(int32_t) + logits_data.size();
+  for (const auto& data : past_data) {
+    size += data.size();
+  }
+  return size;
+}
+
+size_t PrefixCache::CommonPrefixLength(gsl::span<const int32_t> tokens, gsl::span<const int32_t> entry_tokens) {
+  const size_t length = std::min(tokens.size(), entry_tokens.size());
+  return static_cast<size_t>(std::mismatch(tokens.begin(), tokens.begin() + length, entry_tokens.begin()).first -
+                             tokens.begin());
+}
+
+std::shared_ptr<const PrefixCacheEntry> PrefixCache::Lookup(gsl::span<const int32_t> tokens, size_t& prefix_length) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  prefix_length = 0;
+  auto next = index_.lower_bound(tokens);
+  EntryList::iterator found = entries_.end();
+  if (next != index_.end() && next->first.size() == tokens.size() &&
+      std::equal(tokens.begin(), tokens.end(), next->first.begin())) {
+    found = next->second;
+    prefix_length = tokens.size();
+  } else {
+    // In lexicographic order, the entries sharing the longest prefix with tokens are right before or after them.
+    // The whole tokens need an entry of the same tokens, since logits are cached for the last token only.
+    const size_t max_prefix_length = tokens.empty() ? 0 : tokens.size() - 1;
+    auto consider = [&](Index::iterator it) {
+      const size_t length = std::min(CommonPrefixLength(tokens, it->first), max_prefix_length);
+      if (length > prefix_length) {
+        prefix_length = length;
+        found = it->second;
+      }
+    };
+    if (next != index_.end()) {
+      consider(next);
+    }
+    if (next != index_.begin()) {
+      consider(std::prev(next));
+    }
+  }
+
+  if (found == entries_.end()) {
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, found);
+  return entries_.front();
+}
+
+void PrefixCache::Insert(gsl::span<const int32_t> tokens,
+                         gsl::span<const OrtValue> present_values,
+                         const Tensor& logits) {
+  if (tokens.empty() || present_values.empty()) {
+    return;
+  }
+
+  auto entry = std::make_shared<PrefixCacheEntry>();
+  entry->tokens.assign(tokens.begin(), tokens.end());
+
+  const Tensor& first_present = present_values[0].Get<Tensor>();
+  entry->past_type = first_present.DataType();
+  entry->past_shape = first_present.Shape();
+  const size_t past_bytes = first_present.SizeInBytes();
+  const size_t logits_bytes = static_cast<size_t>(logits.Shape()[2]) * logits.DataType()->Size();
+  if (tokens.size() * sizeof(int32_t) + past_bytes * present_values.size() + logits_bytes > max_size_in_bytes_) {
+    return;
+  }
+
+  entry->past_data.resize(present_values.size());
+  for (size_t i = 0; i < present_values.size(); i++) {
+    const Tensor& present = present_values[i].Get<Tensor>();
+    ORT_ENFORCE(present.Shape() == entry->past_shape && present.DataType() == entry->past_type);
+    entry->past_data[i].resize(past_bytes);
+    memcpy(entry->past_data[i].data(), present.DataRaw(), past_bytes);
+  }
+
+  entry->logits_type = logits.DataType();
+  entry->logits_data.resize(logits_bytes);
+  const auto* logits_data = static_cast<const uint8_t*>(logits.DataRaw());
+  memcpy(entry->logits_data.data(), logits_data + logits.SizeInBytes() - logits_bytes, logits_bytes);
+
+  const size_t entry_bytes = entry->SizeInBytes();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto existing = index_.find(tokens);
+  if (existing != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, existing->second);
+    return;
+  }
+
+  while (!entries_.empty() && size_in_bytes_ + entry_bytes > max_size_in_bytes_) {
+    auto last = std::prev(entries_.end());
+    index_.erase(gsl::make_span((*last)->tokens));
+    size_in_bytes_ -= (*last)->SizeInBytes();
+    entries_.erase(last);
+  }
+
+  entries_.push_front(std::move(entry));
+  index_.emplace(gsl::make_span(entries_.front()->tokens), entries_.begin());
+  size_in_bytes_ += entry_bytes;
+}
+
+size_t PrefixCache::SizeInBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_in_bytes_;
+}
+
+std::unique_ptr<PrefixCache> CreatePrefixCache(const OpKernelInfo& info) {
+  const std::string config = info.GetConfigOptions().GetConfigOrDefault(
+      kOrtSessionOptionsGenerationPrefixCacheSizeInBytes, "0");
+  size_t max_size_in_bytes = 0;
+  ORT_ENFORCE(TryParseStringWithClassicLocale(config, max_size_in_bytes),
+              "Invalid value of ", kOrtSessionOptionsGenerationPrefixCacheSizeInBytes, ": ", config);
+  if (max_size_in_bytes == 0) {
+    return nullptr;
+  }
+
+  return std::make_unique<PrefixCache>(max_size_in_bytes);
+}
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
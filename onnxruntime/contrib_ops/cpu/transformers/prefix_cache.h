@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <gsl/gsl>
+#include "core/framework/op_kernel_info.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+// Past state computed by the GPT subgraph for a prompt.
+struct PrefixCacheEntry {
+  std::vector<int32_t> tokens;
+
+  // present_* outputs of the subgraph. Shape is like (2, 1, num_heads, tokens.size(), head_size).
+  MLDataType past_type = nullptr;
+  TensorShape past_shape;
+  std::vector<std::vector<uint8_t>> past_data;
+
+  // Logits of the last token. Shape is (1, 1, vocab_size).
+  MLDataType logits_type = nullptr;
+  std::vector<uint8_t> logits_data;
+
+  size_t SizeInBytes() const;
+};
+
+// Cache of past state of prompts shared by Run calls of a session, so that a prompt sharing a prefix with a cached
+// prompt (like a system prompt followed by different questions) only needs to compute the tokens after the prefix.
+// Entries are indexed once by their whole token ids in lexicographic order, where the entry sharing the longest prefix
+// with some tokens is next to the position of those tokens. The least recently used entries are evicted when total
+// size exceeds the budget. It is thread safe.
+class PrefixCache {
+ public:
+  explicit PrefixCache(size_t max_size_in_bytes) : max_size_in_bytes_(max_size_in_bytes) {}
+
+  // Returns the entry sharing the longest prefix with tokens, or nullptr when there is none. prefix_length is the
+  // length of the shared prefix, whose past state is the first prefix_length entries of the past state of the entry.
+  // The whole tokens are only matched by an entry of the same tokens, since logits are cached for the last token only.
+  std::shared_ptr<const PrefixCacheEntry> Lookup(gsl::span<const int32_t> tokens, size_t& prefix_length);
+
+  // Copy the past state of tokens and logits of last token into the cache.
+  // present_values are the present_* outputs of subgraph, and logits has shape (1, sequence_length, vocab_size).
+  void Insert(gsl::span<const int32_t> tokens,
+              gsl::span<const OrtValue> present_values,
+              const Tensor& logits);
+
+  size_t SizeInBytes() const;
+
+ private:
+  using EntryList = std::list<std::shared_ptr<const PrefixCacheEntry>>;
+
+  // Lexicographic order of token ids.
+  struct TokensLess {
+    bool operator()(gsl::span<const int32_t> a, gsl::span<const int32_t> b) const {
+      return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    }
+  };
+
+  // Keys are the tokens of the entries, which are not modified while the entries are in the cache.
+  using Index = std::map<gsl::span<const int32_t>, EntryList::iterator, TokensLess>;
+
+  // Length of the common prefix of tokens and the tokens of an entry.
+  static size_t CommonPrefixLength(gsl::span<const int32_t> tokens, gsl::span<const int32_t> entry_tokens);
+
+  const size_t max_size_in_bytes_;
+  size_t size_in_bytes_ = 0;
+
+  mutable std::mutex mutex_;
+
+  // Most recently used entry is in the front.
+  EntryList entries_;
+  Index index_;
+};
+
+// Create the prefix cache with size from session option kOrtSessionOptionsGenerationPrefixCacheSizeInBytes.
+// Returns nullptr when the cache is disabled.
+std::unique_ptr<PrefixCache> CreatePrefixCache(const OpKernelInfo& info);
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
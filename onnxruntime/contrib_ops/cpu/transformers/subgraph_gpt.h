@@ -48,6 +48,9 @@ class GptSubgraph : public Subgraph {
     return first_present_output_index_;
   }
 
+  // Whether batch size of past state is fixed in the subgraph, so finished sequences cannot be removed from inputs.
+  bool has_fixed_batch_size_ = false;
+
  private:
   int first_past_input_index_;
   int first_present_output_index_;
@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <sstream>
+#include <vector>
 
 namespace onnxruntime {
 
@@ -23,6 +25,14 @@ struct AllocatorStats {
                                   // unknown.
   int64_t bytes_limit;
 
+  // Statistics of a size class of allocators that serve small allocations from fixed size blocks.
+  struct SizeClassStats {
+    int64_t block_size;  // Size of the blocks of the class.
+    int64_t num_allocs;  // Number of allocations served by the class.
+    int64_t num_hits;    // Number of allocations that reused a free block without a new slab.
+  };
+  std::vector<SizeClassStats> size_class_stats;  // Empty for allocators without size classes.
+
   AllocatorStats() { Clear(); }
 
   void Clear() {
@@ -35,6 +45,7 @@ struct AllocatorStats {
     this->max_alloc_size = 0;
     this->bytes_limit = 0;
     this->total_allocated_bytes = 0;
+    this->size_class_stats.clear();
   }
 
   std::string DebugString() const {
@@ -48,6 +59,10 @@ struct AllocatorStats {
        << "NumArenaExtensions:       " << this->num_arena_extensions << "\n"
        << "NumArenaShrinkages:       " << this->num_arena_shrinkages << "\n"
        << "MaxAllocSize:             " << this->max_alloc_size << "\n";
+    for (const auto& size_class : this->size_class_stats) {
+      ss << "SizeClassHits[" << size_class.block_size << "]: " << size_class.num_hits << "/" << size_class.num_allocs
+         << "\n";
+    }
     return ss.str();
   }
 };
@@ -13,6 +13,7 @@
 #include "core/common/logging/logging.h"
 #include "core/common/narrow.h"
 #include "core/framework/bfc_arena.h"
+#include "core/framework/slab_arena.h"
 
 namespace onnxruntime {
 using namespace common;
@@ -34,6 +35,9 @@ AllocatorPtr CreateAllocator(const AllocatorCreationInfo& info) {
     int64_t max_power_of_two_extend_bytes = info.arena_cfg.max_power_of_two_extend_bytes == -1
                                                 ? BFCArena::DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES
                                                 : info.arena_cfg.max_power_of_two_extend_bytes;
+    int64_t max_thread_cache_bytes = info.arena_cfg.max_thread_cache_bytes == -1
+                                         ? BFCArena::DEFAULT_MAX_THREAD_CACHE_BYTES
+                                         : info.arena_cfg.max_thread_cache_bytes;
     ArenaExtendStrategy arena_extend_str;
     switch (info.arena_cfg.arena_extend_strategy) {
       case static_cast<int>(ArenaExtendStrategy::kSameAsRequested):
@@ -51,6 +55,9 @@ AllocatorPtr CreateAllocator(const AllocatorCreationInfo& info) {
 
     if (info.use_stream_aware_arena) {
 #ifdef ORT_ENABLE_STREAM
+      // Chunks of a thread cache are not tied to a stream, so they could be reused by another stream too early.
+      ORT_ENFORCE(max_thread_cache_bytes == 0,
+                  "max_thread_cache_bytes is not supported by the stream aware arena but is ", max_thread_cache_bytes);
       return AllocatorPtr(
           std::make_unique<StreamAwareArena>(std::move(device_allocator),
                                              max_mem,
@@ -62,6 +69,22 @@ AllocatorPtr CreateAllocator(const AllocatorCreationInfo& info) {
 #else
       ORT_THROW("StreamAwareArena should be transparent to minimal build.");
 #endif
+    } else if (info.arena_cfg.use_slab_arena == 1) {
+      // The free lists of the slabs are kept in the memory of the blocks.
+      ORT_ENFORCE(device_allocator->Info().device.Type() == OrtDevice::CPU,
+                  "Slab arena requires CPU accessible memory but the allocator is for ",
+                  device_allocator->Info().ToString());
+      // Allocations up to 4KB, the ones a thread cache would keep, are served by the slabs without the arena lock.
+      ORT_ENFORCE(max_thread_cache_bytes == 0,
+                  "max_thread_cache_bytes is not supported by the slab arena but is ", max_thread_cache_bytes);
+      return AllocatorPtr(
+          std::make_unique<SlabArena>(std::move(device_allocator),
+                                      max_mem,
+                                      arena_extend_str,
+                                      initial_chunk_size_bytes,
+                                      max_dead_bytes_per_chunk,
+                                      initial_growth_chunk_size_bytes,
+                                      max_power_of_two_extend_bytes));
     } else {
       return AllocatorPtr(
           std::make_unique<BFCArena>(std::move(device_allocator),
@@ -70,7 +93,8 @@ AllocatorPtr CreateAllocator(const AllocatorCreationInfo& info) {
                                      initial_chunk_size_bytes,
                                      max_dead_bytes_per_chunk,
                                      initial_growth_chunk_size_bytes,
-                                     max_power_of_two_extend_bytes));
+                                     max_power_of_two_extend_bytes,
+                                     max_thread_cache_bytes));
     }
   } else {
     return device_allocator;
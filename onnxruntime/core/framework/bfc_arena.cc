@@ -3,6 +3,7 @@
 
 #include "core/framework/allocator.h"
 #include "core/framework/bfc_arena.h"
+#include <algorithm>
 #include <type_traits>
 
 namespace onnxruntime {
@@ -12,7 +13,8 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
                    int initial_chunk_size_bytes,
                    int max_dead_bytes_per_chunk,
                    int initial_growth_chunk_size_bytes,
-                   int64_t max_power_of_two_extend_bytes)
+                   int64_t max_power_of_two_extend_bytes,
+                   int64_t max_thread_cache_bytes)
     : IAllocator(OrtMemoryInfo(resource_allocator->Info().name,
                                OrtAllocatorType::OrtArenaAllocator,
                                resource_allocator->Info().device,
@@ -25,12 +27,14 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
       initial_chunk_size_bytes_(initial_chunk_size_bytes),
       max_dead_bytes_per_chunk_(max_dead_bytes_per_chunk),
       initial_growth_chunk_size_bytes_(initial_growth_chunk_size_bytes),
-      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes) {
+      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes),
+      max_thread_cache_bytes_(max_thread_cache_bytes) {
   LOGS_DEFAULT(INFO) << "Creating BFCArena for " << device_allocator_->Info().name
                      << " with following configs: initial_chunk_size_bytes: " << initial_chunk_size_bytes_
                      << " max_dead_bytes_per_chunk: " << max_dead_bytes_per_chunk_
                      << " initial_growth_chunk_size_bytes: " << initial_growth_chunk_size_bytes_
                      << " max_power_of_two_extend_bytes: " << max_power_of_two_extend_bytes_
+                     << " max_thread_cache_bytes: " << max_thread_cache_bytes_
                      << " memory limit: " << total_memory
                      << " arena_extend_strategy: " << static_cast<int32_t>(arena_extend_strategy);
 
@@ -75,9 +79,20 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
       ORT_ENFORCE(BinForSize(bin_size * 2) != BinFromIndex(b));
     }
   }
+
+  if (max_thread_cache_bytes_ > 0) {
+    thread_cache_owner_ = std::make_shared<ThreadCacheOwner>();
+    thread_cache_owner_->arena = this;
+  }
 }
 
 BFCArena::~BFCArena() {
+  if (thread_cache_owner_) {
+    // Chunks left in thread caches are released with the regions below.
+    std::lock_guard<std::mutex> owner_lock(thread_cache_owner_->mutex);
+    thread_cache_owner_->arena = nullptr;
+  }
+
   for (const auto& region : region_manager_.regions()) {
     device_allocator_->Free(region.ptr());
   }
@@ -269,14 +284,92 @@ size_t BFCArena::RoundedBytes(size_t bytes) {
 }
 
 void* BFCArena::Alloc(size_t size) {
+  if (thread_cache_owner_ && size > 0 && size <= kThreadCacheMaxChunkSize) {
+    const size_t rounded_bytes = RoundedBytes(size);
+    ThreadCache& cache = GetThreadCache();
+    auto& free_list = cache.free_lists[rounded_bytes / kMinAllocationSize - 1];
+    if (!free_list.empty()) {
+      void* ptr = free_list.back();
+      free_list.pop_back();
+      cache.cached_bytes -= rounded_bytes;
+      thread_cached_bytes_ -= static_cast<int64_t>(rounded_bytes);
+      ++thread_cache_num_allocs_;
+      return ptr;
+    }
+  }
+
   return AllocateRawInternal(size, false, nullptr, false, nullptr);
 }
 
+BFCArena::ThreadCache::~ThreadCache() {
+  std::lock_guard<std::mutex> owner_lock(owner->mutex);
+  if (owner->arena != nullptr) {
+    std::lock_guard<std::shared_mutex> lock(owner->arena->lock_);
+    owner->arena->FlushThreadCacheLocked(*this, true);
+  }
+}
+
+BFCArena::ThreadCache& BFCArena::GetThreadCache() {
+  // Caches of all arenas used by this thread. The owner is unique per arena and kept alive by the caches, so it
+  // identifies the arena even if another arena is created at the same address later.
+  thread_local std::vector<std::unique_ptr<ThreadCache>> thread_caches;
+  for (auto& cache : thread_caches) {
+    if (cache->owner == thread_cache_owner_) {
+      return *cache;
+    }
+  }
+
+  // Drop the caches of arenas that have been destroyed before adding a new one.
+  thread_caches.erase(std::remove_if(thread_caches.begin(), thread_caches.end(),
+                                     [](const std::unique_ptr<ThreadCache>& cache) {
+                                       std::lock_guard<std::mutex> owner_lock(cache->owner->mutex);
+                                       return cache->owner->arena == nullptr;
+                                     }),
+                      thread_caches.end());
+
+  auto cache = std::make_unique<ThreadCache>();
+  cache->owner = thread_cache_owner_;
+  cache->pending_frees.reserve(kThreadCachePendingFrees);
+  thread_caches.push_back(std::move(cache));
+  return *thread_caches.back();
+}
+
+void BFCArena::FlushThreadCacheLocked(ThreadCache& cache, bool release_cached_chunks) {
+  for (void* ptr : cache.pending_frees) {
+    if (!release_cached_chunks && reserved_chunks_.find(ptr) == reserved_chunks_.end()) {
+      ChunkHandle h = region_manager_.get_handle(ptr);
+      ORT_ENFORCE(h != kInvalidChunkHandle);
+      const size_t size = ChunkFromHandle(h)->size;
+      if (size <= kThreadCacheMaxChunkSize &&
+          static_cast<int64_t>(cache.cached_bytes + size) <= max_thread_cache_bytes_) {
+        // Keep the chunk in use and hand it out again from the thread cache.
+        cache.free_lists[size / kMinAllocationSize - 1].push_back(ptr);
+        cache.cached_bytes += size;
+        thread_cached_bytes_ += static_cast<int64_t>(size);
+        continue;
+      }
+    }
+    FreeLocked(ptr);
+  }
+  cache.pending_frees.clear();
+
+  if (release_cached_chunks) {
+    for (auto& free_list : cache.free_lists) {
+      for (void* ptr : free_list) {
+        DeallocateRawInternal(ptr);
+      }
+      free_list.clear();
+    }
+    thread_cached_bytes_ -= static_cast<int64_t>(cache.cached_bytes);
+    cache.cached_bytes = 0;
+  }
+}
+
 void* BFCArena::Reserve(size_t size) {
   if (size == 0)
     return nullptr;
 
-  std::lock_guard<std::mutex> lock(lock_);
+  std::lock_guard<std::shared_mutex> lock(lock_);
 
   LOGS_DEFAULT(INFO) << "Reserving memory in BFCArena for " << device_allocator_->Info().name << " size: " << size;
 
@@ -293,7 +386,7 @@ void* BFCArena::Reserve(size_t size) {
 }
 
 size_t BFCArena::RequestedSize(const void* ptr) {
-  std::lock_guard<std::mutex> lock(lock_);
+  std::lock_guard<std::shared_mutex> lock(lock_);
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
   BFCArena::Chunk* c = ChunkFromHandle(h);
@@ -301,7 +394,7 @@ size_t BFCArena::RequestedSize(const void* ptr) {
 }
 
 size_t BFCArena::AllocatedSize(const void* ptr) {
-  std::lock_guard<std::mutex> lock(lock_);
+  std::lock_guard<std::shared_mutex> lock(lock_);
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
   BFCArena::Chunk* c = ChunkFromHandle(h);
@@ -325,7 +418,15 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
-  std::lock_guard<std::mutex> lock(lock_);
+  // Look up the thread cache before taking the lock, as it may lock the owners of other arenas.
+  ThreadCache* thread_cache = thread_cache_owner_ ? &GetThreadCache() : nullptr;
+
+  std::lock_guard<std::shared_mutex> lock(lock_);
+  if (thread_cache != nullptr) {
+    // Return the pending frees of this thread while holding the lock anyway, so that they can be reused.
+    FlushThreadCacheLocked(*thread_cache, false);
+  }
+
   // search for a valid chunk
   auto* chunk = FindChunkPtr(bin_num,
                              rounded_bytes,
@@ -334,6 +435,12 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
                              enable_cross_stream_reusing,
                              wait_fn);
 
+  if (chunk == nullptr && thread_cache != nullptr && thread_cache->cached_bytes > 0) {
+    // Chunks cached by this thread may coalesce into a chunk that fits, which is better than extending the arena.
+    FlushThreadCacheLocked(*thread_cache, true);
+    chunk = FindChunkPtr(bin_num, rounded_bytes, num_bytes, stream, enable_cross_stream_reusing, wait_fn);
+  }
+
   if (chunk != nullptr) {
     // if it is on default stream (the new allocate chunk), assign to current stream
     if (chunk->stream == nullptr) {
@@ -377,8 +484,14 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
 }
 
 void BFCArena::GetStats(AllocatorStats* stats) {
-  std::lock_guard<std::mutex> lock(lock_);
+  ThreadCache* thread_cache = thread_cache_owner_ ? &GetThreadCache() : nullptr;
+  std::lock_guard<std::shared_mutex> lock(lock_);
+  if (thread_cache != nullptr) {
+    FlushThreadCacheLocked(*thread_cache, false);
+  }
   *stats = stats_;
+  stats->bytes_in_use -= thread_cached_bytes_;
+  stats->num_allocs += thread_cache_num_allocs_;
 }
 
 BFCArena::Chunk* BFCArena::SplitFreeChunkFromBin(BFCArena::Bin::FreeChunkSet* free_chunks,
@@ -496,7 +609,37 @@ void BFCArena::Free(void* p) {
   if (p == nullptr) {
     return;
   }
-  std::lock_guard<std::mutex> lock(lock_);
+
+  if (thread_cache_owner_) {
+    // Only small chunks are deferred to the thread cache. Larger chunks are returned to the bins right away, so that
+    // their memory can be reused by other threads. The size of a chunk in use doesn't change, so a shared lock is
+    // enough to read it.
+    bool defer = false;
+    {
+      std::shared_lock<std::shared_mutex> lock(lock_);
+      if (reserved_chunks_.find(p) == reserved_chunks_.end()) {
+        ChunkHandle h = region_manager_.get_handle(p);
+        ORT_ENFORCE(h != kInvalidChunkHandle);
+        defer = ChunkFromHandle(h)->size <= kThreadCacheMaxChunkSize;
+      }
+    }
+
+    if (defer) {
+      ThreadCache& cache = GetThreadCache();
+      cache.pending_frees.push_back(p);
+      if (cache.pending_frees.size() >= kThreadCachePendingFrees) {
+        std::lock_guard<std::shared_mutex> lock(lock_);
+        FlushThreadCacheLocked(cache, false);
+      }
+      return;
+    }
+  }
+
+  std::lock_guard<std::shared_mutex> lock(lock_);
+  FreeLocked(p);
+}
+
+void BFCArena::FreeLocked(void* p) {
   auto it = reserved_chunks_.find(p);
   if (it != reserved_chunks_.end()) {
     device_allocator_->Free(it->first);
@@ -509,7 +652,12 @@ void BFCArena::Free(void* p) {
 }
 
 Status BFCArena::Shrink() {
-  std::lock_guard<std::mutex> lock(lock_);
+  ThreadCache* thread_cache = thread_cache_owner_ ? &GetThreadCache() : nullptr;
+  std::lock_guard<std::shared_mutex> lock(lock_);
+  if (thread_cache != nullptr) {
+    FlushThreadCacheLocked(*thread_cache, true);
+  }
+
   auto num_regions = region_manager_.regions().size();
   std::vector<void*> region_ptrs;
   std::vector<size_t> region_sizes;
@@ -807,7 +955,7 @@ void BFCArena::DumpMemoryLog(size_t num_bytes) {
 }
 #ifdef ORT_ENABLE_STREAM
 void BFCArena::ResetChunkOnTargetStream(Stream* target_stream, bool coalesce_flag) {
-  std::lock_guard<std::mutex> lock(lock_);
+  std::lock_guard<std::shared_mutex> lock(lock_);
 
   for (const auto& region : region_manager_.regions()) {
     ChunkHandle region_begin_chunk = region_manager_.get_handle(region.ptr());
@@ -16,9 +16,12 @@ limitations under the License.
 
 #pragma once
 #include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <vector>
 
 #include "onnxruntime_config.h"
 
@@ -60,11 +63,13 @@ class BFCArena : public IAllocator {
   static const int DEFAULT_MAX_DEAD_BYTES_PER_CHUNK = 128 * 1024 * 1024;
   static const int DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES = 2 * 1024 * 1024;
   static const int64_t DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES = 1024 * 1024 * 1024;  // 1GB
+  static const int64_t DEFAULT_MAX_THREAD_CACHE_BYTES = 0;                          // disabled
   static const size_t DEFAULT_MAX_MEM = std::numeric_limits<size_t>::max();
 
   enum ArenaType {
     BaseArena,
     StreamAwareArena,
+    SlabArena,
   };
 
   BFCArena(std::unique_ptr<IAllocator> resource_allocator,
@@ -73,7 +78,8 @@ class BFCArena : public IAllocator {
            int initial_chunk_size_bytes = DEFAULT_INITIAL_CHUNK_SIZE_BYTES,
            int max_dead_bytes_per_chunk = DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
            int initial_growth_chunk_size_bytes = DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES,
-           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES);
+           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+           int64_t max_thread_cache_bytes = DEFAULT_MAX_THREAD_CACHE_BYTES);
 
   ~BFCArena() override;
 
@@ -83,10 +89,14 @@ class BFCArena : public IAllocator {
   void* Alloc(size_t size) override;
 
   // If p is NULL, no operation is performed.
+  // When the thread cache is enabled and p is a small chunk, it is returned to the arena in a batch with later frees
+  // of this thread.
   void Free(void* p) override;
 
   // Frees all allocation regions in which no chunk is in use.
   // Does not free any reserved chunks.
+  // Chunks in the thread cache of the calling thread are returned to the arena first. Chunks in the thread caches of
+  // other threads are still in use, so the regions that contain them are not freed.
   // Resets the size that the arena will grow by in the next allocation to
   // `initial_growth_chunk_size_bytes_` but ultimately all
   // future allocation sizes are determined by the arena growth strategy
@@ -95,6 +105,8 @@ class BFCArena : public IAllocator {
 
   void* Reserve(size_t size) override;
 
+  // Pending frees of the calling thread are returned to the arena first. Only that thread's cache is flushed: chunks in
+  // the free lists of all thread caches are not counted in bytes_in_use, but pending frees of other threads still are.
   void GetStats(AllocatorStats* stats) override;
 
   size_t RequestedSize(const void* ptr);
@@ -123,6 +135,9 @@ class BFCArena : public IAllocator {
  private:
   void DeallocateRawInternal(void* ptr);
 
+  // Free a reserved chunk or a chunk of the bins. Caller shall hold lock_.
+  void FreeLocked(void* ptr);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   using ChunkHandle = size_t;
@@ -417,6 +432,41 @@ class BFCArena : public IAllocator {
 
   Chunk* ChunkFromHandle(ChunkHandle h);
 
+  // Small chunks up to kThreadCacheMaxChunkSize bytes are cached per thread when max_thread_cache_bytes is positive,
+  // so that concurrent Run calls sharing the arena don't serialize on lock_ for every tensor.
+  // Frees of small chunks by a thread are collected with only a shared lock (to read the chunk size) and returned to
+  // the arena kThreadCachePendingFrees at a time. Larger chunks are freed at once.
+  // While holding the lock for that, small freed chunks are moved to free lists of the thread by size (up to
+  // max_thread_cache_bytes per thread) instead of the bins, and later allocations of the same rounded size take them
+  // from there without the lock. Chunks in a thread cache stay in use from the point of view of the bins.
+  static const size_t kThreadCacheMaxChunkSize = 4096;
+  static const size_t kThreadCacheNumSizes = kThreadCacheMaxChunkSize / kMinAllocationSize;
+  static const size_t kThreadCachePendingFrees = 32;
+
+  // Shared by the arena and its thread caches, so that a thread cache destroyed at thread exit knows whether the
+  // arena is still alive.
+  struct ThreadCacheOwner {
+    std::mutex mutex;
+    BFCArena* arena = nullptr;
+  };
+
+  struct ThreadCache {
+    ~ThreadCache();
+
+    std::shared_ptr<ThreadCacheOwner> owner;
+    // free_lists[i] holds chunks of (i + 1) * kMinAllocationSize bytes.
+    std::array<std::vector<void*>, kThreadCacheNumSizes> free_lists;
+    size_t cached_bytes = 0;
+    std::vector<void*> pending_frees;
+  };
+
+  // Returns the cache of the calling thread for this arena. Requires thread_cache_owner_.
+  ThreadCache& GetThreadCache();
+
+  // Free the pending frees of the cache, keeping small chunks in the cache as the budget allows.
+  // All cached chunks are returned to the bins too if release_cached_chunks is true. Caller shall hold lock_.
+  void FlushThreadCacheLocked(ThreadCache& cache, bool release_cached_chunks);
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -489,7 +539,8 @@ class BFCArena : public IAllocator {
 
   std::unique_ptr<IAllocator> device_allocator_;
 
-  mutable std::mutex lock_;
+  // Exclusive for any change of the arena. Free reads the size of the chunk under a shared lock.
+  mutable std::shared_mutex lock_;
 
   RegionManager region_manager_;
   std::vector<Chunk> chunks_;
@@ -508,6 +559,13 @@ class BFCArena : public IAllocator {
   const int max_dead_bytes_per_chunk_;
   const int initial_growth_chunk_size_bytes_;
   const int64_t max_power_of_two_extend_bytes_;
+  const int64_t max_thread_cache_bytes_;
+
+  // Set when the thread caches are enabled.
+  std::shared_ptr<ThreadCacheOwner> thread_cache_owner_;
+  // Bytes of the chunks held by the thread caches, and allocations served by them, to correct the stats of the bins.
+  std::atomic<int64_t> thread_cached_bytes_{0};
+  std::atomic<int64_t> thread_cache_num_allocs_{0};
 
   // This flag is only relevant if Shrink() is invoked.
   // This is a boolean flag that controls whether the first allocation region
@@ -406,7 +406,12 @@ ExecutionFrame::ExecutionFrame(gsl::span<const int> feed_mlvalue_idxs, gsl::span
 
     // if there are some traditional ml value type in inputs disable the memory pattern optimization.
     if (all_tensors) {
-      mem_patterns_ = session_state.GetMemoryPatternGroup(feeds, feed_mlvalue_idxs, inferred_shapes_);
+      if (session_state.GetMemoryPatternShapeBucketing()) {
+        bucketed_mem_patterns_ = session_state.GetBucketedMemoryPatternGroup(feeds, planned_sizes_);
+        mem_patterns_ = bucketed_mem_patterns_.get();
+      } else {
+        mem_patterns_ = session_state.GetMemoryPatternGroup(feeds, feed_mlvalue_idxs, inferred_shapes_);
+      }
       // if no existing patterns, generate one in this execution frame
       if (!mem_patterns_) {
         planner_.emplace(*session_state.GetExecutionPlan());
@@ -551,8 +556,9 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
       if (block) {
         auto it = buffers_.find(location);
         if (it != buffers_.end()) {
-          // if the block is not correct, log message then fall back to default behavior
-          if (block->size_ == size) {
+          // if the block is not correct, log message then fall back to default behavior.
+          // blocks of a bucketed pattern are planned with the largest size in the bucket, so smaller values fit too.
+          if (block->size_ == size || (bucketed_mem_patterns_ && size < block->size_)) {
             void* buffer = it->second.get();
             auto status = AllocateTensorWithPreAllocateBufferHelper(
                 ort_value, static_cast<void*>(static_cast<char*>(buffer) + block->offset_), element_type, location,
@@ -567,6 +573,9 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
                                                    << ", block in memory pattern size is: " << block->size_
                                                    << " but the actual size is: " << size
                                                    << ", fall back to default allocation behavior";
+            if (bucketed_mem_patterns_ && size > block->size_) {
+              outgrown_sizes_[ort_value_index] = size;
+            }
           }
         }
         // else { we couldn't allocate the large block for the buffer so we didn't insert an entry }
@@ -901,6 +910,11 @@ void ExecutionFrame::TraceAllocate(int ort_value_idx, size_t size) {
         allocation_plan.alloc_kind == AllocKind::kAllocatedExternally) {
       return;
     }
+    // plan with the largest size seen in the shape bucket, so that the pattern fits other runs of the bucket.
+    auto planned_size = planned_sizes_.find(ort_value_idx);
+    if (planned_size != planned_sizes_.end()) {
+      size = std::max(size, planned_size->second);
+    }
     auto status = planner_->TraceAllocation(ort_value_idx, size);
     if (!status.IsOK()) {
       LOGS(session_state_.Logger(), WARNING) << "TraceAllocation for ort_value_idx=" << ort_value_idx
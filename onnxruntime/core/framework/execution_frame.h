@@ -168,6 +168,11 @@ class ExecutionFrame final : public IExecutionFrame {
     return planner_.has_value();
   }
 
+  // Sizes of values that did not fit into their blocks of the bucketed memory pattern used by this frame.
+  const InlinedHashMap<int, size_t>& GetOutgrownMemoryPatternSizes() const {
+    return outgrown_sizes_;
+  }
+
 #if !defined(ORT_MINIMAL_BUILD)
   std::optional<size_t> GetOrtValueDynamicAllocation(int ort_value_index) const {
     auto it = ort_value_to_dynamic_allocations_size_.find(ort_value_index);
@@ -245,6 +250,15 @@ class ExecutionFrame final : public IExecutionFrame {
   // kernel's input/output tensors.
   const MemoryPatternGroup* mem_patterns_;
 
+  // Holds mem_patterns_ if it is the pattern of a shape bucket, which may be replaced in the session state.
+  std::shared_ptr<const MemoryPatternGroup> bucketed_mem_patterns_;
+
+  // Sizes to plan the pattern of the shape bucket with when tracing.
+  InlinedHashMap<int, size_t> planned_sizes_;
+
+  // Sizes of values larger than their blocks of the bucketed pattern.
+  InlinedHashMap<int, size_t> outgrown_sizes_;
+
   // If no cached memory pattern, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
   std::optional<OrtValuePatternPlanner> planner_;
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/numa_allocator.h"
+
+#include "core/common/logging/logging.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+NumaCPUAllocator::NumaCPUAllocator(int numa_node)
+    : IAllocator(OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator)),
+      numa_node_(numa_node),
+      use_numa_placement_(Env::Default().IsNumaAllocationSupported()) {
+  if (!use_numa_placement_) {
+    LOGS_DEFAULT(WARNING) << "NUMA placement of memory is not supported on this platform, memory for NUMA node "
+                          << numa_node << " is allocated by the CPU allocator";
+  }
+}
+
+void* NumaCPUAllocator::Alloc(size_t size) {
+  if (!use_numa_placement_) {
+    return cpu_allocator_.Alloc(size);
+  }
+  if (size == 0) return nullptr;
+  // the memory is page aligned, which satisfies the alignment of CPUAllocator
+  void* p = Env::Default().AllocateOnNumaNode(size + MLAS_SYMM_QGEMM_BUF_OVERRUN, numa_node_);
+  if (p == nullptr) {
+    ORT_THROW_EX(std::bad_alloc);
+  }
+  return p;
+}
+
+void NumaCPUAllocator::Free(void* p) {
+  if (!use_numa_placement_) {
+    cpu_allocator_.Free(p);
+  } else if (p != nullptr) {
+    Env::Default().FreeOnNumaNode(p);
+  }
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/framework/allocator.h"
+
+namespace onnxruntime {
+
+// CPU allocator that places its memory on a NUMA node (see Env::AllocateOnNumaNode).
+//
+// Each allocation is a mapping of whole pages plus one for bookkeeping, so it is meant to back an arena that allocates
+// large regions, not to serve small tensors directly. It has the same OrtMemoryInfo as CPUAllocator and can be used in its place.
+// When the platform doesn't support NUMA placement (see Env::IsNumaAllocationSupported), it logs a warning and
+// allocates like CPUAllocator.
+class NumaCPUAllocator : public IAllocator {
+ public:
+  explicit NumaCPUAllocator(int numa_node);
+
+  void* Alloc(size_t size) override;
+  void Free(void* p) override;
+
+  int NumaNode() const { return numa_node_; }
+
+ private:
+  const int numa_node_;
+  const bool use_numa_placement_;
+  CPUAllocator cpu_allocator_;
+};
+
+}  // namespace onnxruntime
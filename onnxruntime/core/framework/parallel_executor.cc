@@ -0,0 +1,327 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/parallel_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include "core/common/path_string.h"
+#include "core/framework/sequential_executor.h"
+#include "core/framework/stream_execution_context.h"
+#include "core/graph/graph_viewer.h"
+#include "core/platform/threadpool.h"
+
+#include "nlohmann/json.hpp"
+using json = nlohmann::json;
+
+namespace onnxruntime {
+
+namespace {
+constexpr const char* kKernelTimeSuffix = "_kernel_time";
+
+std::string NodeCostKey(const Node& node) {
+  // Same as the node name in the profiling events of KernelScope.
+  return node.Name().empty() ? MakeString(node.OpType(), "_", node.Index()) : node.Name();
+}
+}  // namespace
+
+ParallelExecutionSchedule::ParallelExecutionSchedule(const GraphViewer& graph_viewer,
+                                                     gsl::span<const NodeIndex> nodes,
+                                                     const InlinedHashMap<std::string, double>& node_costs)
+    : num_nodes_(nodes.size()) {
+  const size_t max_node_index = graph_viewer.MaxNodeIndex();
+  consumers_.resize(max_node_index);
+  num_producers_.resize(max_node_index, 0);
+  priorities_.resize(max_node_index, 0.0);
+
+  std::vector<bool> in_schedule(max_node_index, false);
+  for (NodeIndex node_index : nodes) {
+    in_schedule[node_index] = true;
+  }
+
+  std::vector<double> costs(max_node_index, 0.0);
+  double total_known_cost = 0.0;
+  size_t num_known_costs = 0;
+  for (NodeIndex node_index : nodes) {
+    auto it = node_costs.find(NodeCostKey(*graph_viewer.GetNode(node_index)));
+    if (it != node_costs.end()) {
+      costs[node_index] = it->second;
+      total_known_cost += it->second;
+      num_known_costs++;
+    } else {
+      costs[node_index] = -1.0;
+    }
+  }
+  const double default_cost = num_known_costs > 0 ? total_known_cost / num_known_costs : 1.0;
+
+  for (NodeIndex node_index : nodes) {
+    const Node* node = graph_viewer.GetNode(node_index);
+    auto& consumers = consumers_[node_index];
+    for (auto it = node->OutputNodesBegin(), end = node->OutputNodesEnd(); it != end; ++it) {
+      const NodeIndex consumer = it->Index();
+      if (consumer < max_node_index && in_schedule[consumer] &&
+          std::find(consumers.begin(), consumers.end(), consumer) == consumers.end()) {
+        consumers.push_back(consumer);
+        num_producers_[consumer]++;
+      }
+    }
+  }
+
+  // Consumers come after their producers in topological order, so the critical paths are computed in reverse order.
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    const NodeIndex node_index = *it;
+    double longest_consumer_path = 0.0;
+    for (NodeIndex consumer : consumers_[node_index]) {
+      longest_consumer_path = std::max(longest_consumer_path, priorities_[consumer]);
+    }
+    priorities_[node_index] = (costs[node_index] < 0.0 ? default_cost : costs[node_index]) + longest_consumer_path;
+  }
+
+  for (NodeIndex node_index : nodes) {
+    if (num_producers_[node_index] == 0) {
+      root_nodes_.push_back(node_index);
+    }
+  }
+  std::stable_sort(root_nodes_.begin(), root_nodes_.end(), [this](NodeIndex a, NodeIndex b) {
+    return priorities_[a] > priorities_[b];
+  });
+}
+
+Status ParallelExecutionSchedule::LoadNodeCosts(const PathString& profile_file,
+                                                InlinedHashMap<std::string, double>& node_costs) {
+  std::ifstream file(profile_file);
+  ORT_RETURN_IF_NOT(file.is_open(), "Failed to open profiling file ", PathToUTF8String(profile_file));
+
+  json events = json::parse(file, nullptr, /*allow_exceptions*/ false);
+  ORT_RETURN_IF(events.is_discarded() || !events.is_array(),
+                "Invalid profiling file ", PathToUTF8String(profile_file), ". An array of events is expected.");
+
+  InlinedHashMap<std::string, std::pair<double, size_t>> total_durations;
+  for (const auto& event : events) {
+    auto cat = event.find("cat");
+    auto name = event.find("name");
+    auto dur = event.find("dur");
+    if (cat == event.end() || name == event.end() || dur == event.end() ||
+        !cat->is_string() || !name->is_string() || !dur->is_number() || cat->get<std::string>() != "Node") {
+      continue;
+    }
+
+    const std::string& event_name = name->get_ref<const std::string&>();
+    const size_t suffix_length = strlen(kKernelTimeSuffix);
+    if (event_name.size() <= suffix_length ||
+        event_name.compare(event_name.size() - suffix_length, suffix_length, kKernelTimeSuffix) != 0) {
+      continue;
+    }
+
+    auto& total = total_durations[event_name.substr(0, event_name.size() - suffix_length)];
+    total.first += dur->get<double>();
+    total.second++;
+  }
+
+  node_costs.clear();
+  node_costs.reserve(total_durations.size());
+  for (const auto& entry : total_durations) {
+    node_costs[entry.first] = entry.second.first / entry.second.second;
+  }
+
+  return Status::OK();
+}
+
+namespace {
+
+class ParallelNodeRunner {
+ public:
+  ParallelNodeRunner(StreamExecutionContext& ctx,
+                     const ParallelExecutionSchedule& schedule,
+                     SessionScope& session_scope,
+                     const bool& terminate_flag,
+                     concurrency::ThreadPool* tp)
+      : ctx_(ctx),
+        schedule_(schedule),
+        session_scope_(session_scope),
+        terminate_flag_(terminate_flag),
+        tp_(tp),
+        // Schedule() runs the work inline without a thread pool, so only the calling thread works then.
+        max_workers_(tp ? static_cast<size_t>(concurrency::ThreadPool::DegreeOfParallelism(tp)) : 1) {
+    const size_t num_node_indices = ctx.GetSessionState().GetGraphViewer().MaxNodeIndex();
+    pending_producers_ = std::make_unique<std::atomic_int[]>(num_node_indices);
+    for (size_t i = 0; i < num_node_indices; ++i) {
+      pending_producers_[i].store(schedule.NumProducers(i), std::memory_order_relaxed);
+    }
+
+    auto roots = schedule.RootNodes();
+    ready_nodes_.assign(roots.begin(), roots.end());
+    std::make_heap(ready_nodes_.begin(), ready_nodes_.end(), CompareReadyNodes{schedule_});
+  }
+
+  Status Run() {
+    size_t num_new_workers = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      num_workers_ = 1;
+      num_searching_workers_ = 1;
+      num_new_workers = AddWorkersLocked();
+    }
+    StartWorkers(num_new_workers);
+
+    Work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return num_workers_ == 0; });
+    return status_;
+  }
+
+ private:
+  // Orders the heap of ready nodes so that the node with the longest critical path is on top.
+  struct CompareReadyNodes {
+    const ParallelExecutionSchedule& schedule;
+    bool operator()(NodeIndex a, NodeIndex b) const {
+      return schedule.Priority(a) < schedule.Priority(b);
+    }
+  };
+
+  // Count new workers for the ready nodes that no worker is going to take, and return the number of them.
+  // Caller shall hold mutex_, and start them with StartWorkers() after releasing it.
+  size_t AddWorkersLocked() {
+    size_t num_new_workers = 0;
+    while (num_workers_ < max_workers_ && num_searching_workers_ < ready_nodes_.size()) {
+      ++num_workers_;
+      ++num_searching_workers_;
+      ++num_new_workers;
+    }
+    return num_new_workers;
+  }
+
+  void StartWorkers(size_t num_new_workers) {
+    // Schedule() may run the work inline when the queue of the thread pool is full, so mutex_ must not be held.
+    for (size_t i = 0; i < num_new_workers; ++i) {
+      concurrency::ThreadPool::Schedule(tp_, [this]() { Work(); });
+    }
+  }
+
+  void Work() {
+    NodeIndex node_index = 0;
+    bool has_node = false;
+    // a worker counts as searching from when it is added until it takes its first node.
+    bool searching = true;
+    InlinedVector<NodeIndex> ready_consumers;
+
+    while (true) {
+      if (!has_node) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (searching) {
+          --num_searching_workers_;
+          searching = false;
+        }
+        if (ready_nodes_.empty() || failed_) {
+          if (--num_workers_ == 0) {
+            cv_.notify_all();
+          }
+          return;
+        }
+        std::pop_heap(ready_nodes_.begin(), ready_nodes_.end(), CompareReadyNodes{schedule_});
+        node_index = ready_nodes_.back();
+        ready_nodes_.pop_back();
+      }
+
+      Status status = RunNode(node_index);
+      if (!status.IsOK()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (status_.IsOK()) {
+          status_ = status;
+        }
+        failed_ = true;
+        has_node = false;
+        continue;
+      }
+
+      ready_consumers.clear();
+      for (NodeIndex consumer : schedule_.Consumers(node_index)) {
+        if (pending_producers_[consumer].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          ready_consumers.push_back(consumer);
+        }
+      }
+
+      has_node = !ready_consumers.empty();
+      if (has_node) {
+        // continue with the most critical consumer, which likely reads the output that is still in cache.
+        auto best = std::max_element(ready_consumers.begin(), ready_consumers.end(), CompareReadyNodes{schedule_});
+        node_index = *best;
+        ready_consumers.erase(best);
+        if (!ready_consumers.empty()) {
+          size_t num_new_workers = 0;
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (NodeIndex consumer : ready_consumers) {
+              ready_nodes_.push_back(consumer);
+              std::push_heap(ready_nodes_.begin(), ready_nodes_.end(), CompareReadyNodes{schedule_});
+            }
+            num_new_workers = AddWorkersLocked();
+          }
+          StartWorkers(num_new_workers);
+        }
+      }
+    }
+  }
+
+  Status RunNode(NodeIndex node_index) {
+    if (terminate_flag_) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+    }
+#ifdef ENABLE_TRAINING
+    // legacy code required by ORTTrainer, same as LaunchKernelStep.
+    auto* node_to_execute = ctx_.GetNodeToExecute();
+    if (node_to_execute && node_to_execute->count(node_index) == 0) {
+      return Status::OK();
+    }
+#endif
+    Status status;
+    ORT_TRY {
+      status = ExecuteKernel(ctx_, node_index, 0, terminate_flag_, session_scope_);
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+      });
+    }
+    return status;
+  }
+
+  StreamExecutionContext& ctx_;
+  const ParallelExecutionSchedule& schedule_;
+  SessionScope& session_scope_;
+  const bool& terminate_flag_;
+  concurrency::ThreadPool* const tp_;
+  const size_t max_workers_;
+
+  std::unique_ptr<std::atomic_int[]> pending_producers_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // heap of nodes whose producers have completed, guarded by mutex_.
+  std::vector<NodeIndex> ready_nodes_;
+  // workers that have not exited, including those scheduled to the thread pool that have not started yet.
+  size_t num_workers_ = 0;
+  // workers that are going to take a node from ready_nodes_ but have not yet.
+  size_t num_searching_workers_ = 0;
+  bool failed_ = false;
+  Status status_;
+};
+
+}  // namespace
+
+Status ExecuteNodesInParallel(StreamExecutionContext& ctx,
+                              const ParallelExecutionSchedule& schedule,
+                              SessionScope& session_scope,
+                              const bool& terminate_flag,
+                              concurrency::ThreadPool* inter_op_thread_pool) {
+  ParallelNodeRunner runner(ctx, schedule, session_scope, terminate_flag, inter_op_thread_pool);
+  return runner.Run();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <gsl/gsl>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/path_string.h"
+#include "core/common/status.h"
+#include "core/graph/basic_types.h"
+
+namespace onnxruntime {
+
+class GraphViewer;
+class SessionScope;
+class StreamExecutionContext;
+
+namespace concurrency {
+class ThreadPool;
+}
+
+// Node level schedule of a graph for ExecutionMode::ORT_PARALLEL.
+//
+// The nodes of a graph are executed as soon as their producers complete, and the ready node with the longest
+// critical path (the largest cost of any path from it to a graph output) runs first, so that long chains start early
+// and short branches fill the gaps. Node costs come from the profiling output of prior runs (see
+// kOrtSessionOptionsParallelExecutorNodeCostsFile). Nodes without cost get the average cost of the others, or unit cost
+// when there is no profile, in which case the critical path is the longest chain of nodes.
+class ParallelExecutionSchedule {
+ public:
+  // nodes shall be in topological order.
+  ParallelExecutionSchedule(const GraphViewer& graph_viewer,
+                            gsl::span<const NodeIndex> nodes,
+                            const InlinedHashMap<std::string, double>& node_costs);
+
+  // Read the average kernel time in microseconds of each node from a profiling output file of
+  // SessionOptions::enable_profiling. The key is the node name, or "<op type>_<node index>" for nodes without name.
+  static Status LoadNodeCosts(const PathString& profile_file, InlinedHashMap<std::string, double>& node_costs);
+
+  // Nodes that have no producers in the graph, by decreasing priority.
+  gsl::span<const NodeIndex> RootNodes() const { return root_nodes_; }
+
+  // Nodes that consume an output of the node. Each consumer appears once.
+  gsl::span<const NodeIndex> Consumers(NodeIndex node_index) const { return consumers_[node_index]; }
+
+  // Number of distinct nodes that produce the inputs of the node.
+  int NumProducers(NodeIndex node_index) const { return num_producers_[node_index]; }
+
+  // Length of the critical path from the node to a graph output, including the node.
+  double Priority(NodeIndex node_index) const { return priorities_[node_index]; }
+
+  size_t NumNodes() const { return num_nodes_; }
+
+ private:
+  size_t num_nodes_;
+  std::vector<NodeIndex> root_nodes_;
+  std::vector<InlinedVector<NodeIndex>> consumers_;
+  std::vector<int> num_producers_;
+  std::vector<double> priorities_;
+};
+
+// Execute the nodes of the schedule using the inter-op thread pool.
+//
+// Workers take the ready node with the highest priority from a shared ready queue. A worker that completes a node
+// continues with the best of the consumers that became ready, and hands the rest to the queue, where idle workers or
+// new ones pick them up. At most DegreeOfParallelism(inter_op_thread_pool) workers (the calling thread included) run
+// at a time, so the kernels never run on more threads than the inter-op pool has, and their intra-op parallel sections
+// share the intra-op pool. ctx shall be created for a single logic stream holding all the nodes.
+Status ExecuteNodesInParallel(StreamExecutionContext& ctx,
+                              const ParallelExecutionSchedule& schedule,
+                              SessionScope& session_scope,
+                              const bool& terminate_flag,
+                              concurrency::ThreadPool* inter_op_thread_pool);
+
+}  // namespace onnxruntime
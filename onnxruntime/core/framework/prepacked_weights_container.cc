@@ -2,8 +2,14 @@
 // Licensed under the MIT License.
 
 #include "core/framework/prepacked_weights_container.h"
+
+#include <cstring>
+
 #include "core/framework/allocator_utils.h"
+#include "core/framework/numa_allocator.h"
 #include "core/graph/graph.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/env.h"
 
 namespace onnxruntime {
 
@@ -57,10 +63,75 @@ bool PrepackedWeightsContainer::HasWeight(const std::string& key) const {
          prepacked_weights_map_.end();
 }
 
+const PrePackedWeights& PrepackedWeightsContainer::GetOrCreateNumaReplica(const std::string& key, int numa_node) {
+  const auto& prepacked_weight = GetWeight(key);
+  // A replica in memory that is not placed on the node would only double the memory.
+  if (numa_node < 0 || !Env::Default().IsNumaAllocationSupported()) {
+    return prepacked_weight;
+  }
+
+  auto& replicas = numa_replicas_[numa_node];
+  auto iter = replicas.find(key);
+  if (iter != replicas.end()) {
+    return iter->second;
+  }
+
+  auto& allocator = numa_allocators_[numa_node];
+  if (allocator == nullptr) {
+    // The replicas live as long as the container, so there is no point in an arena.
+    allocator = std::make_shared<NumaCPUAllocator>(numa_node);
+  }
+
+  // The pre-packed buffers are plain data, so the bytes can be copied. The pages are placed on the node
+  // when they are first written here. The allocator maps whole pages, so the buffers of the key share one allocation,
+  // which is owned by the first buffer.
+  const size_t alignment = MlasGetPreferredBufferAlignment();
+  std::vector<size_t> offsets;
+  size_t total_size = 0;
+  for (size_t buffer_size : prepacked_weight.buffer_sizes_) {
+    offsets.push_back(total_size);
+    total_size += (buffer_size + alignment - 1) / alignment * alignment;
+  }
+
+  IAllocatorUniquePtr<void> block;
+  if (total_size > 0) {
+    block = IAllocator::MakeUniquePtr<void>(allocator, total_size);
+  }
+  char* block_data = static_cast<char*>(block.get());
+
+  PrePackedWeights replica;
+  for (size_t i = 0; i < prepacked_weight.buffers_.size(); ++i) {
+    const size_t buffer_size = prepacked_weight.buffer_sizes_[i];
+    const void* buffer = prepacked_weight.buffers_[i].get();
+    if (buffer == nullptr || buffer_size == 0) {
+      replica.buffers_.emplace_back(nullptr, [](void*) {});
+    } else {
+      void* replica_buffer = block_data + offsets[i];
+      memcpy(replica_buffer, buffer, buffer_size);
+      if (block != nullptr) {
+        replica.buffers_.push_back(std::move(block));
+      } else {
+        replica.buffers_.emplace_back(replica_buffer, [](void*) {});
+      }
+    }
+    replica.buffer_sizes_.push_back(buffer_size);
+  }
+
+  return replicas.emplace(key, std::move(replica)).first->second;
+}
+
 size_t PrepackedWeightsContainer::GetNumberOfElements() const {
   return prepacked_weights_map_.size();
 }
 
+size_t PrepackedWeightsContainer::GetNumberOfNumaReplicas() const {
+  size_t result = 0;
+  for (const auto& [_, replicas] : numa_replicas_) {
+    result += replicas.size();
+  }
+  return result;
+}
+
 void PrepackedWeightsForGraph::InsertPrepackedWeights(const std::string& key, PrePackedWeights&& packed_weight) {
   // We may have duplicate entries mapped from disk if the same weight is pre-packed from subgraphs and
   // up the tree by the same kernel with the same result. The map prevents this from happening.
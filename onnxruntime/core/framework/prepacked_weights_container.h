@@ -51,9 +51,19 @@ class PrepackedWeightsContainer final {
   // The key is : op_type + "+" + hash_of_prepacked_buffers_in_the_PrepackedWeights_instance.
   bool HasWeight(const std::string& key) const;
 
+  // Returns the replica of the PrePackedWeights instance pertaining to the provided key whose buffers
+  // are placed on the given NUMA node, creating it from the instance written by WriteWeight() on first use.
+  // Kernels of a session pinned to a NUMA node use it so that their weight reads stay on the node.
+  // Returns the instance itself if numa_node is negative or NUMA placement of memory is not supported.
+  // Throws an exception if the key doesn't exist
+  const PrePackedWeights& GetOrCreateNumaReplica(const std::string& key, int numa_node);
+
   // Returns the number of elements in the container
   size_t GetNumberOfElements() const;
 
+  // Returns the number of NUMA replicas created by GetOrCreateNumaReplica()
+  size_t GetNumberOfNumaReplicas() const;
+
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PrepackedWeightsContainer);
 
   // Resource to be acquired by the method that is going to invoke calls to the kernels'
@@ -67,10 +77,16 @@ class PrepackedWeightsContainer final {
   // because the Tensor buffers will be de-allocated using these allocators
   std::unordered_map<std::string, AllocatorPtr> allocators_;
 
+  // Allocators placing the NUMA replicas on their node, keyed by NUMA node
+  std::unordered_map<int, AllocatorPtr> numa_allocators_;
+
   // This is an unordered map that holds a mapping between a composite key
   // to PrePackedWeights instances.
   // The key is : op_type + "+" + hash_of_prepacked_buffers_in_the_PrepackedWeights_instance.
   std::unordered_map<std::string, PrePackedWeights> prepacked_weights_map_;
+
+  // Replicas of the entries of prepacked_weights_map_ keyed by NUMA node and then by the key of the entry.
+  std::unordered_map<int, std::unordered_map<std::string, PrePackedWeights>> numa_replicas_;
 };
 
 // Maps a pre-packed weight blob key to PrepackedWeights instance
@@ -15,6 +15,7 @@
 #include "core/framework/stream_execution_context.h"
 #include "core/framework/session_state.h"
 #include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/parallel_executor.h"
 #include "core/framework/utils.h"
 
 #if defined DEBUG_NODE_INPUTS_OUTPUTS
@@ -451,7 +452,8 @@ onnxruntime::Status ExecuteKernel(StreamExecutionContext& ctx,
                                      *p_kernel,
                                      ctx.GetLogger(),
                                      terminate_flag,
-                                     ctx.GetDeviceStream(stream_idx));
+                                     ctx.GetDeviceStream(stream_idx),
+                                     ctx.GetIntraOpThreadPool());
   onnxruntime::Status status;
   auto& logger = ctx.GetLogger();
   if (p_kernel->IsAsync()) {
@@ -588,7 +590,8 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
 #endif
                                    const bool& terminate_flag,
                                    const bool only_execute_path_to_fetches,
-                                   bool single_thread_mode) {
+                                   bool single_thread_mode,
+                                   bool use_intra_op_thread_pool) {
   auto* execution_plan = session_state.GetExecutionPlan();
   VLOGS(logger, 0) << "Number of streams: " << execution_plan->execution_plan.size();
   int32_t valid_streams = 0;
@@ -622,6 +625,9 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
                              logger,
                              single_thread_mode);
 #endif
+  if (!use_intra_op_thread_pool) {
+    ctx.SetIntraOpThreadPool(nullptr);
+  }
 #ifdef ENABLE_TRAINING
   if (only_execute_path_to_fetches) {
     auto* node_to_execute = session_state.GetToBeExecutedRange(fetch_mlvalue_idxs);
@@ -634,24 +640,33 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
   SessionScope session_scope(session_state, ctx.GetExecutionFrame());
 
   auto* tp = single_thread_mode ? nullptr : session_state.GetInterOpThreadPool();
+  const auto* parallel_schedule = session_state.GetParallelExecutionSchedule();
 
-  for (size_t i = 0; i < execution_plan->execution_plan.size(); ++i) {
-    if (execution_plan->execution_plan[i]->steps_.empty()) {
-      // execution context is initialized with number of valid streams
-      // for invalid stream (0 steps), it doesn't count in number of tasks
-      // so don't need to invoke CompleteTask here
-      // ctx.CompleteTask();
-    } else {
-      concurrency::ThreadPool::Schedule(tp, [i, &ctx, &terminate_flag, &session_scope]() {
-        RunSince(i, ctx, session_scope, terminate_flag, 0);
-      });
+  if (tp && parallel_schedule && valid_streams == 1) {
+    // run the nodes of the single stream as they get ready instead of in the order of its steps.
+    Status status = ExecuteNodesInParallel(ctx, *parallel_schedule, session_scope, terminate_flag, tp);
+    ctx.SetStatus(status);
+    ctx.CompleteTask();
+  } else {
+    for (size_t i = 0; i < execution_plan->execution_plan.size(); ++i) {
+      if (execution_plan->execution_plan[i]->steps_.empty()) {
+        // execution context is initialized with number of valid streams
+        // for invalid stream (0 steps), it doesn't count in number of tasks
+        // so don't need to invoke CompleteTask here
+        // ctx.CompleteTask();
+      } else {
+        concurrency::ThreadPool::Schedule(tp, [i, &ctx, &terminate_flag, &session_scope]() {
+          RunSince(i, ctx, session_scope, terminate_flag, 0);
+        });
+      }
     }
   }
 
   ctx.WaitAll();
   ORT_RETURN_IF_ERROR(ctx.TaskStatus());
   ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GetOutputs(fetches));
-  if (ctx.GetExecutionFrame().HasMemoryPatternPlanner()) {
+  if (ctx.GetExecutionFrame().HasMemoryPatternPlanner() ||
+      !ctx.GetExecutionFrame().GetOutgrownMemoryPatternSizes().empty()) {
     bool all_tensors = true;
     for (const auto& feed : feeds) {
       if (!(feed.IsTensor())) {
@@ -662,8 +677,15 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
 
     if (all_tensors) {
       MemoryPatternGroup mem_patterns;
-      ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GeneratePatterns(mem_patterns));
-      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(feeds, std::move(mem_patterns)));
+      if (ctx.GetExecutionFrame().HasMemoryPatternPlanner()) {
+        ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GeneratePatterns(mem_patterns));
+      }
+      if (session_state.GetMemoryPatternShapeBucketing()) {
+        ORT_RETURN_IF_ERROR(session_state.UpdateBucketedMemoryPatternGroupCache(
+            feeds, std::move(mem_patterns), ctx.GetExecutionFrame().GetOutgrownMemoryPatternSizes()));
+      } else {
+        ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(feeds, std::move(mem_patterns)));
+      }
     }
   }
 
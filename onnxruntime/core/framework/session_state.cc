@@ -7,6 +7,7 @@
 
 #include <mutex>
 #include "core/common/logging/logging.h"
+#include "core/common/parse_string.h"
 #include "core/common/safeint.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/framework/allocator.h"
@@ -16,6 +17,7 @@
 #include "core/framework/prepacked_weights_container.h"
 #include "core/framework/session_state_utils.h"
 #include "core/framework/utils.h"
+#include "core/platform/env.h"
 #include "core/providers/cpu/controlflow/utils.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 
@@ -103,6 +105,8 @@ SessionState::SessionState(Graph& graph,
 {
   enable_mem_pattern_ = sess_options_.enable_mem_pattern &&
                         sess_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL;
+  mem_pattern_shape_bucketing_ =
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsMemoryPatternShapeBucketing, "0") == "1";
   if (parent_allocators) {
     allocators_ = parent_allocators;
   } else {
@@ -419,7 +423,21 @@ static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
 Status SessionState::PrepackConstantInitializedTensors(
     InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
     const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map) {
-  auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map](
+  // NUMA node whose replica of the shared pre-packed weights the kernels use, -1 for the single shared copy
+  int numa_replica_node = -1;
+  if (sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsNumaReplicatePrepackedWeights, "0") == "1" &&
+      !TryParseStringWithClassicLocale<int>(
+          sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsNumaNode, "-1"), numa_replica_node)) {
+    numa_replica_node = -1;
+  }
+  if (numa_replica_node >= 0 && Env::Default().GetNumaNodeThreadAffinities(numa_replica_node).empty()) {
+    LOGS(logger_, WARNING) << "NUMA node " << numa_replica_node
+                           << " is not available, using the shared copy of the pre-packed weights";
+    numa_replica_node = -1;
+  }
+
+  auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map,
+                                     numa_replica_node](
                                         bool should_cache_prepacked_weights_for_shared_initializers) -> Status {
     for (auto& node : GetGraphViewer().Nodes()) {
       if (sess_options_.IsLoadCancellationFlagSet()) {
@@ -497,9 +515,11 @@ Status SessionState::PrepackConstantInitializedTensors(
 
                       const auto& prepacked_shared = prepacked_weights_container_->GetWeight(
                           prepacked_weights_container_key);
-                      ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
-                                                                          prepacked_shared,
-                                                                          node.Name()));
+                      ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(
+                          *kernel, input_idx,
+                          prepacked_weights_container_->GetOrCreateNumaReplica(prepacked_weights_container_key,
+                                                                               numa_replica_node),
+                          node.Name()));
 
                       ++used_shared_pre_packed_weights_counter_;
 
@@ -538,8 +558,8 @@ Status SessionState::PrepackConstantInitializedTensors(
                             "Unable to write the provided PrePackedWeights instance into the container");
                       }
 
-                      const auto& shared_prepacked = prepacked_weights_container_->GetWeight(
-                          prepacked_weights_container_key);
+                      const auto& shared_prepacked = prepacked_weights_container_->GetOrCreateNumaReplica(
+                          prepacked_weights_container_key, numa_replica_node);
                       ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
                                                                           shared_prepacked,
                                                                           node.Name()));
@@ -642,6 +662,27 @@ CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs) {
   return key;
 }
 
+static int64_t
+CalculateMemoryPatternsBucketKey(const gsl::span<const OrtValue>& tensor_inputs) {
+  // Round each dim up to a power of two, so that shapes in the same bucket have the same key.
+  uint64_t key = 0;
+  auto hash_combine = [&key](uint64_t value) {
+    key ^= value + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+  };
+  for (const auto& input : tensor_inputs) {
+    const auto dims = input.Get<Tensor>().Shape().GetDims();
+    hash_combine(dims.size());
+    for (auto dim : dims) {
+      uint64_t bucket = 1;
+      while (bucket < static_cast<uint64_t>(dim)) {
+        bucket <<= 1;
+      }
+      hash_combine(dim <= 0 ? static_cast<uint64_t>(dim) : bucket);
+    }
+  }
+  return static_cast<int64_t>(key);
+}
+
 #ifdef ENABLE_TRAINING
 namespace {
 Status ResolveDimParams(const GraphViewer& graph,
@@ -966,6 +1007,61 @@ Status SessionState::UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> ten
   return Status::OK();
 }
 
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetBucketedMemoryPatternGroup(
+    gsl::span<const OrtValue> tensor_inputs,
+    InlinedHashMap<int, size_t>& planned_sizes) const {
+  int64_t key = CalculateMemoryPatternsBucketKey(tensor_inputs);
+
+  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
+  auto it = mem_pattern_buckets_.find(key);
+  if (it == mem_pattern_buckets_.end()) {
+    planned_sizes.clear();
+    return nullptr;
+  }
+
+  if (!it->second.patterns) {
+    planned_sizes = it->second.max_sizes;
+  }
+  return it->second.patterns;
+}
+
+Status SessionState::UpdateBucketedMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
+                                                           MemoryPatternGroup mem_patterns,
+                                                           const InlinedHashMap<int, size_t>& outgrown_sizes) const {
+  int64_t key = CalculateMemoryPatternsBucketKey(tensor_inputs);
+
+  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
+  auto& bucket = mem_pattern_buckets_[key];
+  for (const auto& [ort_value_idx, size] : outgrown_sizes) {
+    auto& max_size = bucket.max_sizes[ort_value_idx];
+    max_size = std::max(max_size, size);
+  }
+
+  if (!outgrown_sizes.empty()) {
+    bucket.patterns.reset();
+    return Status::OK();
+  }
+
+  // The traced pattern replaces the missing one only if all its blocks are as large as the largest sizes, which may
+  // have grown in runs of the bucket after this one started.
+  bool fits = true;
+  for (const auto& pattern : mem_patterns.patterns) {
+    for (const auto& [ort_value_idx, block] : pattern.GetPatternsMap()) {
+      auto& max_size = bucket.max_sizes[ort_value_idx];
+      if (block.size_ < max_size) {
+        fits = false;
+      } else {
+        max_size = block.size_;
+      }
+    }
+  }
+
+  if (fits && !bucket.patterns) {
+    bucket.patterns = std::make_shared<const MemoryPatternGroup>(std::move(mem_patterns));
+  }
+  return Status::OK();
+}
+
 bool SessionState::GetEnableMemoryPattern() const { return enable_mem_pattern_; }
 
 bool SessionState::GetEnableMemoryReuse() const { return sess_options_.enable_mem_reuse; }
@@ -1545,6 +1641,23 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
                                               p_seq_exec_plan_);
   ORT_RETURN_IF_ERROR(status);
 
+  // Subgraphs always run on the thread of their parent node, so only the main graph is scheduled per node.
+  // Streams of other devices synchronize by the order of their steps, so all nodes must be in a single CPU stream.
+  const auto& logic_streams = p_seq_exec_plan_->execution_plan;
+  if (session_options.execution_mode == ExecutionMode::ORT_PARALLEL && parent_node == nullptr &&
+      logic_streams.size() == 1 && logic_streams[0]->device_.Type() == OrtDevice::CPU &&
+      logic_streams[0]->steps_.size() == static_cast<size_t>(graph_viewer_->NumberOfNodes())) {
+    InlinedHashMap<std::string, double> node_costs;
+    const std::string node_costs_file =
+        session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsParallelExecutorNodeCostsFile, "");
+    if (!node_costs_file.empty()) {
+      ORT_RETURN_IF_ERROR(ParallelExecutionSchedule::LoadNodeCosts(ToPathString(node_costs_file), node_costs));
+    }
+
+    const auto& nodes = graph_viewer_->GetNodesInTopologicalOrder(session_options.execution_order);
+    parallel_execution_schedule_ = std::make_unique<ParallelExecutionSchedule>(*graph_viewer_, nodes, node_costs);
+  }
+
   if (session_options.IsLoadCancellationFlagSet()) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, MODEL_LOAD_CANCELED,
                            "SessionState finalize is canceled due to user request");
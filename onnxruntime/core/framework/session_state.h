@@ -33,6 +33,7 @@
 #include "core/framework/node_index_info.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/ort_value_name_idx_map.h"
+#include "core/framework/parallel_executor.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/onnx_protobuf.h"
 #include <mutex>
@@ -238,6 +239,33 @@ class SessionState {
   Status UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
                                        MemoryPatternGroup mem_patterns) const;
 
+  /**
+  Whether memory patterns are cached per shape bucket (kOrtSessionOptionsMemoryPatternShapeBucketing).
+  */
+  bool GetMemoryPatternShapeBucketing() const { return mem_pattern_shape_bucketing_; }
+
+  /**
+  Get the memory pattern of the shape bucket of the given inputs. Its blocks are at least as large as the largest size
+  seen for each value in runs of the bucket, so a block can be used by any value that is not larger.
+  Returns nullptr if the bucket has no pattern yet, and sets planned_sizes to the sizes that the pattern traced in this
+  run shall be planned with.
+  All inputs must represent Tensors
+  */
+  std::shared_ptr<const MemoryPatternGroup> GetBucketedMemoryPatternGroup(
+      gsl::span<const OrtValue> tensor_inputs,
+      InlinedHashMap<int, size_t>& planned_sizes) const;
+
+  /**
+  Update the memory pattern of the shape bucket of the given inputs.
+  mem_patterns is the pattern traced in a run without pattern, and is empty otherwise. outgrown_sizes are the sizes of
+  values that did not fit into their blocks of the pattern, in which case the pattern is dropped and planned again in
+  the next run of the bucket.
+  All inputs must represent Tensors
+  */
+  Status UpdateBucketedMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
+                                               MemoryPatternGroup mem_patterns,
+                                               const InlinedHashMap<int, size_t>& outgrown_sizes) const;
+
   bool GetUseDeterministicCompute() const { return sess_options_.use_deterministic_compute; }
 
   /**
@@ -295,6 +323,12 @@ class SessionState {
   concurrency::ThreadPool* GetThreadPool() const noexcept { return thread_pool_; }
   concurrency::ThreadPool* GetInterOpThreadPool() const noexcept { return inter_op_thread_pool_; }
 
+  // Node level schedule for ExecutionMode::ORT_PARALLEL.
+  // nullptr unless the session runs in parallel mode and all nodes of the main graph are in a single CPU stream.
+  const ParallelExecutionSchedule* GetParallelExecutionSchedule() const noexcept {
+    return parallel_execution_schedule_.get();
+  }
+
   const FuncManager& GetFuncMgr() const noexcept { return fused_funcs_mgr_; }
   FuncManager& GetMutableFuncMgr() noexcept { return fused_funcs_mgr_; }
 
@@ -512,6 +546,7 @@ class SessionState {
   InlinedHashMap<int, OrtCallback> deleter_for_initialized_tensors_;
   InlinedVector<BufferUniquePtr> weights_buffers_;
   std::optional<SequentialExecutionPlan> p_seq_exec_plan_;
+  std::unique_ptr<ParallelExecutionSchedule> parallel_execution_schedule_;
 
   const logging::Logger& logger_;
   profiling::Profiler& profiler_;
@@ -527,11 +562,24 @@ class SessionState {
   // switch for enable memory pattern optimization or not.
   bool enable_mem_pattern_;
 
+  // cache memory patterns per shape bucket instead of per exact input shapes.
+  bool mem_pattern_shape_bucketing_ = false;
+
   // lock for the mem_patterns_
   mutable std::mutex mem_patterns_lock_;
   // cache for the generated mem_patterns. key is calculated based on input shapes.
   // must be a node based container as a pointer is cached.
   mutable NodeHashMap<int64_t, MemoryPatternGroup> mem_patterns_;
+
+  struct MemoryPatternBucket {
+    // The largest size of each value seen in runs of the bucket.
+    InlinedHashMap<int, size_t> max_sizes;
+    // Pattern planned with max_sizes. nullptr until a run of the bucket traces it, and after a value outgrew its block.
+    // Execution frames hold the pattern they use, so it can be replaced while they run.
+    std::shared_ptr<const MemoryPatternGroup> patterns;
+  };
+  // cache for memory patterns per shape bucket. guarded by mem_patterns_lock_.
+  mutable InlinedHashMap<int64_t, MemoryPatternBucket> mem_pattern_buckets_;
   // This is mutable under mutex in training scenarios so execution frame would make a copy
   // of the value when created.
 #ifdef ENABLE_TRAINING
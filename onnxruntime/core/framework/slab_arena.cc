@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/slab_arena.h"
+
+namespace onnxruntime {
+
+SlabArena::SlabArena(std::unique_ptr<IAllocator> resource_allocator,
+                     size_t total_memory,
+                     ArenaExtendStrategy arena_extend_strategy,
+                     int initial_chunk_size_bytes,
+                     int max_dead_bytes_per_chunk,
+                     int initial_growth_chunk_size_bytes,
+                     int64_t max_power_of_two_extend_bytes)
+    : BFCArena(std::move(resource_allocator),
+               total_memory,
+               arena_extend_strategy,
+               initial_chunk_size_bytes,
+               max_dead_bytes_per_chunk,
+               initial_growth_chunk_size_bytes,
+               max_power_of_two_extend_bytes) {
+  static_assert(kMinBlockSize << (kNumSizeClasses - 1) == kMaxBlockSize, "size classes shall cover kMaxBlockSize");
+  static_assert(kMinBlockSize >= sizeof(FreeBlock), "a free block shall hold the free list link");
+  arena_type_ = ArenaType::SlabArena;
+}
+
+size_t SlabArena::SizeClassIndex(size_t size) {
+  size_t index = 0;
+  while (BlockSize(index) < size) {
+    ++index;
+  }
+  return index;
+}
+
+void SlabArena::AddSlab(size_t size_class_index) {
+  if (free_slabs_.empty()) {
+    // Allocate one more slab than needed so that the slabs can be aligned to kSlabSize.
+    void* group = BFCArena::Alloc((kSlabsPerGroup + 1) * kSlabSize);
+    const uintptr_t first_slab = (reinterpret_cast<uintptr_t>(group) + kSlabSize - 1) & ~(uintptr_t{kSlabSize} - 1);
+    for (size_t i = kSlabsPerGroup; i > 0; i--) {
+      free_slabs_.push_back(first_slab + (i - 1) * kSlabSize);
+    }
+    ++num_slab_groups_;
+    slab_group_bytes_ += static_cast<int64_t>(AllocatedSize(group));
+  }
+
+  const uintptr_t slab = free_slabs_.back();
+  free_slabs_.pop_back();
+  slab_size_classes_[slab] = size_class_index;
+
+  // Link the blocks so that they are handed out in address order.
+  SizeClass& size_class = size_classes_[size_class_index];
+  const size_t block_size = BlockSize(size_class_index);
+  for (size_t offset = kSlabSize; offset > 0; offset -= block_size) {
+    auto* block = reinterpret_cast<FreeBlock*>(slab + offset - block_size);
+    block->next = size_class.free_list;
+    size_class.free_list = block;
+  }
+}
+
+void* SlabArena::Alloc(size_t size) {
+  if (size == 0 || size > kMaxBlockSize) {
+    return BFCArena::Alloc(size);
+  }
+
+  const size_t size_class_index = SizeClassIndex(size);
+  std::lock_guard<std::mutex> lock(slab_lock_);
+  SizeClass& size_class = size_classes_[size_class_index];
+  if (size_class.free_list != nullptr) {
+    ++size_class.num_hits;
+  } else {
+    AddSlab(size_class_index);
+  }
+  ++size_class.num_allocs;
+
+  FreeBlock* block = size_class.free_list;
+  size_class.free_list = block->next;
+  slab_bytes_in_use_ += static_cast<int64_t>(BlockSize(size_class_index));
+  return block;
+}
+
+void SlabArena::Free(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+
+  const uintptr_t slab = reinterpret_cast<uintptr_t>(p) & ~(uintptr_t{kSlabSize} - 1);
+  {
+    std::lock_guard<std::mutex> lock(slab_lock_);
+    auto it = slab_size_classes_.find(slab);
+    if (it != slab_size_classes_.end()) {
+      SizeClass& size_class = size_classes_[it->second];
+      auto* block = static_cast<FreeBlock*>(p);
+      block->next = size_class.free_list;
+      size_class.free_list = block;
+      slab_bytes_in_use_ -= static_cast<int64_t>(BlockSize(it->second));
+      return;
+    }
+  }
+
+  BFCArena::Free(p);
+}
+
+void SlabArena::GetStats(AllocatorStats* stats) {
+  BFCArena::GetStats(stats);
+
+  std::lock_guard<std::mutex> lock(slab_lock_);
+  stats->num_allocs -= num_slab_groups_;
+  stats->bytes_in_use -= slab_group_bytes_;
+  stats->bytes_in_use += slab_bytes_in_use_;
+  stats->size_class_stats.clear();
+  for (size_t i = 0; i < kNumSizeClasses; i++) {
+    const SizeClass& size_class = size_classes_[i];
+    stats->num_allocs += size_class.num_allocs;
+    stats->size_class_stats.push_back({static_cast<int64_t>(BlockSize(i)), size_class.num_allocs, size_class.num_hits});
+  }
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/framework/bfc_arena.h"
+
+namespace onnxruntime {
+
+// An arena that serves small allocations from slabs of fixed size blocks and everything else from BFCArena.
+//
+// Small tensors like shapes and indices are allocated and freed very often, and finding a best fit chunk and
+// coalescing it on free costs much more than the allocation itself. Each size class (64 bytes to 4KB in powers of two)
+// keeps a free list of its blocks, so allocating and freeing a small block are O(1). Slabs are carved from aligned
+// slab groups allocated from the underlying BFCArena, which makes finding the slab of a pointer a hash lookup.
+// Free blocks hold the free list links, so the memory must be accessible from the CPU.
+// Slabs are never returned to the BFCArena, so Shrink only releases regions of large allocations.
+class SlabArena : public BFCArena {
+ public:
+  static const size_t kMinBlockSize = 64;
+  static const size_t kMaxBlockSize = 4096;
+  static const size_t kNumSizeClasses = 7;
+  static const size_t kSlabSize = 64 * 1024;
+  // A slab group takes one more slab for alignment, which makes it 1MB like the default initial chunk.
+  static const size_t kSlabsPerGroup = 15;
+
+  SlabArena(std::unique_ptr<IAllocator> resource_allocator,
+            size_t total_memory,
+            ArenaExtendStrategy arena_extend_strategy = DEFAULT_ARENA_EXTEND_STRATEGY,
+            int initial_chunk_size_bytes = DEFAULT_INITIAL_CHUNK_SIZE_BYTES,
+            int max_dead_bytes_per_chunk = DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+            int initial_growth_chunk_size_bytes = DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES,
+            int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES);
+
+  void* Alloc(size_t size) override;
+
+  void Free(void* p) override;
+
+  // Besides the BFCArena statistics, reports the number of allocations and free block hits of each size class.
+  // Allocations and bytes in use count small blocks by the size of their class instead of the slab groups holding
+  // them. The maximums and total allocated bytes are those of the underlying BFCArena.
+  void GetStats(AllocatorStats* stats) override;
+
+  static SlabArena* FromBFCArena(BFCArena& arena) {
+    return arena.GetArenaType() == ArenaType::SlabArena ? static_cast<SlabArena*>(&arena) : nullptr;
+  }
+
+ private:
+  // A free block stores the next free block of its class in place.
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct SizeClass {
+    FreeBlock* free_list = nullptr;
+    int64_t num_allocs = 0;
+    int64_t num_hits = 0;
+  };
+
+  static size_t SizeClassIndex(size_t size);
+
+  static size_t BlockSize(size_t size_class_index) { return kMinBlockSize << size_class_index; }
+
+  // Carve a new slab into free blocks of the size class. Caller shall hold slab_lock_.
+  void AddSlab(size_t size_class_index);
+
+  std::mutex slab_lock_;
+  std::array<SizeClass, kNumSizeClasses> size_classes_;
+
+  // Slabs that are not assigned to a size class yet.
+  std::vector<uintptr_t> free_slabs_;
+
+  // Maps the address of each assigned slab (aligned to kSlabSize) to its size class.
+  std::unordered_map<uintptr_t, size_t> slab_size_classes_;
+
+  int64_t num_slab_groups_ = 0;
+  int64_t slab_group_bytes_ = 0;
+  int64_t slab_bytes_in_use_ = 0;
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SlabArena);
+};
+
+}  // namespace onnxruntime
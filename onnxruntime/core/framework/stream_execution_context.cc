@@ -31,6 +31,7 @@ StreamExecutionContext::StreamExecutionContext(const SessionState& sess_state,
              sess_state),
       logger_(&sess_logger),
       single_thread_mode_(single_thread_mode),
+      intra_op_thread_pool_(sess_state.GetThreadPool()),
       device_stream_map_(device_stream_map),
       count_down_barriers_(num_barriers) {
   notifications_.reserve(notification_owners.size());
@@ -97,7 +98,8 @@ StreamExecutionContext::StreamExecutionContext(const SessionState& sess_state,
              fetch_allocators,
              sess_state),
       logger_(&sess_logger),
-      single_thread_mode_(single_thread_mode) {
+      single_thread_mode_(single_thread_mode),
+      intra_op_thread_pool_(sess_state.GetThreadPool()) {
 #ifdef _WIN32
 #pragma warning(push)
 #pragma warning(disable : 26409 26400)
@@ -16,6 +16,9 @@
 
 namespace onnxruntime {
 class SessionState;
+namespace concurrency {
+class ThreadPool;
+}
 
 class SessionScope;
 typedef InlinedHashMap<std::string, OrtValue> OrtValueCache;
@@ -96,6 +99,14 @@ class StreamExecutionContext {
   // 2. multi-threads mode: use inter-op thread pool to schedule the N streams.
   bool SingleThreadMode() const { return single_thread_mode_; }
 
+  // The thread pool the kernels run their parallel loops on, the intra-op thread pool of the session unless it was
+  // replaced, e.g. by nullptr when the execution is itself one of the tasks of a parallel loop on that pool.
+  concurrency::ThreadPool* GetIntraOpThreadPool() const { return intra_op_thread_pool_; }
+
+  void SetIntraOpThreadPool(concurrency::ThreadPool* thread_pool) {
+    intra_op_thread_pool_ = thread_pool;
+  }
+
   // Get the Stream instance for a given logic sequence.
   // return nullptr if the device of given logic sequence doesn't register stream support.
   Stream* GetDeviceStream(size_t idx);
@@ -171,6 +182,8 @@ class StreamExecutionContext {
 #endif
   const bool single_thread_mode_;
 
+  concurrency::ThreadPool* intra_op_thread_pool_;
+
 #ifdef ORT_ENABLE_STREAM
   InlinedVector<std::unique_ptr<synchronize::Notification>> notifications_;
   // if it is nullptr, means current session doesn't have any EP using stream feature
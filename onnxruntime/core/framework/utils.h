@@ -118,7 +118,11 @@ common::Status ExecuteSubgraph(const SessionState& session_state, const FeedsFet
                                /*when this is enabled, we will sync the parent stream to make sure the subgraph fetches
                                is complete. this is mainly used when the parent kernel depends on the CPU value of the
                                subgraph fetches, i.e. the loop condition*/
-                               bool sync_subgraph_fetches = false);
+                               bool sync_subgraph_fetches = false,
+                               /*when this is disabled, the kernels of the subgraph don't use the intra-op thread pool.
+                               this is needed when the parent kernel runs the subgraph in a parallel loop on that pool,
+                               which doesn't support nested parallel loops*/
+                               bool use_intra_op_thread_pool = true);
 
 bool IsInputOnCpu(const Node& node, const KernelCreateInfo* p_kci, size_t index);
 bool IsOutputOnCpu(const Node& node, const KernelCreateInfo* p_kci, size_t index);
@@ -346,6 +346,41 @@ void GroupQueryAttentionTypeAndShapeInference(ONNX_NAMESPACE::InferenceContext&
   BaseGroupQueryAttentionTypeAndShapeInference(ctx, past_key_index, use_max_past_present_buffer);
 }
 
+void PagedAttentionTypeAndShapeInference(ONNX_NAMESPACE::InferenceContext& ctx) {
+  //   Input 0 (query) has shape (token_count, num_heads * head_size), or packed QKV with shape
+  //   (token_count, (num_heads + 2 * kv_num_heads) * head_size)
+  //   Output 0 has shape (token_count, num_heads * head_size)
+  ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+  if (hasInputShape(ctx, 0)) {
+    auto& query_dims = getInputShape(ctx, 0).dim();
+    if (query_dims.size() != 2) {
+      fail_shape_inference("Inputs 0 (query) shall be 2 dimensions");
+    }
+
+    if (hasInputShape(ctx, 2)) {
+      ONNX_NAMESPACE::propagateShapeFromInputToOutput(ctx, 0, 0);
+    } else if (query_dims[1].has_dim_value()) {
+      int64_t num_heads = getAttribute(ctx, "num_heads", 0);
+      int64_t kv_num_heads = getAttribute(ctx, "kv_num_heads", 0);
+      int64_t head_size = query_dims[1].dim_value() / (num_heads + 2 * kv_num_heads);
+      ONNX_NAMESPACE::TensorShapeProto output_shape;
+      *output_shape.add_dim() = query_dims[0];
+      output_shape.add_dim()->set_dim_value(head_size * num_heads);
+      updateOutputShape(ctx, 0, output_shape);
+    }
+  }
+
+  // The updated caches have the same shape as the caches.
+  ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 3, 1);
+  ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 4, 2);
+  if (hasInputShape(ctx, 3)) {
+    ONNX_NAMESPACE::propagateShapeFromInputToOutput(ctx, 3, 1);
+  }
+  if (hasInputShape(ctx, 4)) {
+    ONNX_NAMESPACE::propagateShapeFromInputToOutput(ctx, 4, 2);
+  }
+}
+
 void SparseAttentionTypeAndShapeInference(ONNX_NAMESPACE::InferenceContext& ctx, int past_key_index) {
   constexpr int use_max_past_present_buffer = 1;
   BaseGroupQueryAttentionTypeAndShapeInference(ctx, past_key_index, use_max_past_present_buffer);
@@ -1206,6 +1241,125 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
           GroupQueryAttentionTypeAndShapeInference(ctx, 3);
         }));
 
+constexpr const char* PagedAttention_ver1_doc = R"DOC(
+Group Query Attention with a paged KV cache.
+
+Key and value of all sequences are stored in fixed size blocks of a shared cache pool with shape
+(num_blocks, block_size, kv_num_heads, head_size). Each sequence addresses its blocks through a row of block_table,
+so sequences of different lengths can share one pool without reserving max_sequence_length of cache for each of them.
+
+The new tokens of all sequences in the batch are packed along the first dimension of query, key and value.
+cumulative_sequence_length gives the offset of the first new token of each sequence, and past_seqlens gives the number
+of tokens that a sequence already has in the cache. The key and value of the new tokens are written into the cache
+slots following the past tokens, and then each new token attends causally to the past and new tokens of its sequence.
+
+The cache is updated in place when key_cache and value_cache are bound to the same buffers as key_cache_out and
+value_cache_out (for example with IOBinding); otherwise the cache inputs are copied to the outputs first.
+
+Several sequences may reference the same physical block in their block tables to share a common prefix without
+copying it. Only cache slots at positions past_seqlens and after are written, so shared blocks must be fully
+covered by past_seqlens of every sequence that references them.
+
+Supports different number of heads for q and kv, packed QKV, rotary position embedding, local window attention and
+softcap.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    PagedAttention, 1,
+    OpSchema()
+        .SetDoc(PagedAttention_ver1_doc)
+        .Attr("num_heads", "Number of attention heads for q", AttributeProto::INT)
+        .Attr("kv_num_heads", "Number of attention heads for k and v", AttributeProto::INT)
+        .Attr("scale",
+              "Custom scale will be used if specified. Default value is 1/sqrt(head_size)",
+              AttributeProto::FLOAT,
+              OPTIONAL_VALUE)
+        .Attr("softcap",
+              "Softcap value for attention weights. Default value is 0.",
+              AttributeProto::FLOAT,
+              OPTIONAL_VALUE)
+        .Attr("local_window_size",
+              "left_window_size for local attention (like Mistral). Default value is -1 meaning unused.",
+              AttributeProto::INT,
+              static_cast<int64_t>(-1))
+        .Attr("do_rotary",
+              "Whether to use rotary position embedding. Default value is 0.",
+              AttributeProto::INT,
+              OPTIONAL_VALUE)
+        .Attr("rotary_interleaved",
+              "Rotate using interleaved pattern. Default value is 0 (False).",
+              AttributeProto::INT,
+              OPTIONAL_VALUE)
+        .Attr("smooth_softmax",
+              "Use a smooth factor in softmax.",
+              AttributeProto::INT,
+              static_cast<int64_t>(-1))
+        .Input(0,
+               "query",
+               "Query with shape (token_count, hidden_size), or packed QKV with shape (token_count, d) "
+               "where d is (num_heads * head_size + 2 * kv_num_heads * head_size).",
+               "T")
+        .Input(1,
+               "key",
+               "Key with shape (token_count, kv_hidden_size)",
+               "T",
+               OpSchema::Optional)
+        .Input(2,
+               "value",
+               "Value with shape (token_count, kv_hidden_size)",
+               "T",
+               OpSchema::Optional)
+        .Input(3,
+               "key_cache",
+               "Paged key cache with shape (num_blocks, block_size, kv_num_heads, head_size).",
+               "T")
+        .Input(4,
+               "value_cache",
+               "Paged value cache with shape (num_blocks, block_size, kv_num_heads, head_size).",
+               "T")
+        .Input(5,
+               "cumulative_sequence_length",
+               "1D tensor with shape (batch_size + 1). The offsets of the new tokens of each sequence in query. "
+               "It starts with 0 and ends with token_count.",
+               "M")
+        .Input(6,
+               "past_seqlens",
+               "1D tensor with shape (batch_size). The number of tokens of each sequence already in the cache.",
+               "M")
+        .Input(7,
+               "block_table",
+               "2D tensor with shape (batch_size, max_num_blocks_per_seq) that maps the logical blocks of each "
+               "sequence to the blocks of the cache pool.",
+               "M")
+        .Input(8,
+               "cos_cache",
+               "2D tensor with shape (max_sequence_length, head_size / 2).",
+               "T",
+               OpSchema::Optional)
+        .Input(9,
+               "sin_cache",
+               "2D tensor with shape (max_sequence_length, head_size / 2).",
+               "T",
+               OpSchema::Optional)
+        .Output(0,
+                "output",
+                "2D output tensor with shape (token_count, hidden_size)",
+                "T")
+        .Output(1,
+                "key_cache_out",
+                "Updated paged key cache with the same shape as key_cache. It may share the buffer with key_cache.",
+                "T")
+        .Output(2,
+                "value_cache_out",
+                "Updated paged value cache with the same shape as value_cache. It may share the buffer with "
+                "value_cache.",
+                "T")
+        .TypeConstraint("T", {"tensor(float16)", "tensor(float)"}, "Constrain input and output to float tensors.")
+        .TypeConstraint("M", {"tensor(int32)"}, "Constrain sequence lengths and block table to int tensor.")
+        .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+          PagedAttentionTypeAndShapeInference(ctx);
+        }));
+
 constexpr const char* SparseAttention_ver1_doc = R"DOC(
 Block Sparse Attention used in Phi-3-small (https://arxiv.org/pdf/2404.14219).
 
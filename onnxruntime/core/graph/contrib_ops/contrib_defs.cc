@@ -1321,6 +1321,14 @@ ONNX_MS_OPERATOR_SET_SCHEMA(GreedySearch, 1,
                                       "This is relevant only for the GPT2 model. If this attribute is missing, the `decoder` subgraph will be used for all decoding runs",
                                       AttributeProto::GRAPH, OPTIONAL_VALUE)
                                 .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("draft_decoder",
+                                      "The subgraph of a smaller model with the same vocabulary for speculative decoding. "
+                                      "It proposes tokens that are verified by the `decoder` subgraph in one run. "
+                                      "This is relevant only for the GPT2 model with batch size 1 on CPU",
+                                      AttributeProto::GRAPH, OPTIONAL_VALUE)
+                                .Attr("num_speculative_tokens",
+                                      "Max number of tokens proposed by the `draft_decoder` subgraph in each verification run",
+                                      AttributeProto::INT, static_cast<int64_t>(4))
                                 .Attr("vocab_size",
                                       "Size of the vocabulary. "
                                       "If not provided, it will be inferred from the decoder subgraph's output shape",
@@ -757,6 +757,99 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
         .TypeConstraint("T2", {"tensor(uint8)", "tensor(int8)"}, "Constrain weights types to 8 bit tensors.")
         .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::RNNShapeInference));
 
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    DynamicQuantizeGRU, 1,
+    OpSchema()
+        .Attr("direction",
+              "Specify if the RNN is forward, reverse, or bidirectional. "
+              "Must be one of forward (default), reverse, or bidirectional.",
+              AttributeProto::STRING, std::string("forward"))
+        .Attr("hidden_size", "Number of neurons in the hidden layer", AttributeProto::INT, OPTIONAL_VALUE)
+        .Attr("activation_alpha",
+              "Optional scaling values used by some activation functions. The values "
+              "are consumed in the order of activation functions, for example (f, g, h) "
+              "in LSTM. Default values are the same as of corresponding ONNX operators."
+              "For example with LeakyRelu, the default alpha is 0.01.",
+              AttributeProto::FLOATS, OPTIONAL_VALUE)
+        .Attr("activation_beta",
+              "Optional scaling values used by some activation functions. The values "
+              "are consumed in the order of activation functions, for example (f, g, h) "
+              "in LSTM. Default values are the same as of corresponding ONNX operators.",
+              AttributeProto::FLOATS, OPTIONAL_VALUE)
+        .Attr("clip",
+              "Cell clip threshold. Clipping bounds the elements of a tensor "
+              "in the range of [-threshold, +threshold] and is applied to the input "
+              "of activations. No clip if not specified.",
+              AttributeProto::FLOAT, OPTIONAL_VALUE)
+        .Attr("activations",
+              "A list of 2 (or 4 if bidirectional) activation functions "
+              "for update, reset, and hidden gates. The activation functions must "
+              "be one of the activation functions specified above. Optional: See the equations "
+              "for default if not specified.",
+              AttributeProto::STRINGS, OPTIONAL_VALUE)
+        .Attr("linear_before_reset",
+              "When computing the output of the hidden gate, "
+              "apply the linear transformation before multiplying by the output of the "
+              "reset gate.",
+              AttributeProto::INT, static_cast<int64_t>(0))
+        .Input(0, "X",
+               "The input sequences packed (and potentially padded) into one 3-D "
+               "tensor with the shape of `[seq_length, batch_size, input_size]`.",
+               "T")
+        .Input(1, "W",
+               "The weight tensor for the gates. Concatenation of `W[zrh]` and "
+               "`WB[zrh]` (if bidirectional) along dimension 0. The tensor has shape "
+               "`[num_directions, input_size, 3*hidden_size]`.",
+               "T2")
+        .Input(2, "R",
+               "The recurrence weight tensor. Concatenation of `R[zrh]` and "
+               "`RB[zrh]` (if bidirectional) along dimension 0. This tensor has shape "
+               "`[num_directions, hidden_size, 3*hidden_size]`.",
+               "T2")
+        .Input(3, "B",
+               "The bias tensor for the gates. Concatenation of `[Wb[zrh], Rb[zrh]]` and "
+               "`[WBb[zrh], RBb[zrh]]` (if bidirectional) along dimension 0. This tensor "
+               "has shape `[num_directions, 6*hidden_size]`. Optional: If not specified "
+               "- assumed to be 0",
+               "T", OpSchema::Optional)
+        .Input(4, "sequence_lens",
+               "Optional tensor specifying lengths of the sequences in a batch. "
+               "If not specified - assumed all sequences in the batch to have "
+               "length `seq_length`. It has shape `[batch_size]`.",
+               "T1", OpSchema::Optional)
+        .Input(5, "initial_h",
+               "Optional initial value of the hidden. If not specified - assumed "
+               "to be 0. It has shape `[num_directions, batch_size, hidden_size]`.",
+               "T", OpSchema::Optional)
+        .Input(6, "W_scale",
+               "W's scale. Its size is [num_directions] for per-tensor/layer quantization, "
+               "or [num_directions, 3*hidden_size] for per-channel quantization on the axis input_size.",
+               "T")
+        .Input(7, "W_zero_point",
+               "W's zero point. Its size is [num_directions] for per-tensor/layer quantization, "
+               "or [num_directions, 3*hidden_size] for per-channel quantization on the axis input_size.",
+               "T2")
+        .Input(8, "R_scale",
+               "R's scale. Its size is [num_directions] for per-tensor/layer quantization, "
+               "or [num_directions, 3*hidden_size] for per-channel quantization on the axis input_size.",
+               "T")
+        .Input(9, "R_zero_point",
+               "R's zero point. Its size is [num_directions] for per-tensor/layer quantization, "
+               "or [num_directions, 3*hidden_size] for per-channel quantization on the axis input_size.",
+               "T2")
+        .Output(0, "Y",
+                "A tensor that concats all the intermediate output values of the hidden. "
+                "It has shape `[seq_length, num_directions, batch_size, hidden_size]`. ",
+                "T", OpSchema::Optional, true, 1, OpSchema::Differentiable)
+        .Output(1, "Y_h",
+                "The last output value of the hidden. It has shape "
+                "`[num_directions, batch_size, hidden_size]`.",
+                "T", OpSchema::Optional, true, 1, OpSchema::Differentiable)
+        .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors.")
+        .TypeConstraint("T1", {"tensor(int32)"}, "Constrain seq_lens to integer tensor.")
+        .TypeConstraint("T2", {"tensor(uint8)", "tensor(int8)"}, "Constrain weights types to 8 bit tensors.")
+        .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::RNNShapeInference));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(
     QLinearConcat, 1,
     OpSchema()
@@ -149,6 +149,28 @@ class Env {
 
   virtual int GetL2CacheSize() const = 0;
 
+  /// <summary>
+  /// Like GetDefaultThreadAffinities, but only for the physical cores of a NUMA node.
+  /// </summary>
+  /// <returns>Logical processors of each physical core of the node, empty if the node doesn't exist or NUMA
+  /// information is not available</returns>
+  virtual std::vector<LogicalProcessors> GetNumaNodeThreadAffinities(int /*numa_node*/) const { return {}; }
+
+  /// <summary>
+  /// Allocate memory whose pages are placed on a NUMA node. The memory is aligned to the page size and must be freed
+  /// with FreeOnNumaNode.
+  /// </summary>
+  /// <returns>nullptr if the allocation fails or NUMA placement is not supported</returns>
+  virtual void* AllocateOnNumaNode(size_t /*size*/, int /*numa_node*/) const { return nullptr; }
+
+  /// <summary>
+  /// Whether AllocateOnNumaNode is implemented. NUMA nodes may be reported by GetNumaNodeThreadAffinities even if
+  /// it isn't.
+  /// </summary>
+  virtual bool IsNumaAllocationSupported() const { return false; }
+
+  virtual void FreeOnNumaNode(void* /*p*/) const {}
+
   /// \brief Returns the number of micro-seconds since the Unix epoch.
   virtual uint64_t NowMicros() const {
     return env_time_->NowMicros();
@@ -31,8 +31,11 @@ limitations under the License.
 #endif
 #include <unistd.h>
 
+#include <fstream>
 #include <iostream>
 #include <optional>
+#include <set>
+#include <sstream>
 #include <thread>
 #include <utility>  // for std::forward
 #include <vector>
@@ -124,6 +127,37 @@ struct Freer {
 
 using MallocdStringPtr = std::unique_ptr<char, Freer<char> >;
 
+#if defined(__linux__) && !defined(__ANDROID__)
+// Read a cpu list of sysfs like "0-3,8-11". Returns an empty list if the file can't be read.
+std::vector<int> ReadSysfsCpuList(const std::string& path) {
+  std::vector<int> cpus;
+  std::ifstream file(path);
+  std::string list;
+  if (!file || !std::getline(file, list)) {
+    return cpus;
+  }
+
+  std::istringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    int first = 0, last = 0;
+    const int count = sscanf(range.c_str(), "%d-%d", &first, &last);
+    if (count == 1) {
+      last = first;
+    } else if (count != 2 || last < first) {
+      continue;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// From linux/mempolicy.h, which is not available everywhere.
+constexpr int kMpolPreferred = 1;
+#endif
+
 class PosixThread : public EnvThread {
  private:
   struct Param {
@@ -308,6 +342,95 @@ class PosixEnv : public Env {
     return ret;
   }
 
+  std::vector<LogicalProcessors> GetNumaNodeThreadAffinities(int numa_node) const override {
+    std::vector<LogicalProcessors> ret;
+#if defined(__linux__) && !defined(__ANDROID__)
+    if (numa_node < 0) {
+      return ret;
+    }
+    const auto node_cpus = ReadSysfsCpuList("/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist");
+    const std::set<int> node_cpu_set(node_cpus.begin(), node_cpus.end());
+    std::set<int> assigned;
+    for (int cpu : node_cpus) {
+      if (assigned.count(cpu) != 0) {
+        continue;
+      }
+      // group the hyper-threads of a physical core, like GetDefaultThreadAffinities
+      auto siblings = ReadSysfsCpuList("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                                       "/topology/thread_siblings_list");
+      if (siblings.empty()) {
+        siblings.push_back(cpu);
+      }
+      LogicalProcessors core;
+      for (int sibling : siblings) {
+        if (node_cpu_set.count(sibling) != 0 && assigned.insert(sibling).second) {
+          core.push_back(sibling);
+        }
+      }
+      if (!core.empty()) {
+        ret.push_back(std::move(core));
+      }
+    }
+#else
+    ORT_UNUSED_PARAMETER(numa_node);
+#endif
+    return ret;
+  }
+
+  void* AllocateOnNumaNode(size_t size, int numa_node) const override {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+    constexpr size_t kBitsPerLong = sizeof(unsigned long) * 8;
+    if (numa_node < 0 || size == 0) {
+      return nullptr;
+    }
+    // The first page holds the size of the mapping for FreeOnNumaNode, the memory returned starts after it.
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t mapping_size = (size + page_size - 1) / page_size * page_size + page_size;
+    void* mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+      return nullptr;
+    }
+
+    // Prefer the pages to be on the node. The pages of a new mapping are not touched yet, so they are placed on first
+    // touch. Placement is best effort: if the node runs out of memory the kernel falls back to other nodes rather than
+    // failing.
+    std::vector<unsigned long> node_mask(static_cast<size_t>(numa_node) / kBitsPerLong + 1, 0);
+    node_mask[static_cast<size_t>(numa_node) / kBitsPerLong] = 1UL << (static_cast<size_t>(numa_node) % kBitsPerLong);
+    if (syscall(SYS_mbind, mapping, mapping_size, kMpolPreferred, node_mask.data(),
+                node_mask.size() * kBitsPerLong + 1, 0) != 0) {
+      auto [err_no, err_msg] = GetErrnoInfo();
+      LOGS_DEFAULT(VERBOSE) << "mbind to NUMA node " << numa_node << " failed. error code: " << err_no
+                            << " error msg: " << err_msg;
+    }
+
+    *static_cast<size_t*>(mapping) = mapping_size;
+    return static_cast<char*>(mapping) + page_size;
+#else
+    ORT_UNUSED_PARAMETER(size);
+    ORT_UNUSED_PARAMETER(numa_node);
+    return nullptr;
+#endif
+  }
+
+  bool IsNumaAllocationSupported() const override {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void FreeOnNumaNode(void* p) const override {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+    if (p != nullptr) {
+      void* mapping = static_cast<char*>(p) - static_cast<size_t>(sysconf(_SC_PAGESIZE));
+      munmap(mapping, *static_cast<const size_t*>(mapping));
+    }
+#else
+    ORT_UNUSED_PARAMETER(p);
+#endif
+  }
+
   int GetL2CacheSize() const override {
 #ifdef _SC_LEVEL2_CACHE_SIZE
     return static_cast<int>(sysconf(_SC_LEVEL2_CACHE_SIZE));
@@ -308,6 +308,44 @@ int WindowsEnv::GetL2CacheSize() const {
   return l2_cache_size_;
 }
 
+std::vector<LogicalProcessors> WindowsEnv::GetNumaNodeThreadAffinities(int numa_node) const {
+  std::vector<LogicalProcessors> ret;
+  GROUP_AFFINITY node_mask{};
+  if (numa_node < 0 || numa_node > USHRT_MAX ||
+      !GetNumaNodeProcessorMaskEx(static_cast<USHORT>(numa_node), &node_mask)) {
+    return ret;
+  }
+  for (const auto& core : cores_) {
+    LogicalProcessors node_core;
+    for (auto global_processor_id : core) {
+      auto processor_info = GetProcessorAffinityMask(global_processor_id);
+      if (processor_info.group_id == static_cast<int>(node_mask.Group) &&
+          (node_mask.Mask & (static_cast<KAFFINITY>(1) << processor_info.local_processor_id)) != 0) {
+        node_core.push_back(global_processor_id);
+      }
+    }
+    if (!node_core.empty()) {
+      ret.push_back(std::move(node_core));
+    }
+  }
+  return ret;
+}
+
+void* WindowsEnv::AllocateOnNumaNode(size_t size, int numa_node) const {
+  if (numa_node < 0 || size == 0) {
+    return nullptr;
+  }
+  // the node is the preferred node, pages come from other nodes if it has no free memory
+  return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                            static_cast<DWORD>(numa_node));
+}
+
+void WindowsEnv::FreeOnNumaNode(void* p) const {
+  if (p != nullptr) {
+    VirtualFree(p, 0, MEM_RELEASE);
+  }
+}
+
 WindowsEnv& WindowsEnv::Instance() {
   static WindowsEnv default_env;
   return default_env;
@@ -56,6 +56,10 @@ class WindowsEnv : public Env {
   int GetNumPhysicalCpuCores() const override;
   std::vector<LogicalProcessors> GetDefaultThreadAffinities() const override;
   int GetL2CacheSize() const override;
+  std::vector<LogicalProcessors> GetNumaNodeThreadAffinities(int numa_node) const override;
+  void* AllocateOnNumaNode(size_t size, int numa_node) const override;
+  void FreeOnNumaNode(void* p) const override;
+  bool IsNumaAllocationSupported() const override { return true; }
   static WindowsEnv& Instance();
   PIDType GetSelfPid() const override;
   Status GetFileLength(_In_z_ const ORTCHAR_T* file_path, size_t& length) const override;
@@ -438,7 +438,9 @@ Status IfImpl::Execute(const FeedsFetchesManager& ffm) {
 
   status = utils::ExecuteSubgraph(session_state_, ffm, feeds, fetches, fetch_allocators,
                                   ExecutionMode::ORT_SEQUENTIAL, context_.GetTerminateFlag(),
-                                  context_.Logger(), context_.GetComputeStream());
+                                  context_.Logger(), context_.GetComputeStream(), /*sync_subgraph_fetches*/ false,
+                                  // no intra-op thread pool when the If itself runs in a parallel Scan iteration
+                                  /*use_intra_op_thread_pool*/ context_.GetOperatorThreadPool() != nullptr);
 
   ORT_RETURN_IF_ERROR(status);
 
@@ -23,6 +23,10 @@
 #include "core/framework/TensorSeq.h"
 #include "core/providers/utils.h"
 
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
 #include <gsl/gsl>
 
 #ifdef _MSC_VER
@@ -213,6 +217,13 @@ class LoopImpl {
   void CreateInitialFeeds(std::vector<OrtValue>& feeds);
   void SaveOutputsAndUpdateFeeds(const std::vector<OrtValue>& last_outputs, std::vector<OrtValue>& next_inputs);
 
+  // custom fetch allocator for the loop carried variables, which recycles the buffer allocated two iterations ago
+  Status AllocateLoopCarriedVar(size_t index, const std::vector<OrtValue>& feeds, const TensorShape& shape,
+                                const OrtDevice& location, OrtValue& ort_value, bool& allocated);
+
+  // whether a buffer is still referenced by the feeds of the current iteration
+  bool IsBufferInUse(const Tensor& buffer, const std::vector<OrtValue>& feeds) const;
+
   // create the single Loop output from a collection of per-iteration outputs
   Status ConcatenateLoopOutput(std::vector<OrtValue>& per_iteration_output, int output_index);
 
@@ -232,9 +243,25 @@ class LoopImpl {
   // the order from the subgraph matches the order from the loop output
   std::vector<std::vector<OrtValue>> loop_output_tensors_;
 
+  // element type of the loop carried variables which are tensors, nullptr for the other types.
+  std::vector<MLDataType> loop_carried_var_types_;
+
+  // buffers allocated for the loop carried variables in the last two iterations, indexed by iteration parity.
+  // the output of the previous iteration is the input of the current one, so the output of the iteration before it
+  // can usually be overwritten instead of allocating a new buffer. a buffer that a saved loop output aliases is
+  // dropped from here, so it is never overwritten.
+  std::vector<std::array<OrtValue, 2>> loop_carried_var_buffers_;
+
   const Loop::ConcatOutput& concat_output_func_;
 };
 
+// whether the data of two tensors overlaps
+static bool Overlaps(const Tensor& a, const Tensor& b) {
+  const auto* a_begin = static_cast<const std::byte*>(a.DataRaw());
+  const auto* b_begin = static_cast<const std::byte*>(b.DataRaw());
+  return b_begin < a_begin + a.SizeInBytes() && a_begin < b_begin + b.SizeInBytes();
+}
+
 static Status ConcatenateCpuOutput(void* /*stream*/,
                                    std::vector<OrtValue>& per_iteration_output,
                                    void* output, size_t output_size_in_bytes) {
@@ -434,6 +461,18 @@ Status LoopImpl::Initialize() {
 
   loop_output_tensors_.resize(static_cast<size_t>(info_.num_outputs) - info_.num_loop_carried_vars);
 
+  // use the types of the subgraph outputs as they are what the subgraph execution allocates
+  auto& subgraph_outputs = info_.subgraph.GetOutputs();
+  loop_carried_var_types_.resize(info_.num_loop_carried_vars, nullptr);
+  loop_carried_var_buffers_.resize(info_.num_loop_carried_vars);
+  for (int i = 0; i < info_.num_loop_carried_vars; ++i) {
+    const auto* type_proto = subgraph_outputs[static_cast<size_t>(i) + 1]->TypeAsProto();  // skip 'cond'
+    if (type_proto && type_proto->has_tensor_type() && type_proto->tensor_type().has_elem_type()) {
+      loop_carried_var_types_[i] =
+          DataTypeImpl::TensorTypeFromONNXEnum(type_proto->tensor_type().elem_type())->GetElementType();
+    }
+  }
+
   return status;
 }
 
@@ -469,9 +508,52 @@ void LoopImpl::SaveOutputsAndUpdateFeeds(const std::vector<OrtValue>& last_outpu
   for (ptrdiff_t j = info_.num_loop_carried_vars; j < info_.num_outputs; ++j) {
     ORT_ENFORCE(last_outputs[j + 1].IsTensor(), "All scan outputs MUST be tensors");
     loop_output_tensors_[j - info_.num_loop_carried_vars].push_back(last_outputs[j + 1]);  // skip 'cond' in output
+
+    // the subgraph may have forwarded a loop carried variable to the loop output through an aliasing operator
+    const auto& tensor = last_outputs[j + 1].Get<Tensor>();
+    for (auto& buffers : loop_carried_var_buffers_) {
+      for (auto& buffer : buffers) {
+        if (buffer.IsAllocated() && Overlaps(buffer.Get<Tensor>(), tensor)) {
+          buffer = OrtValue();
+        }
+      }
+    }
   }
 }
 
+bool LoopImpl::IsBufferInUse(const Tensor& buffer, const std::vector<OrtValue>& feeds) const {
+  return std::any_of(feeds.cbegin(), feeds.cend(), [&buffer](const OrtValue& feed) {
+    return feed.IsTensor() && Overlaps(buffer, feed.Get<Tensor>());
+  });
+}
+
+Status LoopImpl::AllocateLoopCarriedVar(size_t index, const std::vector<OrtValue>& feeds, const TensorShape& shape,
+                                        const OrtDevice& location, OrtValue& ort_value, bool& allocated) {
+  const auto& iter_num_value = *iter_num_mlvalue_.Get<Tensor>().Data<int64_t>();
+  OrtValue& buffer = loop_carried_var_buffers_[index][iter_num_value % 2];
+
+  // the buffer may still be used if the subgraph forwarded it to another output through an aliasing operator
+  if (buffer.IsAllocated()) {
+    const auto& tensor = buffer.Get<Tensor>();
+    if (tensor.Shape() == shape && tensor.Location().device == location && !IsBufferInUse(tensor, feeds)) {
+      ort_value = buffer;
+      allocated = true;
+      return Status::OK();
+    }
+  }
+
+  auto allocator = session_state_.GetAllocator(location);
+  if (!allocator) {
+    // let the execution frame allocate the output
+    return Status::OK();
+  }
+
+  Tensor::InitOrtValue(loop_carried_var_types_[index], shape, std::move(allocator), buffer);
+  ort_value = buffer;
+  allocated = true;
+  return Status::OK();
+}
+
 Status LoopImpl::ConcatenateLoopOutput(std::vector<OrtValue>& per_iteration_output, int output_index) {
   const auto& first_output = per_iteration_output.front().Get<Tensor>();
   const auto& per_iteration_dims = first_output.Shape().GetDims();
@@ -497,9 +579,22 @@ Status LoopImpl::Execute(const FeedsFetchesManager& ffm) {
 
   std::vector<OrtValue> feeds;
   std::vector<OrtValue> fetches;
+  fetches.reserve(info_.num_subgraph_outputs);
 
   CreateInitialFeeds(feeds);
 
+  // fetch 0 is 'cond', the loop carried variables follow
+  std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators;
+  for (int i = 0; i < info_.num_loop_carried_vars; ++i) {
+    if (loop_carried_var_types_[i] != nullptr) {
+      fetch_allocators[static_cast<size_t>(i) + 1] = [this, i, &feeds](const TensorShape& shape,
+                                                                        const OrtDevice& location,
+                                                                        OrtValue& ort_value, bool& allocated) {
+        return AllocateLoopCarriedVar(static_cast<size_t>(i), feeds, shape, location, ort_value, allocated);
+      };
+    }
+  }
+
   auto& iter_num_value = *iter_num_mlvalue_.GetMutable<Tensor>()->MutableData<int64_t>();
 
   while (iter_num_value < max_trip_count_ && *condition_mlvalue_.GetMutable<Tensor>()->MutableData<bool>()) {
@@ -508,12 +603,14 @@ Status LoopImpl::Execute(const FeedsFetchesManager& ffm) {
       fetches.clear();
     }
 
-    status = utils::ExecuteSubgraph(session_state_, ffm, feeds, fetches, {},
+    status = utils::ExecuteSubgraph(session_state_, ffm, feeds, fetches, fetch_allocators,
                                     ExecutionMode::ORT_SEQUENTIAL, context_.GetTerminateFlag(), context_.Logger(),
                                     context_.GetComputeStream(),
                                     // because the fetch[0] is the loop condition which we need to access on CPU,
                                     // have to perofrm a stream sync to make sure the data arrived.
-                                    true);
+                                    true,
+                                    // no intra-op thread pool when the Loop itself runs in a parallel Scan iteration
+                                    context_.GetOperatorThreadPool() != nullptr);
     ORT_RETURN_IF_ERROR(status);
 
     condition_mlvalue_ = fetches[0];
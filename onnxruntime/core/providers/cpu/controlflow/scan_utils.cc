@@ -19,6 +19,9 @@
 #include "core/framework/utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
 #include "core/framework/session_options.h"
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
 
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -183,6 +186,61 @@ Status CreateFeedsFetchesManager(const Node& node,
   return Status::OK();
 }
 
+// Runs the iterations [first_seq_no, seq_length) of a subgraph without loop state variables in parallel.
+// The iterations are independent, so each one gets its own feeds and fetches and runs in its own execution frame.
+// The loop runs on the intra-op thread pool, so the kernels of the subgraph run without it.
+static Status IterateSequenceInParallel(
+    OpKernelContextInternal& context, const SessionState& session_state,
+    std::vector<OrtValueTensorSlicer<const OrtValue>::Iterator>& scan_input_stream_iterators,
+    int64_t first_seq_no, int64_t seq_length, int num_variadic_inputs, int num_variadic_outputs,
+    const std::vector<OrtValue>& implicit_feeds, std::vector<std::unique_ptr<OutputIterator>>& output_iterators,
+    const FeedsFetchesManager& ffm) {
+  const auto num_iterations = onnxruntime::narrow<size_t>(seq_length - first_seq_no);
+  const auto num_inputs = static_cast<size_t>(num_variadic_inputs);
+  const auto num_outputs = static_cast<size_t>(num_variadic_outputs);
+
+  // the iterators only move forward, so slice the inputs and outputs of all the iterations first.
+  // this also leaves the output iterators where the sequential execution would, which Scan 8 relies on as it
+  // uses them for all the batches.
+  std::vector<OrtValue> iteration_inputs(num_iterations * num_inputs);
+  std::vector<OrtValue> iteration_outputs(num_iterations * num_outputs);
+  for (size_t i = 0; i < num_iterations; ++i) {
+    for (size_t input = 0; input < num_inputs; ++input) {
+      auto& iterator = scan_input_stream_iterators[input];
+      iteration_inputs[i * num_inputs + input] = *iterator;
+      ++iterator;
+    }
+
+    for (size_t output = 0; output < num_outputs; ++output) {
+      auto& iterator = *output_iterators[output];
+      iteration_outputs[i * num_outputs + output] = *iterator;
+      ++iterator;
+    }
+  }
+
+  std::vector<Status> statuses(num_iterations);
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      context.GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(num_iterations),
+      [&](std::ptrdiff_t i) {
+        const auto iteration = static_cast<size_t>(i);
+        std::vector<OrtValue> feeds(implicit_feeds);
+        std::copy_n(iteration_inputs.cbegin() + iteration * num_inputs, num_inputs, feeds.begin());
+        std::vector<OrtValue> fetches(iteration_outputs.cbegin() + iteration * num_outputs,
+                                      iteration_outputs.cbegin() + (iteration + 1) * num_outputs);
+
+        statuses[iteration] = utils::ExecuteSubgraph(session_state, ffm, feeds, fetches, {},
+                                                     ExecutionMode::ORT_SEQUENTIAL, context.GetTerminateFlag(),
+                                                     context.Logger(), nullptr, /*sync_subgraph_fetches*/ false,
+                                                     /*use_intra_op_thread_pool*/ false);
+      });
+
+  for (const auto& status : statuses) {
+    ORT_RETURN_IF_ERROR(status);
+  }
+
+  return Status::OK();
+}
+
 Status IterateSequence(OpKernelContextInternal& context, const SessionState& session_state,
                        std::vector<LoopStateVariable>& loop_state_variables,
                        std::vector<OrtValueTensorSlicer<const OrtValue>::Iterator>& scan_input_stream_iterators,
@@ -208,6 +266,11 @@ Status IterateSequence(OpKernelContextInternal& context, const SessionState& ses
     feeds[num_variadic_inputs + i] = *implicit_inputs[i];
   }
 
+  // Without loop state variables the iterations are independent. The first one allocates the outputs if their
+  // shape isn't known yet, the others can then run in parallel. Only done on CPU, where there is no stream to share.
+  const bool parallel = num_loop_state_variables == 0 && seq_length > 2 && context.GetComputeStream() == nullptr &&
+                        concurrency::ThreadPool::DegreeOfParallelism(context.GetOperatorThreadPool()) > 1;
+
   int64_t seq_no = 0;
   for (; seq_no < seq_length; ++seq_no) {
     for (int input = 0; input < num_variadic_inputs; ++input) {
@@ -272,7 +335,9 @@ Status IterateSequence(OpKernelContextInternal& context, const SessionState& ses
     // Create Executor and run graph.
     status = utils::ExecuteSubgraph(session_state, ffm, feeds, fetches, fetch_allocators,
                                     ExecutionMode::ORT_SEQUENTIAL, context.GetTerminateFlag(), context.Logger(),
-                                    context.GetComputeStream());
+                                    context.GetComputeStream(), /*sync_subgraph_fetches*/ false,
+                                    // no intra-op thread pool when the Scan itself runs in a parallel Scan iteration
+                                    /*use_intra_op_thread_pool*/ context.GetOperatorThreadPool() != nullptr);
 
     ORT_RETURN_IF_ERROR(status);
 
@@ -287,6 +352,14 @@ Status IterateSequence(OpKernelContextInternal& context, const SessionState& ses
     if (seq_no == 0) {
       // we only ever use custom allocators on the first iteration as the final output is always allocated during that
       fetch_allocators.clear();
+
+      if (parallel && std::all_of(output_iterators.cbegin(), output_iterators.cend(),
+                                  [](const std::unique_ptr<OutputIterator>& iterator) {
+                                    return iterator->FinalOutputAllocated();
+                                  })) {
+        return IterateSequenceInParallel(context, session_state, scan_input_stream_iterators, 1, seq_length,
+                                         num_variadic_inputs, num_variadic_outputs, feeds, output_iterators, ffm);
+      }
     }
   }
 
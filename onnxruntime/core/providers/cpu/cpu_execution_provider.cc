@@ -4,10 +4,12 @@
 #include "core/providers/cpu/cpu_execution_provider.h"
 
 #include "core/framework/allocator_utils.h"
+#include "core/framework/numa_allocator.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/kernel_registry.h"
 #include "core/framework/int4.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/platform/env.h"
 
 #ifndef DISABLE_CONTRIB_OPS
 #include "contrib_ops/cpu/cpu_contrib_kernels.h"
@@ -32,7 +34,23 @@ CPUExecutionProvider::CPUExecutionProvider(const CPUExecutionProviderInfo& info)
 
 std::vector<AllocatorPtr> CPUExecutionProvider::CreatePreferredAllocators() {
   const bool create_arena = DoesCpuAllocatorSupportArenaUsage() ? info_.create_arena : false;
-  AllocatorCreationInfo device_info_cpu{[](int) { return std::make_unique<CPUAllocator>(); },
+  // NUMA placement works on whole pages, so it's only used to back the arena.
+  const int numa_node = create_arena && info_.numa_node >= 0 &&
+                                Env::Default().IsNumaAllocationSupported() &&
+                                !Env::Default().GetNumaNodeThreadAffinities(info_.numa_node).empty()
+                            ? info_.numa_node
+                            : -1;
+  if (info_.numa_node >= 0 && numa_node < 0) {
+    LOGS_DEFAULT(WARNING) << "CPU memory is not placed on NUMA node " << info_.numa_node
+                          << ", the node is not available, NUMA placement of memory is not supported"
+                          << " or the CPU memory arena is disabled";
+  }
+  AllocatorCreationInfo device_info_cpu{[numa_node](int) -> std::unique_ptr<IAllocator> {
+                                          if (numa_node >= 0) {
+                                            return std::make_unique<NumaCPUAllocator>(numa_node);
+                                          }
+                                          return std::make_unique<CPUAllocator>();
+                                        },
                                         DEFAULT_CPU_ALLOCATOR_DEVICE_ID, create_arena};
 
   return std::vector<AllocatorPtr>{CreateAllocator(device_info_cpu)};
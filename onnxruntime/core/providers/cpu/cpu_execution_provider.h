@@ -11,6 +11,8 @@ namespace onnxruntime {
 // Information needed to construct CPU execution providers.
 struct CPUExecutionProviderInfo {
   bool create_arena{true};
+  // NUMA node to place the memory of the arena on, -1 for no placement. See kOrtSessionOptionsNumaNode.
+  int numa_node{-1};
 
   explicit CPUExecutionProviderInfo(bool use_arena)
       : create_arena(use_arena) {}
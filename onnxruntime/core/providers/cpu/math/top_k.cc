@@ -25,6 +25,8 @@
 #include <queue>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <type_traits>
 #include <core/common/safeint.h>
 
 namespace onnxruntime {
@@ -32,6 +34,7 @@ namespace onnxruntime {
 template <typename T>
 struct GreaterValueCmp {
   using DataType = T;
+  static constexpr bool kLargest = true;
   GreaterValueCmp(const T* data = nullptr) : data_(data) {
   }
 
@@ -53,6 +56,7 @@ struct GreaterValueCmp {
 template <typename T>
 struct LesserValueCmp {
   using DataType = T;
+  static constexpr bool kLargest = false;
 
   LesserValueCmp(const T* data = nullptr) : data_(data) {
   }
@@ -140,6 +144,188 @@ static void SelectTopK(const Comparator& comparer,
   // the data_holder now contains the indices of the top k elements in the first k elements
 }
 
+// Radix selection of the top k elements of a long contiguous row of floats, parallelized within the row.
+//
+// The floats are mapped to unsigned keys with the same order (inverted when selecting the smallest), and a histogram
+// of the top kRadixBits bits of the keys is built in parallel, one per chunk of the row. The bin where the k-th best
+// key falls is the threshold: the elements of the bins above are in the top k, and those of the threshold bin are
+// candidates. A second parallel pass writes both to their place using the per-chunk counts, then the missing
+// elements are selected among the candidates. Ties are broken by index as in the other paths.
+namespace radix_select {
+
+constexpr int kRadixBits = 11;
+constexpr size_t kRadixBins = size_t{1} << kRadixBits;
+constexpr int kRadixShift = 32 - kRadixBits;
+
+// Rows shorter than this are not worth the histogram passes.
+constexpr int64_t kMinCols = 1 << 15;
+// Minimum number of elements processed by a thread.
+constexpr int64_t kMinChunkSize = 1 << 14;
+
+// Maps a float to an unsigned integer with the same order. -0.0 is mapped as 0.0 as they compare equal.
+inline uint32_t OrderedKey(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  if (bits == 0x80000000u) {
+    bits = 0;
+  }
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline bool IsNaNBits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x7fffffffu) > 0x7f800000u;
+}
+
+// Returns true if data[0, size) contains NaN.
+static bool HasNaN(const float* data, int64_t size, concurrency::ThreadPool* threadpool, int64_t num_chunks) {
+  std::vector<uint8_t> has_nan(onnxruntime::narrow<size_t>(num_chunks), 0);
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      threadpool, onnxruntime::narrow<std::ptrdiff_t>(num_chunks), [&](std::ptrdiff_t chunk) {
+        auto work = concurrency::ThreadPool::PartitionWork(chunk, num_chunks, size);
+        bool nan = false;
+        for (auto i = work.start; i < work.end; ++i) {
+          nan |= IsNaNBits(data[i]);
+        }
+        has_nan[chunk] = nan ? 1 : 0;
+      });
+  return std::any_of(has_nan.begin(), has_nan.end(), [](uint8_t nan) { return nan != 0; });
+}
+
+// Selects the top k elements of row[0, cols) and writes their index within the row to selected.
+// The row shall not contain NaN.
+template <bool largest>
+static void SelectTopKRow(const float* row, int64_t cols, unsigned k, concurrency::ThreadPool* threadpool,
+                          int64_t num_chunks, std::vector<uint32_t>& histograms, std::vector<int64_t>& selected) {
+  constexpr uint32_t flip = largest ? 0u : ~0u;
+  histograms.assign(onnxruntime::narrow<size_t>(num_chunks) * kRadixBins, 0);
+
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      threadpool, onnxruntime::narrow<std::ptrdiff_t>(num_chunks), [&](std::ptrdiff_t chunk) {
+        auto work = concurrency::ThreadPool::PartitionWork(chunk, num_chunks, cols);
+        uint32_t* histogram = histograms.data() + chunk * kRadixBins;
+        for (auto i = work.start; i < work.end; ++i) {
+          ++histogram[(OrderedKey(row[i]) ^ flip) >> kRadixShift];
+        }
+      });
+
+  // find the bin of the k-th best key, starting from the best bin
+  size_t threshold_bin = kRadixBins - 1;
+  size_t num_above = 0;
+  for (;; --threshold_bin) {
+    size_t count = 0;
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      count += histograms[chunk * kRadixBins + threshold_bin];
+    }
+    if (num_above + count >= k) {
+      break;
+    }
+    num_above += count;
+  }
+
+  // where each chunk writes its selected elements and its candidates
+  std::vector<size_t> above_offsets(onnxruntime::narrow<size_t>(num_chunks));
+  std::vector<size_t> candidate_offsets(onnxruntime::narrow<size_t>(num_chunks));
+  size_t above_offset = 0;
+  size_t candidate_offset = 0;
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    const uint32_t* histogram = histograms.data() + chunk * kRadixBins;
+    above_offsets[chunk] = above_offset;
+    candidate_offsets[chunk] = candidate_offset;
+    for (size_t bin = threshold_bin + 1; bin < kRadixBins; ++bin) {
+      above_offset += histogram[bin];
+    }
+    candidate_offset += histogram[threshold_bin];
+  }
+
+  selected.resize(k);
+  std::vector<std::pair<uint32_t, int64_t>> candidates(candidate_offset);
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      threadpool, onnxruntime::narrow<std::ptrdiff_t>(num_chunks), [&](std::ptrdiff_t chunk) {
+        auto work = concurrency::ThreadPool::PartitionWork(chunk, num_chunks, cols);
+        int64_t* above = selected.data() + above_offsets[chunk];
+        auto* candidate = candidates.data() + candidate_offsets[chunk];
+        for (auto i = work.start; i < work.end; ++i) {
+          const uint32_t key = OrderedKey(row[i]) ^ flip;
+          const size_t bin = key >> kRadixShift;
+          if (bin > threshold_bin) {
+            *above++ = i;
+          } else if (bin == threshold_bin) {
+            *candidate++ = {key, i};
+          }
+        }
+      });
+
+  // the best keys of the threshold bin, lowest index first on ties
+  const size_t num_missing = k - num_above;
+  auto better = [](const std::pair<uint32_t, int64_t>& lhs, const std::pair<uint32_t, int64_t>& rhs) {
+    return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+  };
+  if (num_missing < candidates.size()) {
+    std::nth_element(candidates.begin(), candidates.begin() + (num_missing - 1), candidates.end(), better);
+  }
+  for (size_t i = 0; i < num_missing; ++i) {
+    selected[num_above + i] = candidates[i].second;
+  }
+}
+
+}  // namespace radix_select
+
+// Selects the top k of each row with radix_select::SelectTopKRow when the rows are long, contiguous and too few
+// to keep all the threads busy. Returns false if it did not handle the input.
+template <class Comparator>
+static bool FindTopKElementsRadixSelect(const typename Comparator::DataType* input_data, int64_t rows, int64_t cols,
+                                        const unsigned k, bool sorted,
+                                        EigenMatrixMapRowMajor<typename Comparator::DataType>& values_map,
+                                        EigenMatrixMapRowMajor<int64_t>& indices_map,
+                                        concurrency::ThreadPool* threadpool) {
+  if constexpr (!std::is_same_v<typename Comparator::DataType, float>) {
+    ORT_UNUSED_PARAMETER(input_data);
+    ORT_UNUSED_PARAMETER(rows);
+    ORT_UNUSED_PARAMETER(cols);
+    ORT_UNUSED_PARAMETER(k);
+    ORT_UNUSED_PARAMETER(sorted);
+    ORT_UNUSED_PARAMETER(values_map);
+    ORT_UNUSED_PARAMETER(indices_map);
+    ORT_UNUSED_PARAMETER(threadpool);
+    return false;
+  } else {
+    const int64_t tp_threads = concurrency::ThreadPool::DegreeOfParallelism(threadpool);
+    // with a small k the heap rarely goes past its top and is hard to beat, and many rows are already
+    // processed in parallel
+    if (cols < radix_select::kMinCols || k < 16 || k > cols / 8 || rows >= tp_threads) {
+      return false;
+    }
+
+    // the order of NaN is left to the other paths, so check all the rows before selecting in any of them
+    const int64_t num_chunks = std::max<int64_t>(1, std::min(tp_threads, cols / radix_select::kMinChunkSize));
+    if (radix_select::HasNaN(input_data, rows * cols, threadpool, num_chunks)) {
+      return false;
+    }
+
+    std::vector<uint32_t> histograms;
+    std::vector<int64_t> selected;
+    for (int64_t i = 0; i < rows; ++i) {
+      const float* row = input_data + i * cols;
+      if constexpr (Comparator::kLargest) {
+        radix_select::SelectTopKRow<true>(row, cols, k, threadpool, num_chunks, histograms, selected);
+      } else {
+        radix_select::SelectTopKRow<false>(row, cols, k, threadpool, num_chunks, histograms, selected);
+      }
+
+      if (sorted) {
+        std::sort(selected.begin(), selected.end(), Comparator(row));
+      }
+      for (size_t l = 0; l < k; ++l) {
+        values_map(i, l) = row[selected[l]];
+        indices_map(i, l) = selected[l];
+      }
+    }
+    return true;
+  }
+}
+
 // Given an input tensor 'input' and metadata values - 'k' and 'axis_parsed',
 // this method will extract the sorted top k largest/smallest elements and place them in the output tensor 'values'
 // along with the metadata output 'indices'
@@ -179,6 +365,11 @@ static void FindTopKElements(const Tensor* input, const TensorShape& input_shape
   //            k = [ 1, 2, 4, 6, 8, 16, 24, 32, 48, 64, 128 ]
   bool use_priority_queue = k != 1 && (k < 4 || (std::log2(k) / std::log2(num_blocks)) < 0.725);
 
+  if (block_slice == 1 &&
+      FindTopKElementsRadixSelect<Comparator>(input_data, rows, cols, k, sorted, values_map, indices_map, threadpool)) {
+    return;
+  }
+
   std::function<void(std::ptrdiff_t batch)> find_top_k;
 
   if (k == 1) {
@@ -0,0 +1,193 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+
+namespace onnxruntime {
+namespace ml {
+
+#ifndef DISABLE_ABSEIL
+template <typename T>
+using HashFunc = absl::container_internal::hash_default_hash<T>;
+
+template <typename T>
+using EqualFunc = absl::container_internal::hash_default_eq<T>;
+#else
+template <typename T>
+using HashFunc = std::hash<T>;
+
+template <typename T>
+using EqualFunc = std::equal_to<T>;
+#endif  // DISABLE_ABSEIL
+
+inline void PrefetchForRead(const void* p) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(p);
+#else
+  ORT_UNUSED_PARAMETER(p);
+#endif
+}
+
+/**
+ * Read-mostly hash map for the lookup tables of the ML operators, filled when the kernel is constructed.
+ *
+ * The keys and values are stored in two arrays in insertion order. The table itself is open addressed with linear
+ * probing and holds 8-byte slots: the position of the entry and the upper bits of the hash of its key, so that a
+ * probe only compares the keys, which for strings means reading their characters, when these bits match.
+ * The load factor is kept at or below 1/2.
+ *
+ * Lookup processes the input in batches: the hashes of a batch are computed and their slots prefetched first,
+ * then the slots are probed, so the cache misses of a batch overlap instead of being paid one after the other.
+ */
+template <typename TKey, typename TValue, typename Hash = HashFunc<TKey>, typename Equal = EqualFunc<TKey>>
+class FlatLookupMap {
+ public:
+  // Number of keys hashed and prefetched together by Lookup.
+  static constexpr size_t kBatchSize = 16;
+
+  FlatLookupMap() { slots_.resize(kMinCapacity); }
+
+  size_t Size() const { return keys_.size(); }
+
+  // Sizes the table for n keys.
+  void Reserve(size_t n) {
+    keys_.reserve(n);
+    values_.reserve(n);
+    if (2 * n > slots_.size()) {
+      Rehash(2 * n);
+    }
+  }
+
+  // Adds a key if it is not in the map yet. Returns false if it already was, and the value is left unchanged.
+  bool Emplace(const TKey& key, const TValue& value) {
+    return Insert(key, value, false);
+  }
+
+  // Adds a key, or replaces its value if it already was in the map.
+  void InsertOrAssign(const TKey& key, const TValue& value) {
+    Insert(key, value, true);
+  }
+
+  // Returns the value of a key, nullptr if it is not in the map.
+  const TValue* Find(const TKey& key) const {
+    return Find(key, Mix(hash_(key)));
+  }
+
+  // Writes the value of each key of input to output, or default_value for keys which are not in the map.
+  void Lookup(gsl::span<const TKey> input, gsl::span<TValue> output, const TValue& default_value) const {
+    ORT_ENFORCE(input.size() == output.size(), "Input and output of a lookup must have the same size.");
+    uint64_t hashes[kBatchSize];
+    for (size_t begin = 0; begin < input.size(); begin += kBatchSize) {
+      const size_t count = std::min(kBatchSize, input.size() - begin);
+      for (size_t i = 0; i < count; ++i) {
+        hashes[i] = Mix(hash_(input[begin + i]));
+        PrefetchForRead(&slots_[static_cast<size_t>(hashes[i]) & mask_]);
+      }
+      for (size_t i = 0; i < count; ++i) {
+        const TValue* value = Find(input[begin + i], hashes[i]);
+        output[begin + i] = value == nullptr ? default_value : *value;
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kMinCapacity = 16;
+  static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+
+  struct Slot {
+    uint32_t entry = kEmpty;
+    uint32_t tag = 0;
+  };
+
+  // Spreads the bits of the hash, std::hash is the identity for integers with some standard libraries.
+  static uint64_t Mix(size_t hash) {
+    uint64_t h = static_cast<uint64_t>(hash);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static uint32_t Tag(uint64_t hash) { return static_cast<uint32_t>(hash >> 32); }
+
+  const TValue* Find(const TKey& key, uint64_t hash) const {
+    const uint32_t tag = Tag(hash);
+    for (size_t pos = static_cast<size_t>(hash) & mask_;; pos = (pos + 1) & mask_) {
+      const Slot& slot = slots_[pos];
+      if (slot.entry == kEmpty) {
+        return nullptr;
+      }
+      if (slot.tag == tag && equal_(keys_[slot.entry], key)) {
+        return &values_[slot.entry];
+      }
+    }
+  }
+
+  bool Insert(const TKey& key, const TValue& value, bool assign) {
+    if (2 * (keys_.size() + 1) > slots_.size()) {
+      Rehash(2 * slots_.size());
+    }
+    const uint64_t hash = Mix(hash_(key));
+    const uint32_t tag = Tag(hash);
+    size_t pos = static_cast<size_t>(hash) & mask_;
+    for (; slots_[pos].entry != kEmpty; pos = (pos + 1) & mask_) {
+      const Slot& slot = slots_[pos];
+      if (slot.tag == tag && equal_(keys_[slot.entry], key)) {
+        if (assign) {
+          values_[slot.entry] = value;
+        }
+        return false;
+      }
+    }
+    ORT_ENFORCE(keys_.size() < kEmpty, "Too many keys for a lookup table.");
+    slots_[pos].entry = static_cast<uint32_t>(keys_.size());
+    slots_[pos].tag = tag;
+    keys_.push_back(key);
+    values_.push_back(value);
+    return true;
+  }
+
+  void Rehash(size_t min_capacity) {
+    size_t capacity = kMinCapacity;
+    while (capacity < min_capacity) {
+      capacity *= 2;
+    }
+    slots_.assign(capacity, Slot{});
+    mask_ = capacity - 1;
+    for (size_t entry = 0; entry < keys_.size(); ++entry) {
+      const uint64_t hash = Mix(hash_(keys_[entry]));
+      size_t pos = static_cast<size_t>(hash) & mask_;
+      while (slots_[pos].entry != kEmpty) {
+        pos = (pos + 1) & mask_;
+      }
+      slots_[pos].entry = static_cast<uint32_t>(entry);
+      slots_[pos].tag = Tag(hash);
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t mask_ = kMinCapacity - 1;
+  std::vector<TKey> keys_;
+  std::vector<TValue> values_;
+  Hash hash_;
+  Equal equal_;
+};
+
+}  // namespace ml
+}  // namespace onnxruntime
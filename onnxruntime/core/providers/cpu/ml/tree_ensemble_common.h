@@ -8,6 +8,8 @@
 #include "tree_ensemble_helper.h"
 #include "tree_ensemble_attribute.h"
 #include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_flat.h"
+#include "tree_ensemble_quick_scorer.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -53,6 +55,10 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   // `ThresholdType` is used as well for output type (double as well for lightgbm) and not `OutputType`.
   std::vector<SparseValue<ThresholdType>> weights_;
   std::vector<TreeNodeElement<ThresholdType>*> roots_;
+  // Evaluates the trees with bitvectors instead of walking them, if the ensemble allows it and is large enough.
+  std::unique_ptr<TreeEnsembleQuickScorer<ThresholdType>> quick_scorer_;
+  // Compact copy of the trees to walk batches of rows, if the ensemble allows it and the bitvectors don't.
+  std::unique_ptr<TreeEnsembleFlat<ThresholdType>> flat_trees_;
 
  public:
   TreeEnsembleCommon() {}
@@ -72,6 +78,14 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   template <typename AGG>
   void ComputeAgg(concurrency::ThreadPool* ttp, const Tensor* X, Tensor* Y, Tensor* label, const AGG& agg) const;
 
+  template <typename AGG>
+  void ComputeAggFlat(concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride,
+                      OutputType* z_data, int64_t* label_data, const AGG& agg) const;
+
+  template <typename AGG>
+  void ComputeAggQuickScorer(concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride,
+                             OutputType* z_data, int64_t* label_data, const AGG& agg) const;
+
  private:
   bool CheckIfSubtreesAreEqual(const size_t left_id, const size_t right_id, const int64_t tree_id, const InlinedVector<NODE_MODE_ONNX>& cmodes,
                                const InlinedVector<size_t>& truenode_ids, const InlinedVector<size_t>& falsenode_ids, gsl::span<const int64_t> nodes_featureids,
@@ -288,6 +302,11 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(
     }
   }
 
+  quick_scorer_ = TreeEnsembleQuickScorer<ThresholdType>::Create(roots_, has_missing_tracks_);
+  if (quick_scorer_ == nullptr) {
+    flat_trees_ = TreeEnsembleFlat<ThresholdType>::Create(roots_, nodes_.size(), has_missing_tracks_);
+  }
+
   return Status::OK();
 }
 
@@ -481,6 +500,15 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
   int64_t* label_data = label == nullptr ? nullptr : label->MutableData<int64_t>();
   auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
 
+  if (quick_scorer_ != nullptr) {
+    ComputeAggQuickScorer(ttp, x_data, N, stride, z_data, label_data, agg);
+    return;
+  }
+  if (flat_trees_ != nullptr && N >= static_cast<int64_t>(TreeEnsembleFlat<ThresholdType>::kRows)) {
+    ComputeAggFlat(ttp, x_data, N, stride, z_data, label_data, agg);
+    return;
+  }
+
   if (n_targets_or_classes_ == 1) {
     if (N == 1) {
       ScoreValue<ThresholdType> score = {0, 0};
@@ -695,6 +723,133 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
   }
 }  // namespace detail
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename AGG>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAggQuickScorer(
+    concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride, OutputType* z_data,
+    int64_t* label_data, const AGG& agg) const {
+  const auto& scorer = *quick_scorer_;
+  const size_t n_trees = scorer.NumTrees();
+  const size_t n_blocks = scorer.NumBlocks();
+  auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
+
+  // The predictions of the trees are aggregated in the same order as when walking the trees, so that the scores
+  // are the same.
+  auto aggregate = [this, &agg, n_trees](const TreeNodeElement<ThresholdType>* const* leaves, OutputType* z,
+                                         int64_t* label, InlinedVector<ScoreValue<ThresholdType>>& scores) {
+    if (n_targets_or_classes_ == 1) {
+      ScoreValue<ThresholdType> score = {0, 0};
+      for (size_t j = 0; j < n_trees; ++j) {
+        agg.ProcessTreeNodePrediction1(score, *leaves[j]);
+      }
+      agg.FinalizeScores1(z, score, label);
+    } else {
+      std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
+      for (size_t j = 0; j < n_trees; ++j) {
+        agg.ProcessTreeNodePrediction(scores, *leaves[j], weights_);
+      }
+      agg.FinalizeScores(scores, z, -1, label);
+    }
+  };
+
+  if (N == 1 && n_blocks > 1 && max_num_threads > 1) {
+    // one row: the blocks of trees are evaluated in parallel
+    std::vector<const TreeNodeElement<ThresholdType>*> leaves(n_trees);
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        ttp,
+        onnxruntime::narrow<std::ptrdiff_t>(n_blocks),
+        [&scorer, &leaves, x_data](std::ptrdiff_t block) {
+          std::vector<uint64_t> leaf_vectors(TreeEnsembleQuickScorer<ThresholdType>::kBlockSize);
+          scorer.FindLeaves(onnxruntime::narrow<size_t>(block), x_data, leaf_vectors.data(),
+                            leaves.data() + scorer.BlockFirstTree(onnxruntime::narrow<size_t>(block)));
+        });
+    InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_));
+    aggregate(leaves.data(), z_data, label_data, scores);
+    return;
+  }
+
+  // several rows: the rows are evaluated in parallel, a thread evaluates all the trees of its rows
+  auto num_threads = N <= parallel_N_ ? 1 : std::min<int32_t>(max_num_threads, SafeInt<int32_t>(N));
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      ttp,
+      num_threads,
+      [this, &scorer, &aggregate, num_threads, x_data, z_data, label_data, N, stride, n_trees, n_blocks](
+          std::ptrdiff_t batch_num) {
+        std::vector<uint64_t> leaf_vectors(TreeEnsembleQuickScorer<ThresholdType>::kBlockSize);
+        std::vector<const TreeNodeElement<ThresholdType>*> leaves(n_trees);
+        InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_));
+        auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, onnxruntime::narrow<ptrdiff_t>(N));
+        for (auto i = work.start; i < work.end; ++i) {
+          for (size_t block = 0; block < n_blocks; ++block) {
+            scorer.FindLeaves(block, x_data + i * stride, leaf_vectors.data(),
+                              leaves.data() + scorer.BlockFirstTree(block));
+          }
+          aggregate(leaves.data(), z_data + i * n_targets_or_classes_,
+                    label_data == nullptr ? nullptr : (label_data + i), scores);
+        }
+      });
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename AGG>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAggFlat(
+    concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride, OutputType* z_data,
+    int64_t* label_data, const AGG& agg) const {
+  constexpr int64_t kRows = static_cast<int64_t>(TreeEnsembleFlat<ThresholdType>::kRows);
+  const auto& flat_trees = *flat_trees_;
+  const int64_t n_batches = (N + kRows - 1) / kRows;
+  auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
+
+  // The rows are split in batches of kRows rows, every tree is walked for a whole batch at once. The predictions
+  // of the trees are aggregated in the same order as when walking the trees one row at a time.
+  auto num_threads = N <= parallel_N_ ? 1 : std::min<int32_t>(max_num_threads, SafeInt<int32_t>(n_batches));
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      ttp,
+      num_threads,
+      [this, &flat_trees, &agg, num_threads, x_data, z_data, label_data, N, stride, n_batches](
+          std::ptrdiff_t batch_num) {
+        const TreeNodeElement<ThresholdType>* leaves[kRows];
+        std::vector<ScoreValue<ThresholdType>> scores1(kRows);
+        std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(
+            n_targets_or_classes_ == 1 ? 0 : kRows,
+            InlinedVector<ScoreValue<ThresholdType>>(onnxruntime::narrow<size_t>(n_targets_or_classes_)));
+        auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads,
+                                                           onnxruntime::narrow<ptrdiff_t>(n_batches));
+        for (auto batch = work.start; batch < work.end; ++batch) {
+          const int64_t begin = batch * kRows;
+          const size_t n_rows = onnxruntime::narrow<size_t>(N - begin < kRows ? N - begin : kRows);
+          const InputType* x_batch = x_data + begin * stride;
+          if (n_targets_or_classes_ == 1) {
+            std::fill_n(scores1.begin(), n_rows, ScoreValue<ThresholdType>({0, 0}));
+            for (size_t j = 0, n_trees = flat_trees.NumTrees(); j < n_trees; ++j) {
+              flat_trees.FindLeaves(j, x_batch, stride, n_rows, leaves);
+              for (size_t r = 0; r < n_rows; ++r) {
+                agg.ProcessTreeNodePrediction1(scores1[r], *leaves[r]);
+              }
+            }
+            for (size_t r = 0; r < n_rows; ++r) {
+              agg.FinalizeScores1(z_data + begin + r, scores1[r],
+                                  label_data == nullptr ? nullptr : (label_data + begin + r));
+            }
+          } else {
+            for (size_t r = 0; r < n_rows; ++r) {
+              std::fill(scores[r].begin(), scores[r].end(), ScoreValue<ThresholdType>({0, 0}));
+            }
+            for (size_t j = 0, n_trees = flat_trees.NumTrees(); j < n_trees; ++j) {
+              flat_trees.FindLeaves(j, x_batch, stride, n_rows, leaves);
+              for (size_t r = 0; r < n_rows; ++r) {
+                agg.ProcessTreeNodePrediction(scores[r], *leaves[r], weights_);
+              }
+            }
+            for (size_t r = 0; r < n_rows; ++r) {
+              agg.FinalizeScores(scores[r], z_data + (begin + r) * n_targets_or_classes_, -1,
+                                 label_data == nullptr ? nullptr : (label_data + begin + r));
+            }
+          }
+        }
+      });
+}
+
 #define TREE_FIND_VALUE(CMP)                                                                           \
   if (has_missing_tracks_) {                                                                           \
     while (root->is_not_leaf()) {                                                                      \
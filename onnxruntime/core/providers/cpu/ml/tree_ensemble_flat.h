@@ -0,0 +1,250 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_attribute.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+/**
+ * Compact copy of the branches of a tree ensemble for batch scoring.
+ *
+ * The nodes are stored as a structure of arrays with 32-bit fields: feature id, threshold and the position of the
+ * children, the true child being followed by the false child. Leaves have a negative feature id and the position of
+ * their TreeNodeElement, which keeps the weights, in place of the children. Each tree is laid out breadth first over
+ * its top levels, which are visited by every row, and depth first below so that a subtree stays close.
+ *
+ * A tree is walked for a batch of up to kRows rows at once, one level of every row at a time. The walks of the rows
+ * are independent, so the processor overlaps their loads of nodes instead of waiting on each of them in turn.
+ *
+ * Only ensembles whose branches all use the same mode, other than BRANCH_MEMBER, can be stored this way.
+ */
+template <typename ThresholdType>
+class TreeEnsembleFlat {
+ public:
+  // Number of rows walked together.
+  static constexpr size_t kRows = 16;
+
+  // Returns nullptr if the ensemble can't be stored this way.
+  // n_nodes is the number of nodes of the ensemble.
+  static std::unique_ptr<TreeEnsembleFlat> Create(gsl::span<TreeNodeElement<ThresholdType>* const> roots,
+                                                  size_t n_nodes, bool has_missing_tracks);
+
+  size_t NumTrees() const { return roots_.size(); }
+
+  // Finds the leaves of a tree for n_rows <= kRows rows of x_data.
+  template <typename InputType>
+  void FindLeaves(size_t tree, const InputType* x_data, int64_t stride, size_t n_rows,
+                  const TreeNodeElement<ThresholdType>** leaves) const;
+
+ private:
+  // Number of levels laid out breadth first.
+  static constexpr int kBreadthFirstLevels = 6;
+
+  // Appends the nodes of a tree, returns false if it has too many nodes.
+  bool AddTree(const TreeNodeElement<ThresholdType>* root, size_t max_nodes);
+  void SetNode(uint32_t pos, const TreeNodeElement<ThresholdType>* node);
+  uint32_t AddChildren(uint32_t pos, const TreeNodeElement<ThresholdType>* node);
+  bool AddSubtree(uint32_t pos, const TreeNodeElement<ThresholdType>* node, size_t max_nodes);
+
+  template <typename InputType, typename Cmp>
+  void Walk(uint32_t root, const InputType* x_data, int64_t stride, size_t n_rows,
+            const TreeNodeElement<ThresholdType>** leaves, Cmp cmp) const;
+
+  NODE_MODE_ORT mode_;
+  bool mixed_modes_ = false;
+  bool has_missing_tracks_;
+  std::vector<int32_t> feature_ids_;
+  std::vector<ThresholdType> thresholds_;
+  std::vector<uint32_t> children_;
+  std::vector<uint8_t> missing_tracks_true_;
+  std::vector<uint32_t> roots_;
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+};
+
+template <typename ThresholdType>
+void TreeEnsembleFlat<ThresholdType>::SetNode(uint32_t pos, const TreeNodeElement<ThresholdType>* node) {
+  if (node->is_not_leaf()) {
+    mixed_modes_ = mixed_modes_ || node->mode() != mode_;
+    feature_ids_[pos] = node->feature_id;
+    thresholds_[pos] = node->value_or_unique_weight;
+    missing_tracks_true_[pos] = node->is_missing_track_true() ? 1 : 0;
+  } else {
+    feature_ids_[pos] = -1;
+    children_[pos] = static_cast<uint32_t>(leaves_.size());
+    leaves_.push_back(node);
+  }
+}
+
+template <typename ThresholdType>
+uint32_t TreeEnsembleFlat<ThresholdType>::AddChildren(uint32_t pos, const TreeNodeElement<ThresholdType>* node) {
+  const auto first = static_cast<uint32_t>(feature_ids_.size());
+  feature_ids_.resize(first + 2);
+  thresholds_.resize(first + 2);
+  children_.resize(first + 2);
+  missing_tracks_true_.resize(first + 2);
+  children_[pos] = first;
+  SetNode(first, node->truenode_or_weight.ptr);
+  SetNode(first + 1, node + 1);
+  return first;
+}
+
+template <typename ThresholdType>
+bool TreeEnsembleFlat<ThresholdType>::AddSubtree(uint32_t pos, const TreeNodeElement<ThresholdType>* node,
+                                                 size_t max_nodes) {
+  if (!node->is_not_leaf()) {
+    return true;
+  }
+  if (feature_ids_.size() + 2 > max_nodes) {
+    return false;
+  }
+  const uint32_t first = AddChildren(pos, node);
+  return AddSubtree(first, node->truenode_or_weight.ptr, max_nodes) && AddSubtree(first + 1, node + 1, max_nodes);
+}
+
+template <typename ThresholdType>
+bool TreeEnsembleFlat<ThresholdType>::AddTree(const TreeNodeElement<ThresholdType>* root, size_t max_nodes) {
+  struct Pending {
+    uint32_t pos;
+    const TreeNodeElement<ThresholdType>* node;
+    int level;
+  };
+
+  const auto root_pos = static_cast<uint32_t>(feature_ids_.size());
+  feature_ids_.resize(root_pos + 1);
+  thresholds_.resize(root_pos + 1);
+  children_.resize(root_pos + 1);
+  missing_tracks_true_.resize(root_pos + 1);
+  SetNode(root_pos, root);
+  roots_.push_back(root_pos);
+
+  std::deque<Pending> breadth_first{{root_pos, root, 0}};
+  std::vector<Pending> depth_first;
+  while (!breadth_first.empty()) {
+    const Pending pending = breadth_first.front();
+    breadth_first.pop_front();
+    if (!pending.node->is_not_leaf()) {
+      continue;
+    }
+    if (pending.level >= kBreadthFirstLevels) {
+      depth_first.push_back(pending);
+      continue;
+    }
+    if (feature_ids_.size() + 2 > max_nodes) {
+      return false;
+    }
+    const uint32_t first = AddChildren(pending.pos, pending.node);
+    breadth_first.push_back({first, pending.node->truenode_or_weight.ptr, pending.level + 1});
+    breadth_first.push_back({first + 1, pending.node + 1, pending.level + 1});
+  }
+
+  for (const auto& pending : depth_first) {
+    if (!AddSubtree(pending.pos, pending.node, max_nodes)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename ThresholdType>
+std::unique_ptr<TreeEnsembleFlat<ThresholdType>> TreeEnsembleFlat<ThresholdType>::Create(
+    gsl::span<TreeNodeElement<ThresholdType>* const> roots, size_t n_nodes, bool has_missing_tracks) {
+  NODE_MODE_ORT mode = NODE_MODE_ORT::LEAF;
+  for (const auto* root : roots) {
+    if (root->is_not_leaf()) {
+      mode = root->mode();
+      break;
+    }
+  }
+  if (mode == NODE_MODE_ORT::LEAF || mode == NODE_MODE_ORT::BRANCH_MEMBER) {
+    return nullptr;
+  }
+
+  // The subtrees shared by several nodes are copied, bound the growth this may cause.
+  const size_t max_nodes = std::min<size_t>(4 * n_nodes, std::numeric_limits<uint32_t>::max());
+
+  auto flat = std::make_unique<TreeEnsembleFlat>();
+  flat->mode_ = mode;
+  flat->has_missing_tracks_ = has_missing_tracks;
+  flat->roots_.reserve(roots.size());
+  for (const auto* root : roots) {
+    if (!flat->AddTree(root, max_nodes) || flat->mixed_modes_) {
+      return nullptr;
+    }
+  }
+  return flat;
+}
+
+template <typename ThresholdType>
+template <typename InputType, typename Cmp>
+void TreeEnsembleFlat<ThresholdType>::Walk(uint32_t root, const InputType* x_data, int64_t stride, size_t n_rows,
+                                           const TreeNodeElement<ThresholdType>** leaves, Cmp cmp) const {
+  uint32_t pos[kRows];
+  std::fill_n(pos, n_rows, root);
+
+  const int32_t* feature_ids = feature_ids_.data();
+  const ThresholdType* thresholds = thresholds_.data();
+  const uint32_t* children = children_.data();
+  bool active = true;
+  while (active) {
+    active = false;
+    for (size_t r = 0; r < n_rows; ++r) {
+      const uint32_t p = pos[r];
+      const int32_t feature_id = feature_ids[p];
+      if (feature_id >= 0) {
+        const InputType val = x_data[r * stride + feature_id];
+        const bool is_true = cmp(val, thresholds[p]) ||
+                             (has_missing_tracks_ && missing_tracks_true_[p] && _isnan_(val));
+        pos[r] = children[p] + (is_true ? 0 : 1);
+        active = true;
+      }
+    }
+  }
+
+  for (size_t r = 0; r < n_rows; ++r) {
+    leaves[r] = leaves_[children[pos[r]]];
+  }
+}
+
+template <typename ThresholdType>
+template <typename InputType>
+void TreeEnsembleFlat<ThresholdType>::FindLeaves(size_t tree, const InputType* x_data, int64_t stride,
+                                                 size_t n_rows, const TreeNodeElement<ThresholdType>** leaves) const {
+  const uint32_t root = roots_[tree];
+  switch (mode_) {
+    case NODE_MODE_ORT::BRANCH_LEQ:
+      Walk(root, x_data, stride, n_rows, leaves, [](InputType val, ThresholdType t) { return val <= t; });
+      break;
+    case NODE_MODE_ORT::BRANCH_LT:
+      Walk(root, x_data, stride, n_rows, leaves, [](InputType val, ThresholdType t) { return val < t; });
+      break;
+    case NODE_MODE_ORT::BRANCH_GTE:
+      Walk(root, x_data, stride, n_rows, leaves, [](InputType val, ThresholdType t) { return val >= t; });
+      break;
+    case NODE_MODE_ORT::BRANCH_GT:
+      Walk(root, x_data, stride, n_rows, leaves, [](InputType val, ThresholdType t) { return val > t; });
+      break;
+    case NODE_MODE_ORT::BRANCH_EQ:
+      Walk(root, x_data, stride, n_rows, leaves, [](InputType val, ThresholdType t) { return val == t; });
+      break;
+    case NODE_MODE_ORT::BRANCH_NEQ:
+      Walk(root, x_data, stride, n_rows, leaves, [](InputType val, ThresholdType t) { return val != t; });
+      break;
+    default:
+      ORT_THROW("Unexpected mode for a flat tree ensemble.");
+  }
+}
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
@@ -0,0 +1,286 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_attribute.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+inline int QuickScorerExitLeaf(uint64_t leaf_vector) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, leaf_vector);
+  return static_cast<int>(index);
+#elif defined(_MSC_VER)
+  int index = 0;
+  while ((leaf_vector & 1) == 0) {
+    leaf_vector >>= 1;
+    ++index;
+  }
+  return index;
+#else
+  return __builtin_ctzll(leaf_vector);
+#endif
+}
+
+/**
+ * Evaluation of tree ensembles with bitvectors as in QuickScorer (Lucchese et al., SIGIR 2015).
+ *
+ * The leaves of every tree are numbered from left to right, the left child of a node being the one taken
+ * when the condition is true. Each node gets a mask of the leaves that remain reachable when its condition is false,
+ * which excludes the leaves of its true subtree. To evaluate a row, the bitvector of every tree starts with all the
+ * leaves, and the masks of all the nodes whose condition is false are applied. The exit leaf of the tree is then
+ * the leftmost remaining leaf.
+ *
+ * The nodes are grouped by feature and sorted by threshold, so that for each feature the false nodes are a prefix
+ * of the list: the evaluation scans contiguous thresholds instead of following node pointers, which avoids most of
+ * the cache misses and branch mispredictions. The trees are split in blocks so that the bitvectors and threshold lists of a block stay
+ * in cache.
+ *
+ * Only ensembles whose branches all use BRANCH_LEQ or all use BRANCH_LT and whose trees have at most 64 leaves
+ * can be evaluated this way.
+ */
+template <typename ThresholdType>
+class TreeEnsembleQuickScorer {
+ public:
+  // Number of trees of a block.
+  static constexpr size_t kBlockSize = 256;
+
+  // Returns nullptr if the ensemble can't be evaluated with bitvectors, or if it is too small for it to pay off
+  // compared to walking the trees.
+  static std::unique_ptr<TreeEnsembleQuickScorer> Create(gsl::span<TreeNodeElement<ThresholdType>* const> roots,
+                                                         bool has_missing_tracks);
+
+  size_t NumBlocks() const { return blocks_.size(); }
+
+  size_t NumTrees() const { return leaf_offsets_.size() - 1; }
+
+  // First tree and number of trees of a block.
+  size_t BlockFirstTree(size_t block) const { return blocks_[block].first_tree; }
+  size_t BlockNumTrees(size_t block) const { return blocks_[block].n_trees; }
+
+  // Finds the exit leaves of the trees of a block for a row.
+  // leaf_vectors is a scratch buffer of kBlockSize elements. leaves receives BlockNumTrees(block) elements.
+  template <typename InputType>
+  void FindLeaves(size_t block, const InputType* x_data, uint64_t* leaf_vectors,
+                  const TreeNodeElement<ThresholdType>** leaves) const;
+
+ private:
+  struct Block {
+    size_t first_tree;
+    size_t n_trees;
+    // Nodes of feature f are in [feature_offsets[f], feature_offsets[f + 1]), sorted by threshold.
+    std::vector<uint32_t> feature_offsets;
+    std::vector<ThresholdType> thresholds;
+    std::vector<uint32_t> tree_ids;  // relative to first_tree
+    std::vector<uint64_t> masks;
+    // Same for the nodes whose condition is false on a missing value, only built with missing tracks.
+    std::vector<uint32_t> nan_feature_offsets;
+    std::vector<uint32_t> nan_tree_ids;
+    std::vector<uint64_t> nan_masks;
+  };
+
+  struct FalseNode {
+    int feature_id;
+    ThresholdType threshold;
+    uint32_t tree_id;
+    uint64_t mask;
+    bool missing_track_true;
+  };
+
+  // Numbers the leaves of a tree and computes the masks of its nodes. Returns false if the tree has more than
+  // 64 leaves or a node uses another mode. A subtree reached from two nodes is numbered twice, as if it were copied.
+  static bool AddTree(const TreeNodeElement<ThresholdType>* node, NODE_MODE_ORT mode, uint32_t tree_id, int depth,
+                      std::vector<const TreeNodeElement<ThresholdType>*>& leaves, size_t first_leaf,
+                      std::vector<FalseNode>& false_nodes);
+
+  bool strict_;  // BRANCH_LEQ: the condition is false if threshold < x, BRANCH_LT: if threshold <= x
+  bool has_missing_tracks_;
+  std::vector<Block> blocks_;
+  // Leaves of tree t are in [leaf_offsets_[t], leaf_offsets_[t + 1]), from left to right.
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+  std::vector<size_t> leaf_offsets_;
+};
+
+template <typename ThresholdType>
+bool TreeEnsembleQuickScorer<ThresholdType>::AddTree(const TreeNodeElement<ThresholdType>* node, NODE_MODE_ORT mode,
+                                                     uint32_t tree_id, int depth,
+                                                     std::vector<const TreeNodeElement<ThresholdType>*>& leaves,
+                                                     size_t first_leaf, std::vector<FalseNode>& false_nodes) {
+  // a tree with at most 64 leaves is at most 63 levels deep
+  if (depth > 63) {
+    return false;
+  }
+  if (!node->is_not_leaf()) {
+    if (leaves.size() - first_leaf >= 64) {
+      return false;
+    }
+    leaves.push_back(node);
+    return true;
+  }
+  if (node->mode() != mode) {
+    return false;
+  }
+
+  const size_t true_first_leaf = leaves.size();
+  if (!AddTree(node->truenode_or_weight.ptr, mode, tree_id, depth + 1, leaves, first_leaf, false_nodes)) {
+    return false;
+  }
+  const size_t true_end_leaf = leaves.size();
+  if (!AddTree(node + 1, mode, tree_id, depth + 1, leaves, first_leaf, false_nodes)) {
+    return false;
+  }
+
+  // The false subtree has at least one leaf, so the true subtree has at most 63.
+  const size_t shift = true_first_leaf - first_leaf;
+  const uint64_t true_leaves = ((uint64_t{1} << (true_end_leaf - true_first_leaf)) - 1) << shift;
+  false_nodes.push_back({node->feature_id, node->value_or_unique_weight, tree_id, ~true_leaves,
+                         node->is_missing_track_true()});
+  return true;
+}
+
+template <typename ThresholdType>
+std::unique_ptr<TreeEnsembleQuickScorer<ThresholdType>> TreeEnsembleQuickScorer<ThresholdType>::Create(
+    gsl::span<TreeNodeElement<ThresholdType>* const> roots, bool has_missing_tracks) {
+  // Below these sizes, walking the trees is about as fast and avoids the memory of the threshold lists.
+  constexpr size_t kMinTrees = 16;
+  constexpr size_t kMinLeaves = 8 * kMinTrees;
+
+  if (roots.size() < kMinTrees) {
+    return nullptr;
+  }
+
+  NODE_MODE_ORT mode = NODE_MODE_ORT::LEAF;
+  for (const auto* root : roots) {
+    if (root->is_not_leaf()) {
+      mode = root->mode();
+      break;
+    }
+  }
+  if (mode != NODE_MODE_ORT::BRANCH_LEQ && mode != NODE_MODE_ORT::BRANCH_LT) {
+    return nullptr;
+  }
+
+  auto scorer = std::make_unique<TreeEnsembleQuickScorer>();
+  scorer->strict_ = mode == NODE_MODE_ORT::BRANCH_LEQ;
+  scorer->has_missing_tracks_ = has_missing_tracks;
+  scorer->leaf_offsets_.reserve(roots.size() + 1);
+  scorer->leaf_offsets_.push_back(0);
+
+  std::vector<FalseNode> false_nodes;
+  for (size_t first_tree = 0; first_tree < roots.size(); first_tree += kBlockSize) {
+    Block block;
+    block.first_tree = first_tree;
+    block.n_trees = std::min(kBlockSize, roots.size() - first_tree);
+
+    false_nodes.clear();
+    for (size_t t = 0; t < block.n_trees; ++t) {
+      const size_t first_leaf = scorer->leaves_.size();
+      if (!AddTree(roots[first_tree + t], mode, static_cast<uint32_t>(t), 0, scorer->leaves_, first_leaf,
+                   false_nodes)) {
+        return nullptr;
+      }
+      scorer->leaf_offsets_.push_back(scorer->leaves_.size());
+    }
+
+    // group the nodes by feature, by increasing threshold
+    std::sort(false_nodes.begin(), false_nodes.end(), [](const FalseNode& a, const FalseNode& b) {
+      return a.feature_id != b.feature_id ? a.feature_id < b.feature_id : a.threshold < b.threshold;
+    });
+    const int n_features = false_nodes.empty() ? 0 : false_nodes.back().feature_id + 1;
+    block.feature_offsets.assign(static_cast<size_t>(n_features) + 1, 0);
+    block.thresholds.reserve(false_nodes.size());
+    block.tree_ids.reserve(false_nodes.size());
+    block.masks.reserve(false_nodes.size());
+    for (const auto& false_node : false_nodes) {
+      ++block.feature_offsets[static_cast<size_t>(false_node.feature_id) + 1];
+      block.thresholds.push_back(false_node.threshold);
+      block.tree_ids.push_back(false_node.tree_id);
+      block.masks.push_back(false_node.mask);
+    }
+    for (size_t f = 1; f < block.feature_offsets.size(); ++f) {
+      block.feature_offsets[f] += block.feature_offsets[f - 1];
+    }
+
+    if (has_missing_tracks) {
+      block.nan_feature_offsets.assign(static_cast<size_t>(n_features) + 1, 0);
+      for (const auto& false_node : false_nodes) {
+        if (!false_node.missing_track_true) {
+          ++block.nan_feature_offsets[static_cast<size_t>(false_node.feature_id) + 1];
+          block.nan_tree_ids.push_back(false_node.tree_id);
+          block.nan_masks.push_back(false_node.mask);
+        }
+      }
+      for (size_t f = 1; f < block.nan_feature_offsets.size(); ++f) {
+        block.nan_feature_offsets[f] += block.nan_feature_offsets[f - 1];
+      }
+    }
+
+    scorer->blocks_.push_back(std::move(block));
+  }
+
+  if (scorer->leaves_.size() < kMinLeaves) {
+    return nullptr;
+  }
+  return scorer;
+}
+
+template <typename ThresholdType>
+template <typename InputType>
+void TreeEnsembleQuickScorer<ThresholdType>::FindLeaves(size_t block_index, const InputType* x_data,
+                                                        uint64_t* leaf_vectors,
+                                                        const TreeNodeElement<ThresholdType>** leaves) const {
+  const Block& block = blocks_[block_index];
+  std::fill_n(leaf_vectors, block.n_trees, ~uint64_t{0});
+
+  const size_t n_features = block.feature_offsets.size() - 1;
+  for (size_t f = 0; f < n_features; ++f) {
+    const InputType val = x_data[f];
+    if (_isnan_(val)) {
+      // every condition is false on a missing value, except for the nodes tracking missing values on the true side
+      if (has_missing_tracks_) {
+        for (uint32_t k = block.nan_feature_offsets[f], end = block.nan_feature_offsets[f + 1]; k < end; ++k) {
+          leaf_vectors[block.nan_tree_ids[k]] &= block.nan_masks[k];
+        }
+      } else {
+        for (uint32_t k = block.feature_offsets[f], end = block.feature_offsets[f + 1]; k < end; ++k) {
+          leaf_vectors[block.tree_ids[k]] &= block.masks[k];
+        }
+      }
+      continue;
+    }
+
+    uint32_t k = block.feature_offsets[f];
+    const uint32_t end = block.feature_offsets[f + 1];
+    if (strict_) {
+      for (; k < end && block.thresholds[k] < val; ++k) {
+        leaf_vectors[block.tree_ids[k]] &= block.masks[k];
+      }
+    } else {
+      for (; k < end && block.thresholds[k] <= val; ++k) {
+        leaf_vectors[block.tree_ids[k]] &= block.masks[k];
+      }
+    }
+  }
+
+  const auto* tree_leaves = leaves_.data();
+  for (size_t t = 0; t < block.n_trees; ++t) {
+    leaves[t] = tree_leaves[leaf_offsets_[block.first_tree + t] + QuickScorerExitLeaf(leaf_vectors[t])];
+  }
+}
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
@@ -9,6 +9,7 @@
 #include "core/platform/threadpool.h"
 
 #include <functional>
+#include <limits>
 #include <string_view>
 
 namespace onnxruntime {
@@ -25,66 +26,123 @@ ONNX_CPU_OPERATOR_KERNEL(
 
 namespace ngram_details {
 
-// NgrampPart implements a Trie like structure
-// for a unigram (1) it would insert into a root map with a valid id.
-// for (1,2,3) node 2 would be a child of 1 but have id == 0
-// because (1,2) does not exists. Node 3 would have a valid id.
-template <class T>
-struct NgramPart;
+#ifndef DISABLE_ABSEIL
+using StrSymbolMap = absl::flat_hash_map<std::reference_wrapper<const std::string>, uint32_t,
+                                         std::hash<std::string>, std::equal_to<std::string>>;
+#else
+using StrSymbolMap = std::unordered_map<std::reference_wrapper<const std::string>, uint32_t,
+                                        std::hash<std::string>, std::equal_to<std::string>>;
+#endif
 
-template <>
-struct NgramPart<int64_t>;
+using IntSymbolMap = InlinedHashMap<int64_t, uint32_t>;
+
+// Symbol of the items which are not in the pool.
+constexpr uint32_t kUnknownSymbol = std::numeric_limits<uint32_t>::max();
+
+// Aho-Corasick automaton over the n-grams of the pool.
+// The items of the pool are numbered (symbols), the n-grams are inserted in a trie of symbols and each
+// node gets a failure link to the node of its longest proper suffix present in the trie, and an output link
+// to the node of its longest proper suffix which is an n-gram of the pool. A sequence is then scanned once,
+// following the failure links on mismatches, and at every position the n-grams ending there are found by
+// following the output links. The cost is linear in the length of the sequence plus the number of matches,
+// instead of walking the trie from every position.
+class NgramAutomaton {
+ public:
+  static constexpr uint32_t kRoot = 0;
+
+  NgramAutomaton() : fail_(1, kRoot), output_(1, kRoot), ngram_id_(1, 0), depth_(1, 0) {}
+
+  bool Empty() const { return num_ngrams_ == 0; }
+
+  // Inserts an n-gram with id > 0.
+  void AddNgram(gsl::span<const uint32_t> symbols, size_t ngram_id) {
+    uint32_t node = kRoot;
+    for (uint32_t symbol : symbols) {
+      auto p = transitions_.emplace(Key(node, symbol), static_cast<uint32_t>(ngram_id_.size()));
+      if (p.second) {
+        fail_.push_back(kRoot);
+        output_.push_back(kRoot);
+        ngram_id_.push_back(0);
+        depth_.push_back(depth_[node] + 1);
+      }
+      node = p.first->second;
+    }
+    ORT_ENFORCE(ngram_id_[node] == 0, "Duplicate ngram detected, size: ", symbols.size(), " id: ", ngram_id);
+    ngram_id_[node] = ngram_id;
+    ++num_ngrams_;
+  }
 
-template <>
-struct NgramPart<std::string>;
+  // Computes the failure and output links once all the n-grams are inserted.
+  void Build() {
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> children(ngram_id_.size());
+    for (const auto& transition : transitions_) {
+      children[static_cast<uint32_t>(transition.first >> 32)].emplace_back(static_cast<uint32_t>(transition.first),
+                                                                           transition.second);
+    }
 
-using NgramPartInt = NgramPart<int64_t>;
-using NgramPartString = NgramPart<std::string>;
+    // breadth first, so the links of shorter suffixes are known
+    std::vector<uint32_t> queue{kRoot};
+    for (size_t q = 0; q < queue.size(); ++q) {
+      const uint32_t parent = queue[q];
+      for (const auto& [symbol, child] : children[parent]) {
+        fail_[child] = parent == kRoot ? kRoot : Next(fail_[parent], symbol);
+        const uint32_t suffix = fail_[child];
+        output_[child] = ngram_id_[suffix] != 0 ? suffix : output_[suffix];
+        queue.push_back(child);
+      }
+    }
+  }
 
-// Avoid recursive class definitions using unique_ptr + forward declaration
-using IntMap = InlinedHashMap<int64_t, std::unique_ptr<NgramPartInt>>;
+  // Returns the state after reading symbol in state.
+  uint32_t Next(uint32_t state, uint32_t symbol) const {
+    if (symbol == kUnknownSymbol) {
+      return kRoot;
+    }
+    while (true) {
+      auto hit = transitions_.find(Key(state, symbol));
+      if (hit != transitions_.end()) {
+        return hit->second;
+      }
+      if (state == kRoot) {
+        return kRoot;
+      }
+      state = fail_[state];
+    }
+  }
 
-#ifndef DISABLE_ABSEIL
-using StrMap = absl::flat_hash_map<std::reference_wrapper<const std::string>, std::unique_ptr<NgramPartString>,
-                                   std::hash<std::string>, std::equal_to<std::string>>;
-#else
-using StrMap = std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<NgramPartString>,
-                                  std::hash<std::string>, std::equal_to<std::string>>;
-#endif
+  // Calls fn(ngram_id) for the n-grams of at least min_length items ending in state.
+  template <typename Fn>
+  void ForEachMatch(uint32_t state, size_t min_length, Fn&& fn) const {
+    for (uint32_t node = ngram_id_[state] != 0 ? state : output_[state]; node != kRoot; node = output_[node]) {
+      if (depth_[node] >= min_length) {
+        fn(ngram_id_[node]);
+      }
+    }
+  }
 
-template <>
-struct NgramPart<int64_t> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  IntMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
-};
+ private:
+  static uint64_t Key(uint32_t node, uint32_t symbol) { return (uint64_t{node} << 32) | symbol; }
 
-template <>
-struct NgramPart<std::string> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  StrMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
+  InlinedHashMap<uint64_t, uint32_t> transitions_;
+  std::vector<uint32_t> fail_;
+  std::vector<uint32_t> output_;
+  std::vector<size_t> ngram_id_;  // 0 - the node is not an n-gram of the pool
+  std::vector<uint32_t> depth_;
+  size_t num_ngrams_ = 0;
 };
 
-// Returns next ngram_id
-template <class K, class ForwardIter, class Map>
+// Inserts the n-grams of the pool items [first, first + ngrams * ngram_size), numbering their items
+// with GetSymbol. Returns next ngram_id.
+template <class ForwardIter, class GetSymbol>
 inline size_t PopulateGrams(ForwardIter first, size_t ngrams, size_t ngram_size, size_t ngram_id,
-                            Map& c) {
+                            GetSymbol&& get_symbol, NgramAutomaton& automaton) {
+  InlinedVector<uint32_t> symbols(ngram_size);
   for (; ngrams > 0; --ngrams) {
-    size_t n = 1;
-    Map* m = &c;
-    while (true) {
-      auto p = m->emplace(*first, std::make_unique<NgramPart<K>>(0));
-      ++first;
-      if (n == ngram_size) {
-        ORT_ENFORCE(p.first->second->id_ == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
-        p.first->second->id_ = ngram_id;
-        ++ngram_id;
-        break;
-      }
-      ++n;
-      m = &p.first->second->leafs_;
+    for (size_t n = 0; n < ngram_size; ++n, ++first) {
+      symbols[n] = get_symbol(*first);
     }
+    automaton.AddNgram(symbols, ngram_id);
+    ++ngram_id;
   }
   return ngram_id;
 }
@@ -134,11 +192,15 @@ struct TfIdfVectorizer::Impl {
   gsl::span<const int64_t> ngram_indexes_;
   gsl::span<const float> weights_;
 
+  // Symbols of the pool items, only one of them is populated.
   // This map contains references to pool_string_ entries
   // of pool_strings attribute
-  StrMap str_map_;
+  StrSymbolMap str_symbols_;
   // This map contains pool_int64s entries
-  IntMap int64_map_;
+  IntSymbolMap int64_symbols_;
+  bool pool_is_string_ = false;
+
+  NgramAutomaton automaton_;
 
   size_t output_size_ = 0;
 
@@ -241,9 +303,21 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
       // Skip loading into hash_set ngrams that are not in the range of [min_gram_length-max_gram_length]
       if (ngram_size >= min_gram_length && ngram_size <= max_gram_length) {
         if (pool_strings.empty()) {
-          ngram_id = PopulateGrams<int64_t>(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->int64_map_);
+          auto& symbols = impl_->int64_symbols_;
+          ngram_id = PopulateGrams(
+              pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id,
+              [&symbols](int64_t item) {
+                return symbols.emplace(item, static_cast<uint32_t>(symbols.size())).first->second;
+              },
+              impl_->automaton_);
         } else {
-          ngram_id = PopulateGrams<std::string>(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->str_map_);
+          auto& symbols = impl_->str_symbols_;
+          ngram_id = PopulateGrams(
+              pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id,
+              [&symbols](std::reference_wrapper<const std::string> item) {
+                return symbols.emplace(item, static_cast<uint32_t>(symbols.size())).first->second;
+              },
+              impl_->automaton_);
         }
       } else {
         ngram_id += ngrams;
@@ -251,73 +325,57 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
     }
     ++ngram_size;
   }
+  impl_->pool_is_string_ = !pool_strings.empty();
+  impl_->automaton_.Build();
 }
 
 TfIdfVectorizer::~TfIdfVectorizer() = default;
 
 void TfIdfVectorizer::ComputeImpl(const void* x_data_raw, size_t elem_size, ptrdiff_t row_num, size_t row_size,
                                   bool is_input_string, gsl::span<float> output_data,
-                                  std::function<void(size_t, gsl::span<float>&)>& fn_weight) const {
+                                  std::function<void(size_t, gsl::span<float>&)>& fn_weight,
+                                  std::vector<uint32_t>& symbols) const {
   const void* const row_begin = AdvanceElementPtr(x_data_raw, row_num * row_size, elem_size);
-  const void* const row_end = AdvanceElementPtr(row_begin, row_size, elem_size);
 
   const auto& impl = *impl_;
-  const auto max_gram_length = impl.max_gram_length_;
-  const auto max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
-  auto start_ngram_size = impl.min_gram_length_;
-  size_t output_idx;
-
-  for (auto skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
-    auto ngram_start = row_begin;
-    auto const ngram_row_end = row_end;
-
-    while (ngram_start < ngram_row_end) {
-      // We went far enough so no n-grams of any size can be gathered
-      auto at_least_this = AdvanceElementPtr(ngram_start, SafeInt<size_t>(skip_distance) * (start_ngram_size - 1), elem_size);
-      if (at_least_this >= ngram_row_end) {
-        break;
-      }
+  const size_t max_gram_length = onnxruntime::narrow<size_t>(impl.max_gram_length_);
+  const size_t max_skip_distance = onnxruntime::narrow<size_t>(impl.max_skip_count_ + 1);  // Convert to distance
+  size_t start_ngram_size = onnxruntime::narrow<size_t>(impl.min_gram_length_);
+
+  // Look up each item once, the items which are not in the pool break all the n-grams going through them.
+  symbols.resize(row_size);
+  if (is_input_string) {
+    const std::string* str_items = reinterpret_cast<const std::string*>(row_begin);
+    for (size_t i = 0; i < row_size; ++i) {
+      auto hit = impl.str_symbols_.find(str_items[i]);
+      symbols[i] = hit == impl.str_symbols_.end() ? kUnknownSymbol : hit->second;
+    }
+  } else {
+    for (size_t i = 0; i < row_size; ++i) {
+      const void* item = AdvanceElementPtr(row_begin, i, elem_size);
+      int64_t val = (elem_size == 4) ? int64_t{*reinterpret_cast<const int32_t*>(item)} : *reinterpret_cast<const int64_t*>(item);
+      auto hit = impl.int64_symbols_.find(val);
+      symbols[i] = hit == impl.int64_symbols_.end() ? kUnknownSymbol : hit->second;
+    }
+  }
 
-      auto ngram_item = ngram_start;
-      if (is_input_string) {
-        const std::string* str_item = reinterpret_cast<const std::string*>(ngram_item);
-        const StrMap* str_map = &impl.str_map_;
-        for (auto ngram_size = 1;
-             !str_map->empty() &&
-             ngram_size <= max_gram_length &&
-             str_item < ngram_row_end;
-             ++ngram_size, str_item += skip_distance) {
-          auto hit = str_map->find(*str_item);
-          if (hit == str_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            output_idx = impl.OutputIdToIncrement(hit->second->id_);
-            fn_weight(output_idx, output_data);
-          }
-          str_map = &hit->second->leafs_;
-        }
-      } else {
-        const IntMap* int_map = &impl.int64_map_;
-        for (auto ngram_size = 1;
-             !int_map->empty() &&
-             ngram_size <= max_gram_length &&
-             ngram_item < ngram_row_end;
-             ++ngram_size, ngram_item = AdvanceElementPtr(ngram_item, skip_distance, elem_size)) {
-          int64_t val = (elem_size == 4) ? int64_t{*reinterpret_cast<const int32_t*>(ngram_item)} : *reinterpret_cast<const int64_t*>(ngram_item);
-          auto hit = int_map->find(val);
-          if (hit == int_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            output_idx = impl.OutputIdToIncrement(hit->second->id_);
-            fn_weight(output_idx, output_data);
-          }
-          int_map = &hit->second->leafs_;
-        }
+  const auto increment = [&](size_t ngram_id) {
+    fn_weight(impl.OutputIdToIncrement(ngram_id), output_data);
+  };
+
+  // The n-grams with skip distance d are the contiguous n-grams of the d subsequences
+  // made of every d-th item, each of them is scanned once.
+  for (size_t skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
+    // We went far enough so no n-grams of any size can be gathered
+    if (skip_distance * (start_ngram_size - 1) >= row_size) {
+      break;
+    }
+    for (size_t offset = 0; offset < skip_distance; ++offset) {
+      uint32_t state = NgramAutomaton::kRoot;
+      for (size_t i = offset; i < row_size; i += skip_distance) {
+        state = impl.automaton_.Next(state, symbols[i]);
+        impl.automaton_.ForEachMatch(state, start_ngram_size, increment);
       }
-      // Sliding window shift
-      ngram_start = AdvanceElementPtr(ngram_start, 1, elem_size);
     }
     // We count UniGrams only once since they are not affected
     // by skip distance
@@ -372,9 +430,7 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
   auto output_data = Y->MutableData<float>();
   const bool is_input_string = X->IsDataTypeString();
 
-  if (total_items == 0 ||
-      (is_input_string && impl_->str_map_.empty()) ||
-      ((X->IsDataType<int32_t>() || X->IsDataType<int64_t>()) && impl_->int64_map_.empty())) {
+  if (total_items == 0 || impl.automaton_.Empty() || is_input_string != impl.pool_is_string_) {
     // TfidfVectorizer may receive an empty input when it follows a Tokenizer
     // (for example for a string containing only stopwords).
     // TfidfVectorizer returns a zero tensor of shape
@@ -418,10 +474,11 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
                                        is_input_string, num_batches, num_rows, &fn_weight](ptrdiff_t batch_num) {
     // Frequency holder allocate [B..output_size_] and init all to zero.
     auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_batches, static_cast<size_t>(num_rows));
+    std::vector<uint32_t> symbols;
     for (auto row_num = work.start; row_num < work.end; ++row_num) {
       auto out = gsl::span<float>(output_data + row_num * this->impl_->output_size_, this->impl_->output_size_);
       std::fill(out.begin(), out.end(), 0.0f);
-      ComputeImpl(x_data_raw, elem_size, row_num, C, is_input_string, out, fn_weight);
+      ComputeImpl(x_data_raw, elem_size, row_num, C, is_input_string, out, fn_weight, symbols);
     }
   };
 
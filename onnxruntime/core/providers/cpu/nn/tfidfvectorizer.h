@@ -19,8 +19,10 @@ class TfIdfVectorizer final : public OpKernel {
   Status Compute(OpKernelContext* ctx) const override;
 
  private:
+  // symbols is a scratch buffer for the symbols of the row items.
   void ComputeImpl(const void* x_data_raw, size_t elem_size, ptrdiff_t row_num, size_t row_size, bool is_input_string,
-                   gsl::span<float> output_data, std::function<void(size_t, gsl::span<float>&)>& fn_weight) const;
+                   gsl::span<float> output_data, std::function<void(size_t, gsl::span<float>&)>& fn_weight,
+                   std::vector<uint32_t>& symbols) const;
 
   struct Impl;
   std::unique_ptr<Impl> impl_;
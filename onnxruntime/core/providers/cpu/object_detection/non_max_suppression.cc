@@ -15,8 +15,10 @@ limitations under the License.
 
 #include <queue>
 #include <utility>
+#include <vector>
 
 #include "core/common/narrow.h"
+#include "core/platform/threadpool.h"
 #include "non_max_suppression_helper.h"
 
 // TODO:fix the warnings
@@ -41,7 +43,106 @@ ONNX_OPERATOR_KERNEL_EX(
     KernelDefBuilder(),
     NonMaxSuppression);
 
-using namespace nms_helpers;
+namespace {
+
+// Corners and areas of boxes, one array per field, so that the overlap of a box with many others is computed by
+// a loop the compiler can vectorize.
+struct BoxCorners {
+  void Resize(size_t n) {
+    x_min.resize(n);
+    y_min.resize(n);
+    x_max.resize(n);
+    y_max.resize(n);
+    area.resize(n);
+  }
+
+  void Set(size_t i, float box_x_min, float box_y_min, float box_x_max, float box_y_max) {
+    x_min[i] = box_x_min;
+    y_min[i] = box_y_min;
+    x_max[i] = box_x_max;
+    y_max[i] = box_y_max;
+    area[i] = (box_x_max - box_x_min) * (box_y_max - box_y_min);
+  }
+
+  void CopyFrom(const BoxCorners& other, size_t other_i, size_t i) {
+    x_min[i] = other.x_min[other_i];
+    y_min[i] = other.y_min[other_i];
+    x_max[i] = other.x_max[other_i];
+    y_max[i] = other.y_max[other_i];
+    area[i] = other.area[other_i];
+  }
+
+  std::vector<float> x_min;
+  std::vector<float> y_min;
+  std::vector<float> x_max;
+  std::vector<float> y_max;
+  std::vector<float> area;
+};
+
+// Computes the corners of the boxes the same way as nms_helpers::SuppressByIOU.
+void ComputeBoxCorners(const float* boxes_data, size_t num_boxes, int64_t center_point_box, BoxCorners& corners) {
+  corners.Resize(num_boxes);
+  for (size_t i = 0; i < num_boxes; ++i) {
+    const float* box = boxes_data + 4 * i;
+    if (0 == center_point_box) {
+      // boxes data format [y1, x1, y2, x2]
+      float x_min, x_max, y_min, y_max;
+      nms_helpers::MaxMin(box[1], box[3], x_min, x_max);
+      nms_helpers::MaxMin(box[0], box[2], y_min, y_max);
+      corners.Set(i, x_min, y_min, x_max, y_max);
+    } else {
+      // boxes data format [x_center, y_center, width, height]
+      const float width_half = box[2] / 2;
+      const float height_half = box[3] / 2;
+      corners.Set(i, box[0] - width_half, box[1] - height_half, box[0] + width_half, box[1] + height_half);
+    }
+  }
+}
+
+// Returns true if the IoU of box i of boxes with one of the first num_selected boxes of selected exceeds
+// iou_threshold, with the same conditions and operations as nms_helpers::SuppressByIOU. The selected boxes are
+// checked in blocks without branches, stopping after the first block which suppresses the box.
+bool SuppressBySelectedBoxes(const BoxCorners& boxes, size_t i, const BoxCorners& selected, size_t num_selected,
+                             float iou_threshold) {
+  constexpr size_t kBlockSize = 16;
+
+  const float x1_min = boxes.x_min[i];
+  const float y1_min = boxes.y_min[i];
+  const float x1_max = boxes.x_max[i];
+  const float y1_max = boxes.y_max[i];
+  const float area1 = boxes.area[i];
+  const float* x2_min = selected.x_min.data();
+  const float* y2_min = selected.y_min.data();
+  const float* x2_max = selected.x_max.data();
+  const float* y2_max = selected.y_max.data();
+  const float* area2 = selected.area.data();
+
+  for (size_t begin = 0; begin < num_selected; begin += kBlockSize) {
+    const size_t end = std::min(num_selected, begin + kBlockSize);
+    int suppressed = 0;
+    for (size_t j = begin; j < end; ++j) {
+      const float intersection_x_min = std::max(x1_min, x2_min[j]);
+      const float intersection_x_max = std::min(x1_max, x2_max[j]);
+      const float intersection_y_min = std::max(y1_min, y2_min[j]);
+      const float intersection_y_max = std::min(y1_max, y2_max[j]);
+      const float intersection_area = (intersection_x_max - intersection_x_min) *
+                                      (intersection_y_max - intersection_y_min);
+      const float union_area = area1 + area2[j] - intersection_area;
+      const bool overlaps = !(intersection_x_max <= intersection_x_min) &&
+                            !(intersection_y_max <= intersection_y_min) &&
+                            !(intersection_area <= .0f) &&
+                            !(area1 <= .0f) && !(area2[j] <= .0f) && !(union_area <= .0f);
+      suppressed |= static_cast<int>(overlaps & (intersection_area / union_area > iou_threshold));
+    }
+    if (suppressed) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 
 // This works for both CPU and GPU.
 // CUDA kernel declare OrtMemTypeCPUInput for max_output_boxes_per_class(2), iou_threshold(3) and score_threshold(4)
@@ -148,17 +249,26 @@ Status NonMaxSuppression::Compute(OpKernelContext* ctx) const {
   };
 
   const auto center_point_box = GetCenterPointBox();
-
-  std::vector<SelectedIndex> selected_indices;
-  std::vector<BoxInfoPtr> selected_boxes_inside_class;
-  selected_boxes_inside_class.reserve(std::min<size_t>(static_cast<size_t>(max_output_boxes_per_class), pc.num_boxes_));
-
-  for (int64_t batch_index = 0; batch_index < pc.num_batches_; ++batch_index) {
-    for (int64_t class_index = 0; class_index < pc.num_classes_; ++class_index) {
-      int64_t box_score_offset = (batch_index * pc.num_classes_ + class_index) * pc.num_boxes_;
-      const float* batch_boxes = boxes_data + (batch_index * pc.num_boxes_ * 4);
-      std::vector<BoxInfoPtr> candidate_boxes;
-      candidate_boxes.reserve(pc.num_boxes_);
+  const auto num_boxes = static_cast<size_t>(pc.num_boxes_);
+
+  // the corners of the boxes of a batch are shared by all its classes
+  BoxCorners boxes;
+  ComputeBoxCorners(boxes_data, static_cast<size_t>(pc.num_batches_) * num_boxes, center_point_box, boxes);
+
+  // the (batch, class) pairs are independent, each one keeps the indices of its selected boxes
+  const auto num_pairs = static_cast<size_t>(pc.num_batches_ * pc.num_classes_);
+  const size_t max_selected = std::min<size_t>(static_cast<size_t>(max_output_boxes_per_class), num_boxes);
+  std::vector<std::vector<int64_t>> selected_per_pair(num_pairs);
+
+  auto select_boxes = [&](std::ptrdiff_t pair_begin, std::ptrdiff_t pair_end) {
+    std::vector<BoxInfoPtr> candidate_boxes;
+    BoxCorners selected_boxes;
+    selected_boxes.Resize(max_selected);
+    for (std::ptrdiff_t pair = pair_begin; pair < pair_end; ++pair) {
+      const int64_t batch_index = pair / pc.num_classes_;
+      const int64_t box_score_offset = pair * pc.num_boxes_;
+      candidate_boxes.clear();
+      candidate_boxes.reserve(num_boxes);
 
       // Filter by score_threshold_
       const auto* class_scores = scores_data + box_score_offset;
@@ -175,28 +285,38 @@ Status NonMaxSuppression::Compute(OpKernelContext* ctx) const {
       }
       std::priority_queue<BoxInfoPtr, std::vector<BoxInfoPtr>> sorted_boxes(std::less<BoxInfoPtr>(), std::move(candidate_boxes));
 
-      selected_boxes_inside_class.clear();
+      auto& selected_indices_inside_class = selected_per_pair[pair];
+      const size_t batch_box_offset = static_cast<size_t>(batch_index) * num_boxes;
       // Get the next box with top score, filter by iou_threshold
-      while (!sorted_boxes.empty() && static_cast<int64_t>(selected_boxes_inside_class.size()) < max_output_boxes_per_class) {
+      while (!sorted_boxes.empty() && selected_indices_inside_class.size() < max_selected) {
         const BoxInfoPtr& next_top_score = sorted_boxes.top();
+        const size_t box = batch_box_offset + static_cast<size_t>(next_top_score.index_);
 
-        bool selected = true;
         // Check with existing selected boxes for this class, suppress if exceed the IOU (Intersection Over Union) threshold
-        for (const auto& selected_index : selected_boxes_inside_class) {
-          if (SuppressByIOU(batch_boxes, next_top_score.index_, selected_index.index_, center_point_box, iou_threshold)) {
-            selected = false;
-            break;
-          }
-        }
-
-        if (selected) {
-          selected_boxes_inside_class.push_back(next_top_score);
-          selected_indices.emplace_back(batch_index, class_index, next_top_score.index_);
+        const size_t num_selected = selected_indices_inside_class.size();
+        if (!SuppressBySelectedBoxes(boxes, box, selected_boxes, num_selected, iou_threshold)) {
+          selected_boxes.CopyFrom(boxes, box, num_selected);
+          selected_indices_inside_class.push_back(next_top_score.index_);
         }
         sorted_boxes.pop();
       }  // while
-    }  // for class_index
-  }  // for batch_index
+    }  // for pair
+  };
+
+  // the cost of a pair is dominated by the IoU checks, of up to max_selected boxes for each candidate
+  const double cost_per_pair = static_cast<double>(num_boxes) *
+                               static_cast<double>(std::min<size_t>(max_selected, 64)) * 8.0;
+  concurrency::ThreadPool::TryParallelFor(ctx->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(num_pairs),
+                                          cost_per_pair, select_boxes);
+
+  std::vector<SelectedIndex> selected_indices;
+  for (size_t pair = 0; pair < num_pairs; ++pair) {
+    const auto batch_index = static_cast<int64_t>(pair) / pc.num_classes_;
+    const auto class_index = static_cast<int64_t>(pair) % pc.num_classes_;
+    for (int64_t box_index : selected_per_pair[pair]) {
+      selected_indices.emplace_back(batch_index, class_index, box_index);
+    }
+  }
 
   constexpr auto last_dim = 3;
   const auto num_selected = selected_indices.size();
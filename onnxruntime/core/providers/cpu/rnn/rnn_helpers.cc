@@ -312,6 +312,17 @@ void ComputeGemm(const int M,
   MlasGemm(gemm_shape, gemm_params, thread_pool);
 }
 
+bool ComputeDirectionsInParallel(concurrency::ThreadPool* thread_pool, int seq_length, int batch_size,
+                                 int input_size, int hidden_size, int num_gates) {
+  // MLAS doesn't split a float GEMM with a lower complexity (MLAS_SGEMM_THREAD_COMPLEXITY)
+  constexpr double kGemmThreadComplexity = 64.0 * 1024.0;
+  const double gates_size = static_cast<double>(num_gates) * hidden_size;
+  const double input_complexity = static_cast<double>(seq_length) * batch_size * gates_size * input_size;
+  const double step_complexity = static_cast<double>(batch_size) * gates_size * hidden_size;
+  return concurrency::ThreadPool::DegreeOfParallelism(thread_pool) > 1 &&
+         input_complexity < kGemmThreadComplexity && step_complexity < kGemmThreadComplexity;
+}
+
 namespace deepcpu {
 
 constexpr float alpha_1 = 4.89352455891786e-03f;
@@ -325,6 +325,14 @@ T* SafeRawPointer(typename gsl::span<T> span, size_t offset, size_t size) {
 void DumpMatrixImpl(const std::string& name, const float* src, int row, int col,
                     int offset = 0, int col_width = -1);
 
+// Whether both directions of a bidirectional RNN are computed at the same time, each one without the thread pool as
+// it doesn't support nested parallel loops. That is only done when both the GEMM of the input projection,
+// (seq_length * batch_size) x (num_gates * hidden_size) x input_size, and the GEMM of a recurrent step,
+// batch_size x (num_gates * hidden_size) x hidden_size, are too small to be split between threads anyway. Otherwise
+// the directions are computed one after the other with the thread pool.
+bool ComputeDirectionsInParallel(concurrency::ThreadPool* thread_pool, int seq_length, int batch_size,
+                                 int input_size, int hidden_size, int num_gates);
+
 // Helper class to wrap the processing of the activation funcs and any alpha/beta values.
 // The alpha/beta values are consumed in the order of the activation funcs. once they run out
 // defaults will be used as needed.
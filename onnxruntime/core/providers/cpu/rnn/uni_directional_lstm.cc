@@ -103,10 +103,11 @@ void UniDirectionalLstm<T>::AllocateBuffers() {
   }
 
   if (use_bias_) {
-    bias_WRi_ = Allocate(allocator_, hidden_size_, bias_WRi_ptr_);
-    bias_WRf_ = Allocate(allocator_, hidden_size_, bias_WRf_ptr_);
-    bias_WRo_ = Allocate(allocator_, hidden_size_, bias_WRo_ptr_);
-    bias_WRc_ = Allocate(allocator_, hidden_size_, bias_WRc_ptr_);
+    bias_WRiofc_ = Allocate(allocator_, hidden_size_ * 4, bias_WRiofc_ptr_);
+    bias_WRi_ = bias_WRiofc_.subspan(0, hidden_size_);
+    bias_WRo_ = bias_WRiofc_.subspan(hidden_size_, hidden_size_);
+    bias_WRf_ = bias_WRiofc_.subspan(2 * hidden_size_, hidden_size_);
+    bias_WRc_ = bias_WRiofc_.subspan(3 * hidden_size_, hidden_size_);
   }
 
   if (direction_ == kReverse) {
@@ -465,6 +466,11 @@ void UniDirectionalLstm<T>::GateComputations(
     span_T_iter& batched_cell_states, span_T_iter& batched_cell_states_end) {
   int hidden_size_x4 = 4 * hidden_size_;
 
+  // Without peepholes and coupled input and forget gates, the gates only depend on the output of the GEMM.
+  // The bias and clip are then applied to the four gates in one pass, and i, o and f, which are contiguous and use
+  // the same activation, are computed in one call.
+  const bool fuse_gates = !use_peepholes_ && !input_forget_;
+
   // Activation gates.
   for (int b = 0; b < local_fused_hidden_rows; b++) {
     if (step >= min_sequence_length && step >= seq_lengths[row + b]) {
@@ -497,39 +503,46 @@ void UniDirectionalLstm<T>::GateComputations(
 
     // DumpMatrix("C_prev" + row_str, pCprev_hidden_size, 1, hidden_size_);
 
-    // Input Gate
-    if (use_peepholes_) {
-      deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_i_, 0, hidden_size_), pi,
-                                   hidden_size_);
-    }
-
-    const float* pBi = use_bias_ ? SafeRawConstPointer<T>(bias_WRi_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBi, pi, hidden_size_);  // post: pi has input to f() to calculate i
-    activation_f_.func(pi, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    // DumpMatrix("i" + row_str, pi, 1, hidden_size_);
-
-    // Forget Gate
-    if (input_forget_) {
-      for (int i = 0; i < hidden_size_; i++) pf[i] = 1.0f - pi[i];
+    if (fuse_gates) {
+      const float* pB = use_bias_ ? SafeRawConstPointer<T>(bias_WRiofc_, 0, hidden_size_x4) : nullptr;
+      clip_with_bias_ptr_(clip_, pB, pi, hidden_size_x4);
+      activation_f_.func(pi, 3 * hidden_size_, activation_f_.alpha, activation_f_.beta);
+      activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
     } else {
+      // Input Gate
       if (use_peepholes_) {
-        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_f_, 0, hidden_size_), pf,
-                                     hidden_size_);
+        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_i_, 0, hidden_size_),
+                                     pi, hidden_size_);
       }
 
-      const float* pBf = use_bias_ ? SafeRawConstPointer<T>(bias_WRf_, 0, hidden_size_) : nullptr;
-      clip_with_bias_ptr_(clip_, pBf, pf, hidden_size_);
-      activation_f_.func(pf, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    }
+      const float* pBi = use_bias_ ? SafeRawConstPointer<T>(bias_WRi_, 0, hidden_size_) : nullptr;
+      clip_with_bias_ptr_(clip_, pBi, pi, hidden_size_);  // post: pi has input to f() to calculate i
+      activation_f_.func(pi, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      // DumpMatrix("i" + row_str, pi, 1, hidden_size_);
+
+      // Forget Gate
+      if (input_forget_) {
+        for (int i = 0; i < hidden_size_; i++) pf[i] = 1.0f - pi[i];
+      } else {
+        if (use_peepholes_) {
+          deepcpu::elementwise_product(pCprev_hidden_size,
+                                       SafeRawConstPointer<const T>(peephole_f_, 0, hidden_size_), pf, hidden_size_);
+        }
+
+        const float* pBf = use_bias_ ? SafeRawConstPointer<T>(bias_WRf_, 0, hidden_size_) : nullptr;
+        clip_with_bias_ptr_(clip_, pBf, pf, hidden_size_);
+        activation_f_.func(pf, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      }
 
-    // DumpMatrix("f" + row_str, pf, 1, hidden_size_);
+      // DumpMatrix("f" + row_str, pf, 1, hidden_size_);
 
-    // Block Gate
-    const float* pBc = use_bias_ ? SafeRawConstPointer<T>(bias_WRc_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBc, pc, hidden_size_);
-    activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
+      // Block Gate
+      const float* pBc = use_bias_ ? SafeRawConstPointer<T>(bias_WRc_, 0, hidden_size_) : nullptr;
+      clip_with_bias_ptr_(clip_, pBc, pc, hidden_size_);
+      activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
 
-    // DumpMatrix("c" + row_str, pc, 1, hidden_size_);
+      // DumpMatrix("c" + row_str, pc, 1, hidden_size_);
+    }
 
     // C_current. use previous C value as input, and update in-place
     float* pC_cur = pCprev_hidden_size;
@@ -554,14 +567,16 @@ void UniDirectionalLstm<T>::GateComputations(
     }
 
     // Output Gate
-    if (use_peepholes_)
-      deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_o_, 0, hidden_size_), po,
-                                   hidden_size_);
-
-    // calculate 'ot'
-    const float* pBo = use_bias_ ? SafeRawConstPointer<T>(bias_WRo_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBo, po, hidden_size_);
-    activation_f_.func(po, hidden_size_, activation_f_.alpha, activation_f_.beta);
+    if (!fuse_gates) {
+      if (use_peepholes_)
+        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_o_, 0, hidden_size_),
+                                     po, hidden_size_);
+
+      // calculate 'ot'
+      const float* pBo = use_bias_ ? SafeRawConstPointer<T>(bias_WRo_, 0, hidden_size_) : nullptr;
+      clip_with_bias_ptr_(clip_, pBo, po, hidden_size_);
+      activation_f_.func(po, hidden_size_, activation_f_.alpha, activation_f_.beta);
+    }
     // DumpMatrix("o" + row_str, po, 1, hidden_size_);
 
     // calculate 'Ht'
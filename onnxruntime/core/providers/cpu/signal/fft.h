@@ -0,0 +1,299 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+
+namespace onnxruntime {
+namespace signal {
+
+/**
+ * Precomputed factors and twiddles to compute the discrete Fourier transform of a given length:
+ * output[k] = sum_j input[j] * exp(-+2 pi i j k / n), with + for the inverse transform, which is not scaled.
+ *
+ * The length is split in factors, 4 and 2 first, and the transform is computed by mixed-radix decimation in time.
+ * Radix 2 and 4 have dedicated butterflies, the other factors use a generic one whose cost grows with the factor.
+ * Lengths with a prime factor larger than kMaxGenericRadix are computed with Bluestein's algorithm instead, as a
+ * convolution done with transforms of a power of 2 length.
+ *
+ * A plan is immutable once created, so it can be shared by threads, each of them with its own scratch buffer.
+ */
+template <typename T>
+class FftPlan {
+ public:
+  // Largest factor computed with the generic butterfly.
+  static constexpr size_t kMaxGenericRadix = 32;
+
+  FftPlan(size_t length, bool inverse);
+
+  size_t Length() const { return length_; }
+
+  // Number of elements of the scratch buffer of Execute.
+  size_t ScratchSize() const { return scratch_size_; }
+
+  // Computes the transform of input[0, n) into output[0, n). input and output must not overlap.
+  void Execute(const std::complex<T>* input, std::complex<T>* output, std::complex<T>* scratch) const;
+
+ private:
+  void Work(std::complex<T>* output, const std::complex<T>* input, size_t stride, const size_t* factors,
+            std::complex<T>* scratch) const;
+  void Butterfly2(std::complex<T>* output, size_t stride, size_t m) const;
+  void Butterfly4(std::complex<T>* output, size_t stride, size_t m) const;
+  void ButterflyGeneric(std::complex<T>* output, size_t stride, size_t m, size_t p, std::complex<T>* scratch) const;
+  void ExecuteBluestein(const std::complex<T>* input, std::complex<T>* output, std::complex<T>* scratch) const;
+
+  size_t length_;
+  bool inverse_;
+  size_t scratch_size_ = 0;
+  // (factor, remaining length) pairs, the last remaining length is 1.
+  std::vector<size_t> factors_;
+  // twiddles_[k] = exp(-+2 pi i k / n)
+  std::vector<std::complex<T>> twiddles_;
+
+  // Bluestein's algorithm: chirp_[k] = exp(-+pi i k^2 / n), and the forward transform of the conjugate chirp
+  // padded to the length of the convolution.
+  std::vector<std::complex<T>> chirp_;
+  std::vector<std::complex<T>> chirp_fft_;
+  std::unique_ptr<FftPlan> convolution_forward_;
+  std::unique_ptr<FftPlan> convolution_inverse_;
+};
+
+template <typename T>
+FftPlan<T>::FftPlan(size_t length, bool inverse) : length_(length), inverse_(inverse) {
+  ORT_ENFORCE(length > 0, "The length of a DFT must be greater than zero.");
+  const double sign = inverse ? 1.0 : -1.0;
+  const double pi = 3.14159265358979323846;
+
+  // factor the length, 4 first then 2 then the odd factors
+  std::vector<size_t> factors;
+  size_t remaining = length;
+  size_t max_factor = 1;
+  for (size_t p = 4; remaining > 1;) {
+    while (remaining % p != 0) {
+      p = p == 4 ? 2 : (p == 2 ? 3 : p + 2);
+      if (p * p > remaining) {
+        p = remaining;
+      }
+    }
+    remaining /= p;
+    factors.push_back(p);
+    factors.push_back(remaining);
+    max_factor = std::max(max_factor, p);
+  }
+
+  if (max_factor <= kMaxGenericRadix) {
+    factors_ = std::move(factors);
+    twiddles_.resize(length);
+    for (size_t k = 0; k < length; ++k) {
+      const double angle = sign * 2 * pi * static_cast<double>(k) / static_cast<double>(length);
+      twiddles_[k] = std::complex<T>(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+    }
+    // the generic butterfly keeps its inputs in the scratch buffer
+    scratch_size_ = max_factor;
+    return;
+  }
+
+  // The transform is a convolution with a chirp, since j k = (j^2 + k^2 - (k - j)^2) / 2.
+  size_t convolution_length = 1;
+  while (convolution_length < 2 * length - 1) {
+    convolution_length <<= 1;
+  }
+  convolution_forward_ = std::make_unique<FftPlan>(convolution_length, false);
+  convolution_inverse_ = std::make_unique<FftPlan>(convolution_length, true);
+
+  chirp_.resize(length);
+  for (size_t k = 0; k < length; ++k) {
+    // k^2 mod 2n keeps the angle accurate for large k
+    const uint64_t k2 = (static_cast<uint64_t>(k) * k) % (2 * static_cast<uint64_t>(length));
+    const double angle = sign * pi * static_cast<double>(k2) / static_cast<double>(length);
+    chirp_[k] = std::complex<T>(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+  }
+
+  std::vector<std::complex<T>> conjugate_chirp(convolution_length);
+  conjugate_chirp[0] = std::conj(chirp_[0]);
+  for (size_t k = 1; k < length; ++k) {
+    conjugate_chirp[k] = std::conj(chirp_[k]);
+    conjugate_chirp[convolution_length - k] = std::conj(chirp_[k]);
+  }
+  chirp_fft_.resize(convolution_length);
+  std::vector<std::complex<T>> scratch(convolution_forward_->ScratchSize());
+  convolution_forward_->Execute(conjugate_chirp.data(), chirp_fft_.data(), scratch.data());
+
+  scratch_size_ = 2 * convolution_length + convolution_forward_->ScratchSize();
+}
+
+template <typename T>
+void FftPlan<T>::Execute(const std::complex<T>* input, std::complex<T>* output, std::complex<T>* scratch) const {
+  if (convolution_forward_) {
+    ExecuteBluestein(input, output, scratch);
+  } else if (length_ == 1) {
+    output[0] = input[0];
+  } else {
+    Work(output, input, 1, factors_.data(), scratch);
+  }
+}
+
+template <typename T>
+void FftPlan<T>::Work(std::complex<T>* output, const std::complex<T>* input, size_t stride, const size_t* factors,
+                      std::complex<T>* scratch) const {
+  const size_t p = factors[0];
+  const size_t m = factors[1];
+
+  // transforms of the p decimated sequences, each of length m, stored one after the other
+  if (m == 1) {
+    for (size_t q = 0; q < p; ++q) {
+      output[q] = input[q * stride];
+    }
+  } else {
+    for (size_t q = 0; q < p; ++q) {
+      Work(output + q * m, input + q * stride, stride * p, factors + 2, scratch);
+    }
+  }
+
+  switch (p) {
+    case 2:
+      Butterfly2(output, stride, m);
+      break;
+    case 4:
+      Butterfly4(output, stride, m);
+      break;
+    default:
+      ButterflyGeneric(output, stride, m, p, scratch);
+      break;
+  }
+}
+
+template <typename T>
+void FftPlan<T>::Butterfly2(std::complex<T>* output, size_t stride, size_t m) const {
+  const std::complex<T>* twiddle = twiddles_.data();
+  for (size_t k = 0; k < m; ++k, twiddle += stride) {
+    const std::complex<T> t = output[k + m] * *twiddle;
+    output[k + m] = output[k] - t;
+    output[k] += t;
+  }
+}
+
+template <typename T>
+void FftPlan<T>::Butterfly4(std::complex<T>* output, size_t stride, size_t m) const {
+  const std::complex<T>* twiddles = twiddles_.data();
+  for (size_t k = 0; k < m; ++k) {
+    const std::complex<T> s0 = output[k + m] * twiddles[k * stride];
+    const std::complex<T> s1 = output[k + 2 * m] * twiddles[2 * k * stride];
+    const std::complex<T> s2 = output[k + 3 * m] * twiddles[3 * k * stride];
+    const std::complex<T> s3 = s0 + s2;
+    const std::complex<T> s4 = s0 - s2;
+    const std::complex<T> s5 = output[k] - s1;
+    const std::complex<T> even = output[k] + s1;
+    // s4 multiplied by -+i
+    const std::complex<T> s4_rotated = inverse_ ? std::complex<T>(-s4.imag(), s4.real())
+                                                : std::complex<T>(s4.imag(), -s4.real());
+    output[k] = even + s3;
+    output[k + 2 * m] = even - s3;
+    output[k + m] = s5 + s4_rotated;
+    output[k + 3 * m] = s5 - s4_rotated;
+  }
+}
+
+template <typename T>
+void FftPlan<T>::ButterflyGeneric(std::complex<T>* output, size_t stride, size_t m, size_t p,
+                                  std::complex<T>* scratch) const {
+  const std::complex<T>* twiddles = twiddles_.data();
+  for (size_t u = 0; u < m; ++u) {
+    for (size_t q = 0; q < p; ++q) {
+      scratch[q] = output[u + q * m];
+    }
+    for (size_t q1 = 0; q1 < p; ++q1) {
+      const size_t k = u + q1 * m;
+      std::complex<T> sum = scratch[0];
+      size_t twiddle_index = 0;
+      for (size_t q = 1; q < p; ++q) {
+        // (stride * k * q) mod n, stride * k < n
+        twiddle_index += stride * k;
+        if (twiddle_index >= length_) {
+          twiddle_index -= length_;
+        }
+        sum += scratch[q] * twiddles[twiddle_index];
+      }
+      output[k] = sum;
+    }
+  }
+}
+
+template <typename T>
+void FftPlan<T>::ExecuteBluestein(const std::complex<T>* input, std::complex<T>* output,
+                                  std::complex<T>* scratch) const {
+  const size_t convolution_length = chirp_fft_.size();
+  std::complex<T>* a = scratch;
+  std::complex<T>* a_fft = scratch + convolution_length;
+  std::complex<T>* sub_scratch = scratch + 2 * convolution_length;
+
+  for (size_t k = 0; k < length_; ++k) {
+    a[k] = input[k] * chirp_[k];
+  }
+  std::fill(a + length_, a + convolution_length, std::complex<T>());
+
+  convolution_forward_->Execute(a, a_fft, sub_scratch);
+  for (size_t k = 0; k < convolution_length; ++k) {
+    a_fft[k] *= chirp_fft_[k];
+  }
+  convolution_inverse_->Execute(a_fft, a, sub_scratch);
+
+  const T scale = static_cast<T>(1) / static_cast<T>(convolution_length);
+  for (size_t k = 0; k < length_; ++k) {
+    output[k] = a[k] * chirp_[k] * scale;
+  }
+}
+
+/**
+ * Plans of the lengths used by a kernel, created on first use and shared by its runs. Thread-safe.
+ */
+class FftPlanCache {
+ public:
+  template <typename T>
+  std::shared_ptr<const FftPlan<T>> Get(size_t length, bool inverse) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& plans = Plans<T>();
+    const uint64_t key = (static_cast<uint64_t>(length) << 1) | (inverse ? 1 : 0);
+    auto it = plans.find(key);
+    if (it != plans.end()) {
+      return it->second;
+    }
+    // the lengths are normally fixed, only keep a bounded number of them in case they are not
+    if (plans.size() >= kMaxPlans) {
+      plans.clear();
+    }
+    auto plan = std::make_shared<const FftPlan<T>>(length, inverse);
+    plans.emplace(key, plan);
+    return plan;
+  }
+
+ private:
+  static constexpr size_t kMaxPlans = 16;
+
+  template <typename T>
+  InlinedHashMap<uint64_t, std::shared_ptr<const FftPlan<T>>>& Plans() {
+    if constexpr (std::is_same_v<T, float>) {
+      return float_plans_;
+    } else {
+      return double_plans_;
+    }
+  }
+
+  std::mutex mutex_;
+  InlinedHashMap<uint64_t, std::shared_ptr<const FftPlan<float>>> float_plans_;
+  InlinedHashMap<uint64_t, std::shared_ptr<const FftPlan<double>>> double_plans_;
+};
+
+}  // namespace signal
+}  // namespace onnxruntime
@@ -4,6 +4,7 @@
 #include "core/providers/cpu/tensor/upsample.h"
 
 #include <limits>
+#include <type_traits>
 
 #include "core/common/inlined_containers.h"
 #include "core/common/safeint.h"
@@ -824,6 +825,118 @@ static TrilinearParams SetupUpsampleTrilinear(int64_t input_depth,
   return p;
 }
 
+// Keeps the input rows last interpolated along the width by a separable resize, so that an input row used by
+// consecutive output rows is interpolated once.
+class InterpolatedRowCache {
+ public:
+  InterpolatedRowCache(size_t num_slots, size_t row_size) : slots_(num_slots) {
+    for (auto& slot : slots_) {
+      slot.values.resize(row_size);
+    }
+  }
+
+  // Starts a new output row. The rows returned by Get for an output row are kept until the next one, so there
+  // must be more slots than input rows used by an output row.
+  void NextOutputRow() { ++output_row_; }
+
+  // Returns input_row interpolated along the width by interpolate(input_row, output).
+  template <typename Interpolate>
+  const float* Get(const float* input_row, const Interpolate& interpolate) {
+    Slot* victim = nullptr;
+    for (auto& slot : slots_) {
+      if (slot.input_row == input_row) {
+        slot.last_use = output_row_;
+        return slot.values.data();
+      }
+      if (slot.last_use != output_row_ && (victim == nullptr || slot.last_use < victim->last_use)) {
+        victim = &slot;
+      }
+    }
+    victim->input_row = input_row;
+    victim->last_use = output_row_;
+    interpolate(input_row, victim->values.data());
+    return victim->values.data();
+  }
+
+ private:
+  struct Slot {
+    const float* input_row = nullptr;
+    uint64_t last_use = 0;
+    std::vector<float> values;
+  };
+
+  std::vector<Slot> slots_;
+  uint64_t output_row_ = 1;
+};
+
+// Same as UpsampleBilinear for float, done as two separable passes: the input rows are interpolated along the width
+// once for all the output rows which use them, then each output row blends two of these rows with loops the
+// compiler can vectorize. The rows of all the channels are split between the threads.
+static void UpsampleBilinearSeparable(const int32_t batch_size,
+                                      const int32_t num_channels,
+                                      const int32_t input_height,
+                                      const int32_t input_width,
+                                      const int32_t output_height,
+                                      const int32_t output_width,
+                                      const float height_scale,
+                                      const float width_scale,
+                                      gsl::span<const float> roi,
+                                      const bool use_extrapolation,
+                                      const float extrapolation_value,
+                                      const float* const XdataBase,
+                                      float* const YdataBase,
+                                      AllocatorPtr& alloc,
+                                      const GetOriginalCoordinateFunc& get_original_coordinate,
+                                      concurrency::ThreadPool* tp) {
+  BilinearParams p = SetupUpsampleBilinear(input_height, input_width, output_height, output_width,
+                                           height_scale, width_scale, roi,
+                                           alloc, get_original_coordinate, true);
+
+  const auto interpolate_row = [&p, output_width](const float* input_row, float* output) {
+    for (int32_t x = 0; x < output_width; ++x) {
+      output[x] = p.dx2[x] * input_row[p.in_x1[x]] + p.dx1[x] * input_row[p.in_x2[x]];
+    }
+  };
+
+  const std::ptrdiff_t num_rows = static_cast<std::ptrdiff_t>(batch_size) * num_channels * output_height;
+  concurrency::ThreadPool::TryParallelFor(
+      tp, num_rows, static_cast<double>(output_width * 6),
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        InterpolatedRowCache cache(3, narrow<size_t>(output_width));
+        for (std::ptrdiff_t i = first; i < last; ++i) {
+          const std::ptrdiff_t plane = i / output_height;
+          const auto y = static_cast<int32_t>(i % output_height);
+          const float* const Xdata = XdataBase + plane * input_height * input_width;
+          float* const Ydata = YdataBase + plane * output_height * output_width + y * output_width;
+
+          // when use_extrapolation is set and original index of x or y is out of the dim range
+          // then use extrapolation_value as the output value.
+          if (use_extrapolation &&
+              (p.y_original[y] < 0 || p.y_original[y] > static_cast<float>(input_height - 1))) {
+            std::fill_n(Ydata, output_width, extrapolation_value);
+            continue;
+          }
+
+          cache.NextOutputRow();
+          const float* const row1 = cache.Get(Xdata + p.input_width_mul_y1[y], interpolate_row);
+          const float* const row2 = cache.Get(Xdata + p.input_width_mul_y2[y], interpolate_row);
+          const float dy1 = p.dy1[y];
+          const float dy2 = p.dy2[y];
+          for (int32_t x = 0; x < output_width; ++x) {
+            Ydata[x] = dy2 * row1[x] + dy1 * row2[x];
+          }
+
+          if (use_extrapolation) {
+            for (int32_t x = 0; x < output_width; ++x) {
+              if (p.x_original[x] < 0 || p.x_original[x] > static_cast<float>(input_width - 1)) {
+                Ydata[x] = extrapolation_value;
+              }
+            }
+          }
+        }
+      });
+}
+
 // The following method supports a 5-D input in 'Linear mode'
 // that amounts to 'Trilinear' Upsampling/Resizing in the sense that it assumes
 // the scale values for the outermost 2 dimensions are 1.
@@ -918,197 +1031,143 @@ std::array<float, CubicModeGridLength> GetCubicCoeffs(float s, float cubic_coeff
   return coeffs;
 }
 
-// Get the tensor data at the requested coordinate
-template <typename T>
-T GetDataForCoordinate(const T* Xdata,
-                       int64_t x, int64_t y,
-                       int64_t input_height, int64_t input_width) {
-  x = std::max(static_cast<int64_t>(0), std::min(x, input_width - 1));
-  y = std::max(static_cast<int64_t>(0), std::min(y, input_height - 1));
-  return Xdata[y * input_width + x];
-}
-
-// Computes cubic convolution interpolation in 1D
-template <typename T>
-float CubicInterpolation1D(const T* Xdata,
-                           int64_t x,
-                           int64_t y,
-                           int64_t input_height,
-                           int64_t input_width,
-                           std::array<float, CubicModeGridLength>& coeff_array,
-                           float coeff_sum,
-                           std::unordered_map<int64_t, float>& cache) {
-  // When calculating cubic interpolation we move the 4*4 grid across the original data and therefore there is
-  // opportunity to cache the results for previously seen combinations.
-  // Check if the result is already available in the cache
-  auto grid_start_pos = (y)*input_width + (x - 1);
-  if (cache.find(grid_start_pos) != cache.end()) {
-    return cache[grid_start_pos];
-  }
+// Cubic interpolation along one axis: for each output position, the 4 input positions it uses, clamped to the input,
+// and their coefficients. When exclude_outside is set, the coefficients of the positions outside the input are 0 and
+// coeff_sum is the sum of the others, otherwise coeff_sum is 1.
+struct CubicAxisParams {
+  std::vector<float> original;
+  std::vector<int64_t> index;
+  std::vector<float> coeff;
+  std::vector<float> coeff_sum;
+};
 
-  // get the neighbors in 1D and find interpolation for this dimension
-  // for 1D cubic interpolation 4 samples are used. 2 on the left and 2 on the right of x
-  float result = 0;
-  for (int i = 0, j = -1; i < static_cast<int>(CubicModeGridLength); i++, j++) {
-    auto orig_data = GetDataForCoordinate(Xdata, x + j, y, input_height, input_width);
-    result += coeff_array[narrow<size_t>(i)] / coeff_sum * orig_data;
+static CubicAxisParams SetupCubicAxis(int64_t input_size, int64_t output_size, float scale, float roi_start,
+                                      float roi_end, float cubic_coeff_a, bool exclude_outside,
+                                      const GetOriginalCoordinateFunc& get_original_coordinate) {
+  CubicAxisParams p;
+  p.original.resize(narrow<size_t>(output_size));
+  p.index.resize(narrow<size_t>(output_size) * CubicModeGridLength);
+  p.coeff.resize(narrow<size_t>(output_size) * CubicModeGridLength);
+  p.coeff_sum.resize(narrow<size_t>(output_size));
+
+  for (int64_t o = 0; o < output_size; ++o) {
+    const float in = scale == 1 ? static_cast<float>(o)
+                                : get_original_coordinate(static_cast<float>(o), scale,
+                                                          static_cast<float>(output_size),
+                                                          static_cast<float>(input_size),
+                                                          roi_start, roi_end);
+    p.original[narrow<size_t>(o)] = in;
+    const auto in_int = static_cast<int64_t>(std::floor(in));
+    const auto coeffs = GetCubicCoeffs(in - in_int, cubic_coeff_a);
+    float coeff_sum = exclude_outside ? 0.0f : 1.0f;
+    for (size_t i = 0; i < CubicModeGridLength; ++i) {
+      const int64_t in_val = in_int - 1 + static_cast<int64_t>(i);
+      float coeff = coeffs[i];
+      if (exclude_outside) {
+        // When true, the weight of sampling locations outside the grid will be set to 0
+        // and the weight will be renormalized so that their sum is 1.0
+        coeff = (in_val < 0 || in_val >= static_cast<float>(input_size)) ? 0.0f : coeff;
+        coeff_sum += coeff;
+      }
+      p.index[narrow<size_t>(o) * CubicModeGridLength + i] = std::max<int64_t>(0, std::min(in_val, input_size - 1));
+      p.coeff[narrow<size_t>(o) * CubicModeGridLength + i] = coeff;
+    }
+    p.coeff_sum[narrow<size_t>(o)] = coeff_sum;
   }
-  cache[grid_start_pos] = result;
-
-  return result;
+  return p;
 }
-#if defined(_MSC_VER)
-#pragma warning(push)
-#pragma warning(disable : 6001)
-#endif
-template <typename T>
-void ResizeBiCubic(int64_t batch_size,
-                   int64_t num_channels,
-                   int64_t input_height,
-                   int64_t input_width,
-                   int64_t output_height,
-                   int64_t output_width,
-                   float height_scale,
-                   float width_scale,
-                   float cubic_coeff_a,
-                   bool use_extrapolation,
-                   float extrapolation_value,
-                   bool exclude_outside,
-                   gsl::span<const float> roi,
-                   const T* Xdata,
-                   T* Ydata,
-                   const GetOriginalCoordinateFunc& get_original_coordinate) {
-  std::vector<float> y_original;
-  y_original.reserve(narrow<size_t>(output_height));
-
-  std::vector<float> x_original;
-  x_original.reserve(narrow<size_t>(output_width));
-
-  std::unordered_map<float, std::array<float, CubicModeGridLength>> cubic_coeffs;
-  std::unordered_map<float, std::unordered_map<int64_t, float>> coeff_to_1Dinterpolation_map;
-  auto roi_y_start = roi.size() / 2 - 2;
-  auto roi_y_end = roi.size() - 2;
-  auto roi_x_start = roi.size() / 2 - 1;
-  auto roi_x_end = roi.size() - 1;
 
-  // generate coefficients in y direction
-  for (int64_t y = 0; y < output_height; ++y) {
-    float in_y = height_scale == 1 ? static_cast<float>(y)
-                                   : get_original_coordinate(static_cast<float>(y), height_scale,
-                                                             static_cast<float>(output_height),
-                                                             static_cast<float>(input_height),
-                                                             roi[roi_y_start], roi[roi_y_end]);
-    y_original.emplace_back(in_y);
-    auto s = y_original[narrow<size_t>(y)] - std::floor(y_original[narrow<size_t>(y)]);
-    if (cubic_coeffs.find(s) == cubic_coeffs.end()) {
-      cubic_coeffs[s] = GetCubicCoeffs(s, cubic_coeff_a);
-      coeff_to_1Dinterpolation_map[s] = {};
-    }
+// Bicubic interpolation done as two separable passes: the input rows are interpolated along the width once for all
+// the output rows which use them, then each output row combines four of these rows. The rows of all the channels
+// are split between the threads.
+static void ResizeBiCubic(int64_t batch_size,
+                          int64_t num_channels,
+                          int64_t input_height,
+                          int64_t input_width,
+                          int64_t output_height,
+                          int64_t output_width,
+                          float height_scale,
+                          float width_scale,
+                          float cubic_coeff_a,
+                          bool use_extrapolation,
+                          float extrapolation_value,
+                          bool exclude_outside,
+                          gsl::span<const float> roi,
+                          const float* XdataBase,
+                          float* YdataBase,
+                          const GetOriginalCoordinateFunc& get_original_coordinate,
+                          concurrency::ThreadPool* tp) {
+  const CubicAxisParams py = SetupCubicAxis(input_height, output_height, height_scale, roi[roi.size() / 2 - 2],
+                                            roi[roi.size() - 2], cubic_coeff_a, exclude_outside,
+                                            get_original_coordinate);
+  const CubicAxisParams px = SetupCubicAxis(input_width, output_width, width_scale, roi[roi.size() / 2 - 1],
+                                            roi[roi.size() - 1], cubic_coeff_a, exclude_outside,
+                                            get_original_coordinate);
+
+  // the coefficients along the width are applied to the input directly, normalize them once
+  std::vector<float> x_coeff(px.coeff.size());
+  for (size_t i = 0; i < x_coeff.size(); ++i) {
+    x_coeff[i] = px.coeff[i] / px.coeff_sum[i / CubicModeGridLength];
   }
 
-  // generate coefficients in x direction
-  for (int64_t x = 0; x < output_width; ++x) {
-    float in_x = width_scale == 1 ? static_cast<float>(x)
-                                  : get_original_coordinate(static_cast<float>(x),
-                                                            width_scale,
-                                                            static_cast<float>(output_width),
-                                                            static_cast<float>(input_width),
-                                                            roi[roi_x_start], roi[roi_x_end]);
-    x_original.emplace_back(in_x);
-    auto s = x_original[narrow<size_t>(x)] - std::floor(x_original[narrow<size_t>(x)]);
-    if (cubic_coeffs.find(s) == cubic_coeffs.end()) {
-      cubic_coeffs[s] = GetCubicCoeffs(s, cubic_coeff_a);
-      coeff_to_1Dinterpolation_map[s] = {};
+  const auto interpolate_row = [&px, &x_coeff, output_width](const float* input_row, float* output) {
+    const int64_t* index = px.index.data();
+    const float* coeff = x_coeff.data();
+    for (int64_t x = 0; x < output_width; ++x, index += CubicModeGridLength, coeff += CubicModeGridLength) {
+      float result = 0;
+      for (size_t i = 0; i < CubicModeGridLength; ++i) {
+        result += coeff[i] * input_row[index[i]];
+      }
+      output[x] = result;
     }
-  }
-
-  // setup up temp arrays to hold coefficients when exclude_outside is set to true
-  std::array<float, CubicModeGridLength> y_coeff_holder;
-  std::array<float, CubicModeGridLength> x_coeff_holder;
-  float y_coeff_sum = 1;
-  float x_coeff_sum = 1;
-
-  for (int64_t n = 0; n < batch_size; n++) {
-    for (int64_t c = 0; c < num_channels; c++) {
-      for (int64_t y = 0; y < output_height; ++y) {
-        auto in_y = y_original[narrow<size_t>(y)];
-
-        // when use_extrapolation is set and original index is out of the dim range
-        // then use extrapolation_value as the output value.
-        if (use_extrapolation && (in_y < 0 || in_y > static_cast<float>(input_height - 1))) {
-          for (int64_t x = 0; x < output_width; ++x) {
-            Ydata[y * output_width + x] = extrapolation_value;
-          }
-          continue;
-        }
-
-        auto y_int = static_cast<int64_t>(std::floor(in_y));
-        auto& coeff_y = exclude_outside ? y_coeff_holder : cubic_coeffs[in_y - y_int];
-        y_coeff_sum = 1;
-
-        if (exclude_outside) {
-          // When true, the weight of sampling locations outside the grid will be set to 0
-          // and the weight will be renormalized so that their sum is 1.0
-          y_coeff_sum = 0;
-          auto& orig_y_coeffs = cubic_coeffs[in_y - y_int];
-          for (int64_t i = 0, y_val = y_int - 1; y_val <= y_int + 2; y_val++, i++) {
-            y_coeff_holder[narrow<size_t>(i)] = (y_val < 0 || y_val >= static_cast<float>(input_height)) ? 0.0f : orig_y_coeffs[narrow<size_t>(i)];
-            y_coeff_sum += y_coeff_holder[narrow<size_t>(i)];
-          }
-        }
+  };
 
-        for (int64_t x = 0; x < output_width; ++x) {
-          auto in_x = x_original[narrow<size_t>(x)];
+  const std::ptrdiff_t num_rows = narrow<std::ptrdiff_t>(batch_size * num_channels * output_height);
+  concurrency::ThreadPool::TryParallelFor(
+      tp, num_rows, static_cast<double>(output_width * 24),
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        InterpolatedRowCache cache(CubicModeGridLength + 2, narrow<size_t>(output_width));
+        const float* rows[CubicModeGridLength];
+        for (std::ptrdiff_t r = first; r < last; ++r) {
+          const int64_t plane = r / output_height;
+          const int64_t y = r % output_height;
+          const float* const Xdata = XdataBase + plane * input_height * input_width;
+          float* const Ydata = YdataBase + plane * output_height * output_width + y * output_width;
 
           // when use_extrapolation is set and original index is out of the dim range
           // then use extrapolation_value as the output value.
-          if (use_extrapolation && (in_x < 0 || in_x > static_cast<float>(input_width - 1))) {
-            Ydata[y * output_width + x] = extrapolation_value;
+          const float in_y = py.original[narrow<size_t>(y)];
+          if (use_extrapolation && (in_y < 0 || in_y > static_cast<float>(input_height - 1))) {
+            std::fill_n(Ydata, output_width, extrapolation_value);
             continue;
           }
 
-          auto x_int = static_cast<int64_t>(std::floor(in_x));
-          auto s_x = static_cast<float>(in_x - x_int);
-          auto& coeff_x = exclude_outside ? x_coeff_holder : cubic_coeffs[s_x];
-          x_coeff_sum = 1;
-
-          if (exclude_outside) {
-            // When true, the weight of sampling locations outside the grid will be set to 0
-            // and the weight will be renormalized so that their sum is 1.0
-            x_coeff_sum = 0;
-            auto& orig_x_coeff = cubic_coeffs[s_x];
-            for (int64_t i = 0, x_val = x_int - 1; x_val <= x_int + 2; x_val++, i++) {
-              x_coeff_holder[narrow<size_t>(i)] = (x_val < 0 || x_val >= static_cast<float>(input_width)) ? 0.0f : orig_x_coeff[narrow<size_t>(i)];
-              x_coeff_sum += x_coeff_holder[narrow<size_t>(i)];
+          cache.NextOutputRow();
+          const int64_t* y_index = py.index.data() + y * CubicModeGridLength;
+          const float* y_coeff = py.coeff.data() + y * CubicModeGridLength;
+          const float y_coeff_sum = py.coeff_sum[narrow<size_t>(y)];
+          for (size_t i = 0; i < CubicModeGridLength; ++i) {
+            rows[i] = cache.Get(Xdata + y_index[i] * input_width, interpolate_row);
+          }
+          for (int64_t x = 0; x < output_width; ++x) {
+            float result = 0;
+            for (size_t i = 0; i < CubicModeGridLength; ++i) {
+              result += rows[i][x] * y_coeff[i] / y_coeff_sum;
             }
+            Ydata[x] = result;
           }
 
-          // Compute cubic interpolation in x dimension using the x coefficients.
-          // From the result of cubic interpolation in x dim, compute cubic interpolation in y dimension
-          auto& interpolation_result_cache = coeff_to_1Dinterpolation_map[s_x];
-          float result = 0;
-          for (int64_t y_val = y_int - 1, i = 0; y_val <= y_int + 2; y_val++, i++) {
-            auto x_interpolation_result = CubicInterpolation1D(Xdata, x_int, y_val,
-                                                               input_height, input_width, coeff_x, x_coeff_sum,
-                                                               interpolation_result_cache);
-            result += x_interpolation_result * coeff_y[narrow<size_t>(i)] / y_coeff_sum;
+          if (use_extrapolation) {
+            for (int64_t x = 0; x < output_width; ++x) {
+              const float in_x = px.original[narrow<size_t>(x)];
+              if (in_x < 0 || in_x > static_cast<float>(input_width - 1)) {
+                Ydata[x] = extrapolation_value;
+              }
+            }
           }
-
-          Ydata[y * output_width + x] = static_cast<T>(result);
         }
-      }
-
-      Xdata += input_height * input_width;
-      Ydata += output_height * output_width;
-
-      // clear the cache when moving to the next channel
-      coeff_to_1Dinterpolation_map.clear();
-    }
-  }
+      });
 }
-#if defined(_MSC_VER)
-#pragma warning(pop)
-#endif
 
 template <typename T>
 Status Upsample<T>::BaseCompute(OpKernelContext* context,
@@ -1217,6 +1276,12 @@ Status Upsample<T>::BaseCompute(OpKernelContext* context,
                                       height_scale, width_scale, roi, use_extrapolation_, extrapolation_value_, exclude_outside_,
                                       X, Y->MutableData<T>(), alloc, get_original_coordinate_,
                                       output_height * output_width > 64 ? context->GetOperatorThreadPool() : nullptr);
+          } else if constexpr (std::is_same_v<T, float>) {
+            UpsampleBilinearSeparable(batch_size, num_channels, input_height, input_width, output_height, output_width,
+                                      height_scale, width_scale, roi,
+                                      use_extrapolation_, extrapolation_value_, X->Data<float>(),
+                                      Y->MutableData<float>(), alloc, get_original_coordinate_,
+                                      output_height * output_width > 64 ? context->GetOperatorThreadPool() : nullptr);
           } else {
             UpsampleBilinear(batch_size, num_channels, input_height, input_width, output_height, output_width,
                              height_scale, width_scale, roi,
@@ -1361,7 +1426,8 @@ Status Upsample<T>::BaseCompute(OpKernelContext* context,
         ResizeBiCubic(batch_size, num_channels, input_height, input_width, output_height, output_width,
                       height_scale, width_scale, cubic_coeff_a_, use_extrapolation_,
                       extrapolation_value_, exclude_outside_, roi, X->Data<float>(),
-                      Y->MutableData<float>(), get_original_coordinate_);
+                      Y->MutableData<float>(), get_original_coordinate_,
+                      output_height * output_width * num_channels > 64 ? context->GetOperatorThreadPool() : nullptr);
       }
       return Status::OK();
     }
@@ -4,6 +4,7 @@
 #include "string_normalizer.h"
 #include "core/common/common.h"
 #include "core/framework/tensor.h"
+#include "core/platform/threadpool.h"
 // Used below HAS_DEPRECATED_DECLARATIONS
 #include "onnxruntime_config.h"
 
@@ -12,7 +13,10 @@
 #include <locale.h>
 #endif  // _MSC_VER
 
+#include <algorithm>
+#include <cassert>
 #include <codecvt>
+#include <cstring>
 #include <locale>
 #include <functional>
 
@@ -436,6 +440,128 @@ const std::string default_locale("en_US.UTF-8");  // All non-MS and not Apple
 #endif
 
 #endif  // _MSC_VER
+
+// Returns true if s only contains ASCII characters. The bytes are tested 8 at a time.
+inline bool IsAscii(const std::string& s) {
+  const char* data = s.data();
+  const size_t len = s.length();
+  uint64_t bits = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    bits |= word;
+  }
+  for (; i < len; ++i) {
+    bits |= static_cast<unsigned char>(data[i]);
+  }
+  return (bits & 0x8080808080808080ULL) == 0;
+}
+
+// Changes the case of ASCII letters. The loop has no branch so that compilers vectorize it.
+inline void ChangeCaseAscii(StringNormalizer::CaseAction caseaction, const char* src, size_t len, char* dest) {
+  assert(caseaction != StringNormalizer::NONE);
+  const unsigned char first = caseaction == StringNormalizer::LOWER ? 'A' : 'a';
+  for (size_t i = 0; i < len; ++i) {
+    const auto ch = static_cast<unsigned char>(src[i]);
+    const unsigned char flip = static_cast<unsigned char>(ch - first) < 26 ? 0x20 : 0;
+    dest[i] = static_cast<char>(ch ^ flip);
+  }
+}
+
+// Checks that the locale maps the case of ASCII letters as the C locale does. It does not for some
+// locales, e.g. Turkish where the lower case of 'I' is a dotless i.
+bool HasAsciiCaseMapping(const Locale& locale) {
+  std::wstring lower;
+  for (wchar_t ch = 0; ch < 0x80; ++ch) {
+    lower.push_back(ch);
+  }
+  std::wstring upper = lower;
+  locale.ChangeCase(StringNormalizer::LOWER, lower);
+  locale.ChangeCase(StringNormalizer::UPPER, upper);
+  for (wchar_t ch = 0; ch < 0x80; ++ch) {
+    const auto expected_lower = static_cast<wchar_t>((ch >= L'A' && ch <= L'Z') ? ch + (L'a' - L'A') : ch);
+    const auto expected_upper = static_cast<wchar_t>((ch >= L'a' && ch <= L'z') ? ch - (L'a' - L'A') : ch);
+    const auto pos = static_cast<size_t>(ch);
+    if (lower[pos] != expected_lower || upper[pos] != expected_upper) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Changes the case of UTF-8 strings. Keeps the conversion buffers, so each thread uses its own instance.
+class CaseChanger {
+ public:
+  CaseChanger(const Locale* locale, bool ascii_case_mapping)
+      : locale_(locale), ascii_case_mapping_(ascii_case_mapping) {}
+
+  Status ChangeCase(StringNormalizer::CaseAction caseaction, const std::string& src, std::string& dest) {
+    if (ascii_case_mapping_ && IsAscii(src)) {
+      dest.resize(src.length());
+      ChangeCaseAscii(caseaction, src.data(), src.length(), dest.data());
+      return Status::OK();
+    }
+
+    size_t wchars = 0;
+    ORT_RETURN_IF_ERROR(converter_.ComputeRequiredSizeToWideChar(src, wchars));
+    wide_buffer_.resize(wchars);
+    ORT_RETURN_IF_ERROR(converter_.ConvertToWideChar(src, wide_buffer_));
+    locale_->ChangeCase(caseaction, wide_buffer_);
+
+    dest.resize(converter_.ComputeRequiredSizeToUtf8(wide_buffer_));
+    return converter_.ConvertToUtf8(wide_buffer_, dest);
+  }
+
+  // Scratch string reused across the rows of a thread.
+  std::string& Buffer() { return utf8_buffer_; }
+
+  // Checks for invalid UTF-8 characters on Windows
+  Status Validate(const std::string& s) {
+    if (IsAscii(s)) {
+      return Status::OK();
+    }
+    size_t wchars = 0;
+    return converter_.ComputeRequiredSizeToWideChar(s, wchars);
+  }
+
+ private:
+  const Locale* locale_;
+  bool ascii_case_mapping_;
+  Utf8Converter converter_;
+  std::wstring wide_buffer_;
+  std::string utf8_buffer_;
+};
+
+// Calls fn(row, case_changer) for rows [0, n) on the thread pool and returns the first error.
+template <typename Fn>
+Status ParallelForRows(concurrency::ThreadPool* tp, size_t n, const Locale* locale, bool ascii_case_mapping,
+                       Fn&& fn) {
+  // Below this many rows per batch the cost of the dispatch outweighs the work.
+  constexpr std::ptrdiff_t kMinRowsPerBatch = 256;
+  const std::ptrdiff_t total = narrow<std::ptrdiff_t>(n);
+  const std::ptrdiff_t num_batches = std::max<std::ptrdiff_t>(
+      1, std::min<std::ptrdiff_t>(concurrency::ThreadPool::DegreeOfParallelism(tp), total / kMinRowsPerBatch));
+
+  InlinedVector<Status> statuses(narrow<size_t>(num_batches));
+  concurrency::ThreadPool::TrySimpleParallelFor(tp, num_batches, [&](std::ptrdiff_t batch) {
+    CaseChanger case_changer(locale, ascii_case_mapping);
+    auto work = concurrency::ThreadPool::PartitionWork(batch, num_batches, total);
+    for (std::ptrdiff_t row = work.start; row < work.end; ++row) {
+      Status status = fn(narrow<size_t>(row), case_changer);
+      if (!status.IsOK()) {
+        statuses[narrow<size_t>(batch)] = std::move(status);
+        return;
+      }
+    }
+  });
+
+  for (auto& status : statuses) {
+    ORT_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
 }  // namespace string_normalizer
 
 using namespace string_normalizer;
@@ -461,24 +587,29 @@ StringNormalizer::StringNormalizer(const OpKernelInfo& info) : OpKernel(info) {
 
   locale_name_ = info.GetAttrOrDefault("locale", default_locale);
 
+  if (case_change_action_ != NONE || !is_case_sensitive_) {
+    locale_ = std::make_unique<Locale>(locale_name_);
+    ascii_case_mapping_ = HasAsciiCaseMapping(*locale_);
+  }
+
   std::vector<std::string> stop_words = info.GetAttrsOrDefault<std::string>("stopwords");
+  stopwords_.reserve(stop_words.size());
   if (is_case_sensitive_) {
-    stopwords_.reserve(stop_words.size());
     for (std::string& s : stop_words) {
       stopwords_.insert(std::move(s));
     }
   } else {
-    Locale locale(locale_name_);
-    Utf8Converter converter;
-    wstopwords_.reserve(stop_words.size());
-    for (std::string& s : stop_words) {
-      std::wstring wstr = converter.from_bytes(s);
-      locale.ChangeCase(compare_caseaction_, wstr);
-      wstopwords_.insert(std::move(wstr));
+    CaseChanger case_changer(locale_.get(), ascii_case_mapping_);
+    for (const std::string& s : stop_words) {
+      std::string folded;
+      ORT_THROW_IF_ERROR(case_changer.ChangeCase(compare_caseaction_, s, folded));
+      stopwords_.insert(std::move(folded));
     }
   }
 }
 
+StringNormalizer::~StringNormalizer() = default;
+
 Status StringNormalizer::Compute(OpKernelContext* ctx) const {
   using namespace string_normalizer;
 
@@ -507,9 +638,7 @@ Status StringNormalizer::Compute(OpKernelContext* ctx) const {
   }
 
   // Special case, no filtering and no case change
-  if (case_change_action_ == NONE &&
-      ((is_case_sensitive_ && stopwords_.empty()) ||
-       (!is_case_sensitive_ && wstopwords_.empty()))) {
+  if (case_change_action_ == NONE && stopwords_.empty()) {
     output_shape.push_back(C);
     auto output_tensor = ctx->Output(0, output_shape);
     auto const output_data = output_tensor->MutableData<std::string>();
@@ -517,121 +646,62 @@ Status StringNormalizer::Compute(OpKernelContext* ctx) const {
     return Status::OK();
   }
 
+  concurrency::ThreadPool* tp = ctx->GetOperatorThreadPool();
+  const size_t num_strings = input_span.size();
+
   // We need to know the result dimension, and for that we need to filter
   // the words first. If comparison mode is case sensitive, we just go ahead
-  // and compare with the original strings. Otherwise, we need to convert the string
-  // to widechar, lowercase it and then compare. Case-insensitive comparison is complicated
-  // for UTF-8 and requires additional dependency.
-
-  Locale locale(locale_name_);
-  Utf8Converter converter;
-
-  // Compute the largest widestring buffer needed.
-  size_t max_wide_buffer_len = 0;
-  for (const auto& s : input_span) {
-    size_t wchars = 0;
-    // Checks for invalid UTF-8 characters on Windows
-    ORT_RETURN_IF_ERROR(converter.ComputeRequiredSizeToWideChar(s, wchars));
-    max_wide_buffer_len = std::max(max_wide_buffer_len, wchars);
-  }
-
-  // Reuse reserved space
-  std::wstring wchar_buffer;
-  wchar_buffer.reserve(max_wide_buffer_len);
-
-  // Output everything and change case as required
-  auto output_no_filtering = [&](const TensorShape& output_shape) {
-    auto output_tensor = ctx->Output(0, output_shape);
-    auto const output_data = output_tensor->MutableData<std::string>();
-    for (size_t i = 0, lim = input_span.size(); i < lim; ++i) {
-      const std::string& s = input_span[i];
-      wchar_buffer.resize(max_wide_buffer_len);
-      ORT_RETURN_IF_ERROR(converter.ConvertToWideChar(s, wchar_buffer));
-      locale.ChangeCase(case_change_action_, wchar_buffer);
-
-      auto& dest = output_data[i];
-      size_t utf8_buffer_len = converter.ComputeRequiredSizeToUtf8(wchar_buffer);
-      dest.resize(utf8_buffer_len);
-      ORT_RETURN_IF_ERROR(converter.ConvertToUtf8(wchar_buffer, dest));
-    }
-    return Status::OK();
-  };
-
-  auto output_filtered = [&](const TensorShape& output_shape, gsl::span<const size_t> filtered_indices) {
-    auto output_tensor = ctx->Output(0, output_shape);
-    auto output_data = output_tensor->MutableData<std::string>();
-    for (size_t i : filtered_indices) {
-      const std::string& s = input_span[i];
-      if (case_change_action_ != NONE) {
-        wchar_buffer.resize(max_wide_buffer_len);
-        ORT_RETURN_IF_ERROR(converter.ConvertToWideChar(s, wchar_buffer));
-        locale.ChangeCase(case_change_action_, wchar_buffer);
-
-        auto& dest = *output_data++;
-        size_t utf8_buffer_len = converter.ComputeRequiredSizeToUtf8(wchar_buffer);
-        dest.resize(utf8_buffer_len);
-        ORT_RETURN_IF_ERROR(converter.ConvertToUtf8(wchar_buffer, dest));
-      } else {
-        *output_data++ = s;
+  // and compare with the original strings. Otherwise, we change the case of the string
+  // to compare_caseaction_, through wide chars unless it is ASCII, and then compare.
+  // Case-insensitive comparison is complicated for UTF-8 and requires additional dependency.
+  InlinedVector<size_t> filtered_strings_indices;
+  const bool filter = !stopwords_.empty();
+  if (filter) {
+    std::vector<uint8_t> keep(num_strings);
+    ORT_RETURN_IF_ERROR(ParallelForRows(
+        tp, num_strings, locale_.get(), ascii_case_mapping_,
+        [&](size_t i, CaseChanger& case_changer) -> Status {
+          const std::string& s = input_span[i];
+          if (is_case_sensitive_) {
+            ORT_RETURN_IF_ERROR(case_changer.Validate(s));
+            keep[i] = stopwords_.count(s) == 0;
+          } else {
+            std::string& folded = case_changer.Buffer();
+            ORT_RETURN_IF_ERROR(case_changer.ChangeCase(compare_caseaction_, s, folded));
+            keep[i] = stopwords_.count(folded) == 0;
+          }
+          return Status::OK();
+        }));
+
+    filtered_strings_indices.reserve(num_strings);
+    for (size_t i = 0; i < num_strings; ++i) {
+      if (keep[i]) {
+        filtered_strings_indices.push_back(i);
       }
     }
-    return Status::OK();
-  };
-
-  Status status;
 
-  if (is_case_sensitive_) {
-    if (stopwords_.empty()) {
-      assert(case_change_action_ != NONE);
-      output_shape.push_back(C);
-      status = output_no_filtering(output_shape);
-    } else {
-      // we need to filter
-      InlinedVector<size_t> filtered_strings_indices;
-      filtered_strings_indices.reserve(input_span.size());
-
-      for (size_t i = 0, lim = input_span.size(); i < lim; ++i) {
-        const std::string& s = input_span[i];
-        if (stopwords_.count(s) == 0) {
-          filtered_strings_indices.push_back(i);
-        }
-      }
-
-      // According to the spec, if all strings are filtered out
-      // the output must have a shape of {1} with a single empty string.
-      const int64_t filtered_count = std::max<int64_t>(1, narrow<int64_t>(filtered_strings_indices.size()));
-      output_shape.push_back(filtered_count);
-      status = output_filtered(output_shape, filtered_strings_indices);
-    }
+    // According to the spec, if all strings are filtered out
+    // the output must have a shape of {1} with a single empty string.
+    output_shape.push_back(std::max<int64_t>(1, narrow<int64_t>(filtered_strings_indices.size())));
   } else {
-    if (wstopwords_.empty()) {
-      assert(case_change_action_ != NONE);
-      output_shape.push_back(C);
-      status = output_no_filtering(output_shape);
-    } else {
-      // Case insensitive filtering is performed by converting the input strings
-      // to compare_caseaction_. For that we convert to wchar_t UNICODE.
-      // Otherwise, we need to pull ICU library on all platforms.
-      InlinedVector<size_t> filtered_strings_indices;
-      filtered_strings_indices.reserve(input_span.size());
-      for (size_t i = 0, lim = input_span.size(); i < lim; ++i) {
-        const std::string& s = input_span[i];
-        wchar_buffer.resize(max_wide_buffer_len);
-        ORT_RETURN_IF_ERROR(converter.ConvertToWideChar(s, wchar_buffer));
-        locale.ChangeCase(compare_caseaction_, wchar_buffer);
-        if (wstopwords_.count(wchar_buffer) == 0) {
-          filtered_strings_indices.push_back(i);
-        }
-      }
-
-      // According to the spec, if all strings are filtered out
-      // the output must have a shape of {1} with a single empty string.
-      const int64_t filtered_count = std::max<int64_t>(1, narrow<int64_t>(filtered_strings_indices.size()));
-      output_shape.push_back(filtered_count);
-      status = output_filtered(output_shape, filtered_strings_indices);
-    }
+    assert(case_change_action_ != NONE);
+    output_shape.push_back(C);
   }
 
-  return status;
+  auto output_tensor = ctx->Output(0, output_shape);
+  auto const output_data = output_tensor->MutableData<std::string>();
+  const size_t num_outputs = filter ? filtered_strings_indices.size() : num_strings;
+
+  // Output the strings and change case as required
+  return ParallelForRows(
+      tp, num_outputs, locale_.get(), ascii_case_mapping_,
+      [&](size_t i, CaseChanger& case_changer) -> Status {
+        const std::string& s = input_span[filter ? filtered_strings_indices[i] : i];
+        if (case_change_action_ == NONE) {
+          output_data[i] = s;
+          return Status::OK();
+        }
+        return case_changer.ChangeCase(case_change_action_, s, output_data[i]);
+      });
 }
 }  // namespace onnxruntime
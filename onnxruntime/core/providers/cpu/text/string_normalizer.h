@@ -6,11 +6,15 @@
 #include "core/common/inlined_containers.h"
 #include "core/framework/op_kernel.h"
 
-#include <locale>
+#include <memory>
 #include <string>
 
 namespace onnxruntime {
 
+namespace string_normalizer {
+class Locale;
+}  // namespace string_normalizer
+
 class StringNormalizer : public OpKernel {
  public:
   enum CaseAction {
@@ -20,7 +24,7 @@ class StringNormalizer : public OpKernel {
   };
 
   explicit StringNormalizer(const OpKernelInfo& info);
-  ~StringNormalizer() override = default;
+  ~StringNormalizer() override;
 
   Status Compute(OpKernelContext* ctx) const override;
 
@@ -31,9 +35,13 @@ class StringNormalizer : public OpKernel {
   // used for case-insensitive compare
   CaseAction compare_caseaction_{LOWER};
   std::string locale_name_;
-  // Either if these are populated but not both
+  // Only created when the case is changed or compared case-insensitively.
+  std::unique_ptr<string_normalizer::Locale> locale_;
+  // True if the locale maps the case of ASCII letters as the C locale does, so that ASCII
+  // strings can be converted without going through wide characters.
+  bool ascii_case_mapping_{false};
+  // UTF-8 stopwords, converted to compare_caseaction_ for case-insensitive comparisons.
   InlinedHashSet<std::string> stopwords_;
-  InlinedHashSet<std::wstring> wstopwords_;
 };
 
 }  // namespace onnxruntime
@@ -0,0 +1,217 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/carried_state.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "core/common/string_utils.h"
+#include "core/framework/session_state.h"
+#include "core/framework/tensor.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/node_arg.h"
+
+namespace onnxruntime {
+
+namespace {
+
+const NodeArg* FindDef(const std::vector<const NodeArg*>& defs, std::string_view name) {
+  auto it = std::find_if(defs.cbegin(), defs.cend(), [name](const NodeArg* def) { return def->Name() == name; });
+  return it != defs.cend() ? *it : nullptr;
+}
+
+template <typename Names>
+size_t FindName(const Names& names, const std::string& name) {
+  return static_cast<size_t>(std::find(names.begin(), names.end(), name) - names.begin());
+}
+
+// the shape of def if all its dimensions are known
+std::optional<TensorShape> GetStaticShape(const NodeArg& def) {
+  const auto* shape = def.Shape();
+  if (shape == nullptr ||
+      !std::all_of(shape->dim().begin(), shape->dim().end(),
+                   [](const ONNX_NAMESPACE::TensorShapeProto_Dimension& dim) { return utils::HasDimValue(dim); })) {
+    return std::nullopt;
+  }
+
+  return utils::GetTensorShapeFromTensorShapeProto(*shape);
+}
+
+// whether the buffer overlaps the one of a tensor in values
+bool IsBufferInUse(const Tensor& buffer, gsl::span<const OrtValue> values) {
+  const auto* begin = static_cast<const std::byte*>(buffer.DataRaw());
+  const auto* end = begin + buffer.SizeInBytes();
+
+  return std::any_of(values.begin(), values.end(), [begin, end](const OrtValue& value) {
+    if (!value.IsTensor()) {
+      return false;
+    }
+
+    const auto& tensor = value.Get<Tensor>();
+    const auto* data = static_cast<const std::byte*>(tensor.DataRaw());
+    return data < end && begin < data + tensor.SizeInBytes();
+  });
+}
+
+}  // namespace
+
+Status CarriedState::Create(const std::string& config, const InputDefList& inputs, const OutputDefList& outputs,
+                            const SessionState& session_state, std::unique_ptr<CarriedState>& carried_state) {
+  auto state = std::make_unique<CarriedState>();
+
+  for (const auto& pair_str : utils::SplitString(config, ";")) {
+    const auto names = utils::SplitString(pair_str, ":", true);
+    ORT_RETURN_IF_NOT(names.size() == 2 && !names[0].empty() && !names[1].empty(),
+                      "Invalid stateful output input pair '", pair_str, "'. Expected 'output_name:input_name'.");
+
+    const NodeArg* output = FindDef(outputs, names[0]);
+    const NodeArg* input = FindDef(inputs, names[1]);
+    ORT_RETURN_IF(output == nullptr, "Stateful output '", names[0], "' is not an output of the model.");
+    ORT_RETURN_IF(input == nullptr, "Stateful input '", names[1], "' is not an input of the model.");
+    ORT_RETURN_IF(output->Type() == nullptr || input->Type() == nullptr || *output->Type() != *input->Type(),
+                  "Stateful output '", output->Name(), "' and input '", input->Name(), "' must have the same type.");
+
+    for (const auto& pair : state->pairs_) {
+      ORT_RETURN_IF(pair.output_name == output->Name() || pair.input_name == input->Name(),
+                    "Stateful output '", output->Name(), "' or input '", input->Name(), "' is used by several pairs.");
+    }
+
+    Pair pair;
+    pair.output_name = output->Name();
+    pair.input_name = input->Name();
+    pair.output_shape = GetStaticShape(*output);
+
+    // keep the carried value where it is consumed, like the device copy of the feeds would
+    InlinedVector<SessionState::NodeInfo> node_info_vec;
+    if (session_state.GetInputNodeInfo(pair.input_name, node_info_vec).IsOK() &&
+        !node_info_vec.empty() && node_info_vec.front().p_node != nullptr) {
+      pair.device = *node_info_vec.front().device;
+    }
+
+    state->pairs_.push_back(std::move(pair));
+  }
+
+  ORT_RETURN_IF(state->pairs_.empty(), "No stateful output input pair in '", config, "'.");
+
+  carried_state = std::move(state);
+  return Status::OK();
+}
+
+void CarriedState::Reset() {
+  for (auto& pair : pairs_) {
+    pair.value = OrtValue();
+    pair.value_is_owned = false;
+    pair.spare = OrtValue();
+    pair.shape_is_stable = false;
+  }
+}
+
+Status CarriedState::PrepareRun(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                gsl::span<const std::string> output_names, const std::vector<OrtValue>& fetches,
+                                const std::vector<OrtDevice>* fetches_device_info, RunArgs& args) const {
+  args.feed_names.assign(feed_names.begin(), feed_names.end());
+  args.feeds.assign(feeds.begin(), feeds.end());
+  args.output_names.assign(output_names.begin(), output_names.end());
+  args.fetches = fetches;
+  args.fetches.resize(output_names.size());
+  args.num_outputs = output_names.size();
+
+  args.fetch_indices.clear();
+  args.output_requested.clear();
+  args.input_fed.clear();
+
+  bool adds_fetches = false;
+  for (const auto& pair : pairs_) {
+    const size_t feed_index = FindName(feed_names, pair.input_name);
+    const bool input_fed = feed_index < feed_names.size();
+    if (!input_fed) {
+      ORT_RETURN_IF_NOT(pair.value.IsAllocated(), "Stateful input '", pair.input_name,
+                        "' has no value carried from output '", pair.output_name,
+                        "'. It must be fed by the first run and by the runs that reset the state.");
+      args.feed_names.push_back(pair.input_name);
+      args.feeds.push_back(pair.value);
+    }
+
+    size_t fetch_index = FindName(output_names, pair.output_name);
+    const bool output_requested = fetch_index < output_names.size();
+    if (!output_requested) {
+      fetch_index = args.output_names.size();
+      args.output_names.push_back(pair.output_name);
+
+      // the output is written in the buffer fed to the previous run when it is known to have its shape: a
+      // pre-allocated fetch of another shape fails the run
+      const bool use_spare = !input_fed && pair.output_shape.has_value() && pair.shape_is_stable &&
+                             pair.spare.IsAllocated() && pair.spare.IsTensor() &&
+                             pair.spare.Get<Tensor>().Shape() == *pair.output_shape;
+      args.fetches.push_back(use_spare ? pair.spare : OrtValue());
+      adds_fetches = true;
+    }
+
+    args.fetch_indices.push_back(fetch_index);
+    args.output_requested.push_back(output_requested);
+    args.input_fed.push_back(input_fed);
+  }
+
+  args.fetches_device_info.clear();
+  if (adds_fetches) {
+    // the caller gets its outputs on CPU unless it tells otherwise, the carried ones stay where they are consumed
+    if (fetches_device_info != nullptr) {
+      args.fetches_device_info.assign(fetches_device_info->begin(), fetches_device_info->end());
+    }
+    args.fetches_device_info.resize(output_names.size());
+    for (size_t i = 0; i < pairs_.size(); ++i) {
+      if (!args.output_requested[i]) {
+        args.fetches_device_info.push_back(pairs_[i].device);
+      }
+    }
+  } else if (fetches_device_info != nullptr) {
+    args.fetches_device_info = *fetches_device_info;
+  }
+
+  return Status::OK();
+}
+
+void CarriedState::FinishRun(RunArgs& args, std::vector<OrtValue>& fetches) {
+  // the feeds of the caller come before the carried ones
+  const auto num_carried_feeds = static_cast<size_t>(std::count(args.input_fed.begin(), args.input_fed.end(), false));
+  const auto caller_feeds = gsl::make_span(args.feeds).first(args.feeds.size() - num_carried_feeds);
+
+  // the value fed by this run can hold the output of the next one unless the caller has it, or an output of this run
+  // or another spare uses its buffer, e.g. if a node forwarded it to an output or two pairs were fed the same value
+  InlinedVector<OrtValue> spares(pairs_.size());
+  for (size_t i = 0; i < pairs_.size(); ++i) {
+    const auto& pair = pairs_[i];
+    if (!args.input_fed[i] && pair.value_is_owned && pair.value.IsTensor()) {
+      const auto& fed = pair.value.Get<Tensor>();
+      if (!IsBufferInUse(fed, args.fetches) && !IsBufferInUse(fed, spares)) {
+        spares[i] = pair.value;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < pairs_.size(); ++i) {
+    auto& pair = pairs_[i];
+    const OrtValue& output = args.fetches[args.fetch_indices[i]];
+
+    pair.shape_is_stable = pair.output_shape.has_value() && output.IsTensor() &&
+                           output.Get<Tensor>().Shape() == *pair.output_shape;
+    pair.spare = std::move(spares[i]);
+
+    // an output forwarding a feed of the caller shares its buffer
+    pair.value = output;
+    pair.value_is_owned = !args.output_requested[i] &&
+                          !(output.IsTensor() && IsBufferInUse(output.Get<Tensor>(), caller_feeds));
+  }
+
+  args.fetches.resize(args.num_outputs);
+  fetches = std::move(args.fetches);
+}
+
+void CarriedState::AbortRun() {
+  for (auto& pair : pairs_) {
+    pair.shape_is_stable = false;
+  }
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gsl/gsl>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/framework/framework_common.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/tensor_shape.h"
+
+namespace onnxruntime {
+
+class SessionState;
+
+/**
+ * Values carried from outputs of a model to its inputs between the Run calls of a session, like the recurrent state
+ * or the attention caches of a step-wise model run one chunk at a time (see kOrtSessionOptionsStatefulOutputInputPairs).
+ *
+ * The value of a carried output stays on the device its input is consumed on and is fed to the next run when the
+ * caller doesn't feed the input. When the model gives the carried output a static shape and the runs produce it, the
+ * buffer fed in a run is reused for the output of the next one, so the runs of a stream alternate between two buffers
+ * instead of allocating one per run.
+ *
+ * The runs of a session with carried values depend on each other, so they are serialized with Mutex().
+ */
+class CarriedState {
+ public:
+  // Arguments of a run of the session, with the carried inputs and outputs added to the ones of the caller.
+  struct RunArgs {
+    InlinedVector<std::string> feed_names;
+    InlinedVector<OrtValue> feeds;
+    InlinedVector<std::string> output_names;
+    std::vector<OrtValue> fetches;
+    std::vector<OrtDevice> fetches_device_info;
+    // number of outputs requested by the caller, the first ones of output_names
+    size_t num_outputs = 0;
+    // index of the fetch of each pair, and whether the caller requested it or feeds the input
+    InlinedVector<size_t> fetch_indices;
+    InlinedVector<bool> output_requested;
+    InlinedVector<bool> input_fed;
+  };
+
+  /**
+   * Creates the carried state of a session from the value of kOrtSessionOptionsStatefulOutputInputPairs,
+   * "output_0:input_0;output_1:input_1". The session state must be finalized.
+   */
+  static Status Create(const std::string& config, const InputDefList& inputs, const OutputDefList& outputs,
+                       const SessionState& session_state, std::unique_ptr<CarriedState>& carried_state);
+
+  std::mutex& Mutex() { return mutex_; }
+
+  // Drops the carried values, the carried inputs must be fed by the next run.
+  void Reset();
+
+  // Adds the carried values the caller doesn't feed, and the carried outputs the caller doesn't request, to the
+  // arguments of a run.
+  Status PrepareRun(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                    gsl::span<const std::string> output_names, const std::vector<OrtValue>& fetches,
+                    const std::vector<OrtDevice>* fetches_device_info, RunArgs& args) const;
+
+  // Keeps the carried outputs of a successful run for the next one and returns the fetches of the caller.
+  void FinishRun(RunArgs& args, std::vector<OrtValue>& fetches);
+
+  // Stops reusing buffers for the carried outputs after a failed run, until a run produces their static shapes again.
+  void AbortRun();
+
+ private:
+  struct Pair {
+    std::string output_name;
+    std::string input_name;
+    // device of the nodes consuming the input
+    OrtDevice device;
+    // value fed to the next run
+    OrtValue value;
+    // the value was not returned to the caller and doesn't share the buffer of one of its feeds, so the buffer can be
+    // reused once it has been fed
+    bool value_is_owned = false;
+    // buffer of the value fed to the previous run, used for the output of the next one
+    OrtValue spare;
+    // shape of the output in the model, if it is static. a buffer is only reused for an output of this shape
+    std::optional<TensorShape> output_shape;
+    // the output of the last run has the static shape
+    bool shape_is_stable = false;
+  };
+
+  std::vector<Pair> pairs_;
+  std::mutex mutex_;
+};
+
+}  // namespace onnxruntime
@@ -3,12 +3,14 @@
 
 #include "core/session/ep_library_internal.h"
 
+#include "core/common/parse_string.h"
 #include "core/framework/session_options.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/abi_devices.h"
 #include "core/session/abi_logger.h"
 #include "core/session/abi_session_options_impl.h"
 #include "core/session/ort_apis.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
 #if defined(USE_DML)
 #include "core/providers/dml/dml_provider_factory_creator.h"
@@ -42,6 +44,12 @@ std::unique_ptr<EpLibraryInternal> EpLibraryInternal::CreateCpuEp() {
     }
 
     CPUExecutionProviderInfo epi{session_options->value.enable_cpu_mem_arena};
+    const std::string numa_node_str =
+        session_options->value.config_options.GetConfigOrDefault(kOrtSessionOptionsNumaNode, "-1");
+    if (!TryParseStringWithClassicLocale<int>(numa_node_str, epi.numa_node) || epi.numa_node < -1) {
+      return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT,
+                                   ("Invalid value for session.numa_node: " + numa_node_str).c_str());
+    }
     *ep = std::make_unique<CPUExecutionProvider>(epi);
     (*ep)->SetLogger(session_logger->ToInternal());
 
@@ -68,6 +68,7 @@
 #include "core/providers/dml/DmlExecutionProvider/src/ExecutionProvider.h"
 #include "core/optimizer/stft_decomposition.h"
 #endif
+#include "core/session/carried_state.h"
 #include "core/session/environment.h"
 #include "core/session/IOBinding.h"
 #include "core/session/inference_session_utils.h"
@@ -418,6 +419,14 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
   use_per_session_threads_ = session_options.use_per_session_threads;
   force_spinning_stop_between_runs_ = session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigForceSpinningStop, "0") == "1";
 
+  const std::string numa_node_str = session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsNumaNode, "-1");
+  ORT_ENFORCE(TryParseStringWithClassicLocale<int>(numa_node_str, numa_node_) && numa_node_ >= -1,
+              "Invalid value for ", kOrtSessionOptionsNumaNode, ": ", numa_node_str);
+  if (numa_node_ >= 0 && !use_per_session_threads_) {
+    LOGS(*session_logger_, WARNING) << "The session is pinned to NUMA node " << numa_node_
+                                    << " but uses the global thread pools, only its memory is placed on the node";
+  }
+
   if (use_per_session_threads_) {
     LOGS(*session_logger_, INFO) << "Creating and using per session threadpools since use_per_session_threads_ is true";
     {
@@ -449,6 +458,7 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         to.auto_set_affinity = to.thread_pool_size == 0 &&
                                session_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL &&
                                to.affinity_str.empty();
+        to.numa_node = numa_node_;
 
         if (to.custom_create_thread_fn) {
           ORT_ENFORCE(to.custom_join_thread_fn, "custom join thread function not set for intra op thread pool");
@@ -464,6 +474,7 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
             session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigAllowInterOpSpinning, "1") == "1";
         OrtThreadPoolParams to = session_options_.inter_op_param;
         to.auto_set_affinity = to.thread_pool_size == 0 && session_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL;
+        to.numa_node = numa_node_;
         std::basic_stringstream<ORTCHAR_T> ss;
         if (to.name) {
           ss << to.name << ORT_TSTR("-");
@@ -1846,6 +1857,7 @@ common::Status InferenceSession::Initialize() {
     if (!have_cpu_ep) {
       LOGS(*session_logger_, INFO) << "Adding default CPU execution provider.";
       CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena};
+      epi.numa_node = numa_node_;
       auto p_cpu_exec_provider = std::make_unique<CPUExecutionProvider>(epi);
       ORT_RETURN_IF_ERROR_SESSIONID_(RegisterExecutionProvider(std::move(p_cpu_exec_provider)));
       execution_providers_.SetCpuProviderWasImplicitlyAdded(true);
@@ -2249,6 +2261,14 @@ common::Status InferenceSession::Initialize() {
     // Resolve memory pattern flags of the main graph and subgraph session states
     ResolveMemoryPatternFlags(*session_state_);
 
+    const std::string stateful_output_input_pairs =
+        session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsStatefulOutputInputPairs, "");
+    if (!stateful_output_input_pairs.empty()) {
+      ORT_RETURN_IF_ERROR_SESSIONID_(CarriedState::Create(stateful_output_input_pairs,
+                                                          graph.GetInputsIncludingInitializers(), graph.GetOutputs(),
+                                                          *session_state_, carried_state_));
+    }
+
     is_inited_ = true;
 
     if (!using_ort_model_bytes_for_initializers_) {
@@ -2664,6 +2684,38 @@ Status InferenceSession::Run(const RunOptions& run_options,
                              gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
                              gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
                              const std::vector<OrtDevice>* p_fetches_device_info) {
+  if (carried_state_ == nullptr) {
+    return RunImpl(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info);
+  }
+
+  ORT_RETURN_IF(p_fetches == nullptr, "Output vector pointer is NULL");
+
+  // the runs depend on the values carried by the previous ones, so they run one at a time
+  std::lock_guard<std::mutex> lock(carried_state_->Mutex());
+
+  if (run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigResetSessionState, "0") == "1") {
+    carried_state_->Reset();
+  }
+
+  CarriedState::RunArgs args;
+  ORT_RETURN_IF_ERROR_SESSIONID_(carried_state_->PrepareRun(feed_names, feeds, output_names, *p_fetches,
+                                                            p_fetches_device_info, args));
+  auto status = RunImpl(run_options, args.feed_names, args.feeds, args.output_names, &args.fetches,
+                        args.fetches_device_info.empty() ? nullptr : &args.fetches_device_info);
+  if (!status.IsOK()) {
+    // the carried values are unchanged, but the next run doesn't write an output in a buffer of the failed one
+    carried_state_->AbortRun();
+    return status;
+  }
+
+  carried_state_->FinishRun(args, *p_fetches);
+  return Status::OK();
+}
+
+Status InferenceSession::RunImpl(const RunOptions& run_options,
+                                 gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                 gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
+                                 const std::vector<OrtDevice>* p_fetches_device_info) {
   TimePoint tp;
   if (session_profiler_.IsEnabled()) {
     tp = session_profiler_.Start();
@@ -2875,7 +2927,7 @@ Status InferenceSession::Run(const RunOptions& run_options,
       cached_execution_provider_for_graph_replay_.AllowGraphCaptureOnRun(graph_annotation_id) &&
       !cached_execution_provider_for_graph_replay_.IsGraphCaptured(graph_annotation_id)) {
     LOGS(*session_logger_, INFO) << "Start another run for necessary memory allocation or graph capture.";
-    ORT_RETURN_IF_ERROR(Run(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info));
+    ORT_RETURN_IF_ERROR(RunImpl(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info));
   }
   return retval;
 }
@@ -51,6 +51,7 @@ class ModelProto;
 struct OrtModel;
 
 namespace onnxruntime {  // forward declarations
+class CarriedState;
 class CustomRegistry;
 class Environment;
 class GraphTransformer;
@@ -728,6 +729,12 @@ class InferenceSession {
   [[nodiscard]] common::Status CheckShapes(const std::string& input_name, const TensorShape& input_shape,
                                            const TensorShape& expected_shape, const char* input_output_moniker) const;
 
+  // Runs the graph with the feeds and fetches of Run, which adds the carried values of a stateful session to them.
+  [[nodiscard]] common::Status RunImpl(const RunOptions& run_options, gsl::span<const std::string> feed_names,
+                                       gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
+                                       std::vector<OrtValue>* p_fetches,
+                                       const std::vector<OrtDevice>* p_fetches_device_info);
+
   [[nodiscard]] common::Status ValidateInputs(gsl::span<const std::string> feed_names,
                                               gsl::span<const OrtValue> feeds) const;
 
@@ -810,6 +817,9 @@ class InferenceSession {
   // It has a dependency on execution_providers_.
   std::unique_ptr<SessionState> session_state_;
 
+  // Values carried from outputs to inputs between runs, see kOrtSessionOptionsStatefulOutputInputPairs.
+  std::unique_ptr<CarriedState> carried_state_;
+
   // Threadpools per session. These are initialized and used for the entire duration of the session
   // when use_per_session_threads is true.
   std::basic_string<ORTCHAR_T> thread_pool_name_;
@@ -821,6 +831,9 @@ class InferenceSession {
   // Spinning is restarted on the next Run()
   bool force_spinning_stop_between_runs_ = false;
 
+  // NUMA node the session threads and CPU memory are pinned to, -1 if not pinned. See kOrtSessionOptionsNumaNode.
+  int numa_node_ = -1;
+
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> thread_pool_;
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> inter_op_thread_pool_;
 
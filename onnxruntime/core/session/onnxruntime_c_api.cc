@@ -1101,6 +1101,30 @@ ORT_API_STATUS_IMPL(OrtApis::FillStringTensor, _Inout_ OrtValue* value, _In_ con
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtApis::FillStringTensorFromBuffer, _Inout_ OrtValue* value, _In_reads_(s_len) const char* s,
+                    size_t s_len, _In_reads_(offsets_len) const size_t* offsets, size_t offsets_len) {
+  TENSOR_READWRITE_API_BEGIN
+  auto* dst = tensor->MutableData<std::string>();
+  const auto len = static_cast<size_t>(tensor->Shape().Size());
+  if (offsets_len != len) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "offsets array doesn't equal tensor size");
+  }
+  // validate all the offsets first so that the tensor is left unchanged on error
+  for (size_t i = 0; i != len; ++i) {
+    const size_t end = i + 1 == len ? s_len : offsets[i + 1];
+    if (offsets[i] > end || end > s_len) {
+      return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "offsets must be increasing and within the buffer");
+    }
+  }
+  for (size_t i = 0; i != len; ++i) {
+    const size_t end = i + 1 == len ? s_len : offsets[i + 1];
+    // reuses the capacity of the string if it already has some
+    dst[i].assign(s + offsets[i], end - offsets[i]);
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtApis::FillStringTensorElement, _Inout_ OrtValue* value, _In_ const char* s, size_t index) {
   TENSOR_READWRITE_API_BEGIN
   auto* dst = tensor->MutableData<std::string>();
@@ -2225,6 +2249,10 @@ ORT_API_STATUS_IMPL(OrtApis::CreateArenaCfgV2, _In_reads_(num_keys) const char*
       cfg->initial_growth_chunk_size_bytes = static_cast<int>(arena_config_values[i]);
     } else if (strcmp(arena_config_keys[i], "max_power_of_two_extend_bytes") == 0) {
       cfg->max_power_of_two_extend_bytes = static_cast<int64_t>(arena_config_values[i]);
+    } else if (strcmp(arena_config_keys[i], "max_thread_cache_bytes") == 0) {
+      cfg->max_thread_cache_bytes = static_cast<int64_t>(arena_config_values[i]);
+    } else if (strcmp(arena_config_keys[i], "use_slab_arena") == 0) {
+      cfg->use_slab_arena = static_cast<int>(arena_config_values[i]);
     } else {
       std::ostringstream oss;
       oss << "Invalid key found: " << arena_config_keys[i];
@@ -3013,6 +3041,8 @@ static constexpr OrtApi ort_api_1_to_23 = {
     &OrtApis::EpDevice_EpOptions,
     &OrtApis::EpDevice_Device,
     // End of Version 22 - DO NOT MODIFY ABOVE (see above text for more information)
+
+    &OrtApis::FillStringTensorFromBuffer,
 };
 
 // OrtApiBase can never change as there is no way to know what version of OrtApiBase is returned by OrtGetApiBase.
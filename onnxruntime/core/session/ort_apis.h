@@ -588,4 +588,7 @@ ORT_API(const char*, EpDevice_EpVendor, _In_ const OrtEpDevice* ep_device);
 ORT_API(const OrtKeyValuePairs*, EpDevice_EpMetadata, _In_ const OrtEpDevice* ep_device);
 ORT_API(const OrtKeyValuePairs*, EpDevice_EpOptions, _In_ const OrtEpDevice* ep_device);
 ORT_API(const OrtHardwareDevice*, EpDevice_Device, _In_ const OrtEpDevice* ep_device);
+
+ORT_API_STATUS_IMPL(FillStringTensorFromBuffer, _Inout_ OrtValue* value, _In_reads_(s_len) const char* s,
+                    size_t s_len, _In_reads_(offsets_len) const size_t* offsets, size_t offsets_len);
 }  // namespace OrtApis
@@ -22,6 +22,7 @@ std::ostream& operator<<(std::ostream& os, const OrtThreadPoolParams& params) {
   os << " dynamic_block_base_: " << params.dynamic_block_base_;
   os << " stack_size: " << params.stack_size;
   os << " affinity_str: " << params.affinity_str;
+  os << " numa_node: " << params.numa_node;
   // os << " name: " << (params.name ? params.name : L"nullptr");
   os << " set_denormal_as_zero: " << params.set_denormal_as_zero;
   // os << " custom_create_thread_fn: " << (params.custom_create_thread_fn ? "set" : "nullptr");
@@ -92,6 +93,27 @@ static std::vector<LogicalProcessors> ReadThreadAffinityConfig(const std::string
 static std::unique_ptr<ThreadPool>
 CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
   ThreadOptions to;
+  if (options.numa_node >= 0 && options.affinity_str.empty()) {
+    auto node_affinities = Env::Default().GetNumaNodeThreadAffinities(options.numa_node);
+    if (node_affinities.empty()) {
+      LOGS_DEFAULT(WARNING) << "NUMA node " << options.numa_node
+                            << " is not available, thread pool is not pinned to a NUMA node";
+    } else if (options.thread_pool_size <= 0) {
+      // one thread per physical core of the node, the first core is for the main thread
+      if (node_affinities.size() <= 1) {
+        return nullptr;
+      }
+      options.thread_pool_size = static_cast<int>(node_affinities.size());
+      to.affinities = std::move(node_affinities);
+    } else {
+      // more or less threads than cores, let them float over the node
+      LogicalProcessors node_processors;
+      for (const auto& core : node_affinities) {
+        node_processors.insert(node_processors.end(), core.begin(), core.end());
+      }
+      to.affinities.assign(static_cast<size_t>(options.thread_pool_size), node_processors);
+    }
+  }
   if (options.thread_pool_size <= 0) {  // default
     if (options.auto_set_affinity) {
 #ifdef _WIN32
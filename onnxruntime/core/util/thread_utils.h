@@ -37,6 +37,11 @@ struct OrtThreadPoolParams {
   // meaning ith thread will be attached to first 8 logical processors
   std::string affinity_str;
 
+  // If it is non-negative and affinity_str is empty, the threads are pinned to the logical processors of this NUMA
+  // node. With thread_pool_size = 0, the pool gets one thread per physical core of the node. Ignored if the node
+  // doesn't exist or the platform doesn't report NUMA information.
+  int numa_node = -1;
+
   const ORTCHAR_T* name = nullptr;
 
   // Set or unset denormal as zero
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/graph/model.h"
+#include "core/session/onnxruntime_cxx_api.h"
+
+extern std::unique_ptr<Ort::Env> ort_env;
+
+namespace onnxruntime {
+namespace test {
+
+// Serialize the generation model (GreedySearch, Sampling) at model_path with the given EOS token. When fix_batch_size
+// is set, the batch dimension of the past state of the decoder subgraph is fixed, so finished sequences are not
+// dropped from the decoder inputs.
+inline std::string MakeGenerationModel(const ORTCHAR_T* model_path, int64_t eos_token_id,
+                                       int64_t fix_batch_size = 0) {
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ORT_THROW_IF_ERROR(Model::Load(model_path, model_proto));
+
+  auto* node = model_proto.mutable_graph()->mutable_node(0);
+  for (auto& attribute : *node->mutable_attribute()) {
+    if (attribute.name() == "eos_token_id") {
+      attribute.set_i(eos_token_id);
+    } else if (attribute.name() == "decoder" && fix_batch_size > 0) {
+      for (auto& input : *attribute.mutable_g()->mutable_input()) {
+        if (input.name().rfind("past_", 0) == 0) {
+          auto* batch_dim = input.mutable_type()->mutable_tensor_type()->mutable_shape()->mutable_dim(1);
+          batch_dim->set_dim_value(fix_batch_size);
+        }
+      }
+    }
+  }
+
+  std::string model_data;
+  ORT_ENFORCE(model_proto.SerializeToString(&model_data));
+  return model_data;
+}
+
+// Run a generation model (GreedySearch, Sampling) on the CPU and return its sequences output,
+// of shape (batch_size, max_length) as the models have num_return_sequences 1.
+inline std::vector<int32_t> RunGenerationModel(Ort::Session& session,
+                                               std::vector<int32_t> input_ids,
+                                               std::vector<int64_t> input_ids_shape,
+                                               int32_t max_length,
+                                               int32_t min_length = 1,
+                                               float repetition_penalty = 1.0f) {
+  std::vector<int64_t> parameter_shape{1};
+  Ort::MemoryInfo info("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault);
+  std::vector<Ort::Value> ort_inputs;
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, input_ids.data(), input_ids.size(), input_ids_shape.data(), input_ids_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, &max_length, 1, parameter_shape.data(), parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, &min_length, 1, parameter_shape.data(), parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, &repetition_penalty, 1, parameter_shape.data(), parameter_shape.size()));
+  const char* input_names[] = {"input_ids", "max_length", "min_length", "repetition_penalty"};
+  const char* const output_names[] = {"sequences"};
+
+  auto ort_outputs = session.Run(Ort::RunOptions{}, input_names, ort_inputs.data(), ort_inputs.size(),
+                                 output_names, 1);
+  const auto* result_vals = ort_outputs[0].GetTensorData<int32_t>();
+  return std::vector<int32_t>(result_vals, result_vals + input_ids_shape[0] * max_length);
+}
+
+// Same as above with a new session of the serialized model.
+inline std::vector<int32_t> RunGenerationModel(const std::string& model_data,
+                                               std::vector<int32_t> input_ids,
+                                               std::vector<int64_t> input_ids_shape,
+                                               int32_t max_length,
+                                               int32_t min_length = 1,
+                                               float repetition_penalty = 1.0f) {
+  Ort::SessionOptions session_options;
+  Ort::Session session(*ort_env, model_data.data(), model_data.size(), session_options);
+  return RunGenerationModel(session, std::move(input_ids), std::move(input_ids_shape), max_length, min_length,
+                            repetition_penalty);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -1,12 +1,18 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <memory>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include <gsl/gsl>
+#include "core/graph/model.h"
 #include "core/session/onnxruntime_cxx_api.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/common/cuda_op_test_utils.h"
+#include "test/contrib_ops/generation_test_utils.h"
+#include "test/util/include/asserts.h"
 
 #ifdef USE_CUDA
 #include "core/providers/cuda/cuda_provider_options.h"
@@ -183,5 +189,155 @@ TEST(GreedySearchTest, GptGreedySearchFp32) {
   }
 }
 
+namespace {
+// Run greedy search of a single sequence with repetition penalty on CPU, and return the generated sequence.
+std::vector<int32_t> RunGptGreedySearch(Ort::Session& session, const std::vector<int32_t>& input_ids,
+                                        int32_t max_length) {
+  return RunGenerationModel(session, input_ids, {1, static_cast<int64_t>(input_ids.size())}, max_length, 1, 1.1f);
+}
+}  // namespace
+
+TEST(GreedySearchTest, GptGreedySearchSpeculativeDecoding) {
+  // Use the decoder itself as the draft decoder. The draft tokens are selected after the logits processors like the
+  // verified tokens, so the result shall be the same as greedy search without draft decoder, with or without
+  // repetition penalty. Without repetition penalty, the prompt generates 731 then 114 (see
+  // GptGreedySearchCompactFinishedSequences), so with 114 as EOS the search stops in the middle of a draft.
+  constexpr int64_t eos_token_id = 114;
+  const std::string model_data =
+      MakeGenerationModel(ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx"),
+                          eos_token_id);
+
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ASSERT_TRUE(model_proto.ParseFromString(model_data));
+  auto* node = model_proto.mutable_graph()->mutable_node(0);
+  ASSERT_EQ(node->op_type(), "GreedySearch");
+  int64_t pad_token_id = -1;
+  for (const auto& attribute : node->attribute()) {
+    if (attribute.name() == "pad_token_id") {
+      pad_token_id = attribute.i();
+    }
+  }
+  for (const auto& attribute : node->attribute()) {
+    if (attribute.name() == "decoder") {
+      auto* draft_decoder = node->add_attribute();
+      *draft_decoder = attribute;
+      draft_decoder->set_name("draft_decoder");
+      break;
+    }
+  }
+  auto* num_speculative_tokens = node->add_attribute();
+  num_speculative_tokens->set_name("num_speculative_tokens");
+  num_speculative_tokens->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_INT);
+  num_speculative_tokens->set_i(3);
+  std::string speculative_model_data;
+  ASSERT_TRUE(model_proto.SerializeToString(&speculative_model_data));
+
+  Ort::SessionOptions session_options;
+  Ort::Session session(*ort_env, model_data.data(), model_data.size(), session_options);
+  Ort::Session speculative_session(*ort_env, speculative_model_data.data(), speculative_model_data.size(),
+                                   session_options);
+
+  // EOS is replaced by the pad token in the output, and tokens after it are not generated, so compare the sequences
+  // up to the first pad token after the prompt.
+  std::vector<int32_t> input_ids{0, 0, 195, 731};
+  std::vector<int64_t> input_ids_shape{1, static_cast<int64_t>(input_ids.size())};
+  auto until_eos = [&](std::vector<int32_t> sequence) {
+    auto eos = std::find(sequence.begin() + input_ids.size(), sequence.end(), pad_token_id);
+    sequence.erase(eos == sequence.end() ? eos : eos + 1, sequence.end());
+    return sequence;
+  };
+
+  constexpr int32_t max_length = 14;
+  const std::vector<int32_t> expected_output =
+      until_eos(RunGenerationModel(session, input_ids, input_ids_shape, max_length));
+  ASSERT_LT(expected_output.size(), static_cast<size_t>(max_length));
+  ASSERT_EQ(expected_output, until_eos(RunGenerationModel(speculative_session, input_ids, input_ids_shape,
+                                                          max_length)));
+
+  ASSERT_EQ(until_eos(RunGenerationModel(session, input_ids, input_ids_shape, max_length, 1, 1.1f)),
+            until_eos(RunGenerationModel(speculative_session, input_ids, input_ids_shape, max_length, 1, 1.1f)));
+}
+
+TEST(GreedySearchTest, GptGreedySearchPrefixCache) {
+  Ort::SessionOptions session_options;
+  Ort::Session session(*ort_env, ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx"),
+                       session_options);
+
+  Ort::SessionOptions cached_session_options;
+  cached_session_options.AddConfigEntry(kOrtSessionOptionsGenerationPrefixCacheSizeInBytes, "1048576");
+  Ort::Session cached_session(*ort_env,
+                              ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx"),
+                              cached_session_options);
+
+  std::vector<int32_t> prompt{195, 731, 114, 52};
+  std::vector<int32_t> longer_prompt{195, 731, 114, 52, 204, 33};
+  std::vector<int32_t> expected_output = RunGptGreedySearch(session, prompt, 12);
+  std::vector<int32_t> expected_longer_output = RunGptGreedySearch(session, longer_prompt, 12);
+
+  // The first run fills the cache, the second run uses the whole cached prompt,
+  // and the third run computes only the tokens after the cached prompt.
+  ASSERT_EQ(expected_output, RunGptGreedySearch(cached_session, prompt, 12));
+  ASSERT_EQ(expected_output, RunGptGreedySearch(cached_session, prompt, 12));
+  ASSERT_EQ(expected_longer_output, RunGptGreedySearch(cached_session, longer_prompt, 12));
+}
+
+TEST(GreedySearchTest, GptGreedySearchPrefixCacheSharedPrefix) {
+  Ort::SessionOptions session_options;
+  Ort::Session session(*ort_env, ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx"),
+                       session_options);
+
+  Ort::SessionOptions cached_session_options;
+  cached_session_options.AddConfigEntry(kOrtSessionOptionsGenerationPrefixCacheSizeInBytes, "1048576");
+  Ort::Session cached_session(*ort_env,
+                              ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx"),
+                              cached_session_options);
+
+  // A system prompt followed by two different questions, then the system prompt alone.
+  std::vector<int32_t> first_prompt{195, 731, 114, 52, 204, 33};
+  std::vector<int32_t> second_prompt{195, 731, 114, 52, 88, 17, 301};
+  std::vector<int32_t> system_prompt{195, 731, 114, 52};
+  std::vector<int32_t> expected_first_output = RunGptGreedySearch(session, first_prompt, 12);
+  std::vector<int32_t> expected_second_output = RunGptGreedySearch(session, second_prompt, 12);
+  std::vector<int32_t> expected_system_output = RunGptGreedySearch(session, system_prompt, 12);
+
+  // The second run uses past state of the system prompt in the entry of the first prompt, and the third run uses the
+  // first tokens of the system prompt since logits of its last token are not cached.
+  ASSERT_EQ(expected_first_output, RunGptGreedySearch(cached_session, first_prompt, 12));
+  ASSERT_EQ(expected_second_output, RunGptGreedySearch(cached_session, second_prompt, 12));
+  ASSERT_EQ(expected_system_output, RunGptGreedySearch(cached_session, system_prompt, 12));
+}
+
+TEST(GreedySearchTest, GptGreedySearchCompactFinishedSequences) {
+  // The second sequence generates 731 then 114, and the third one, which is the second one after its first step,
+  // generates 114 first. The other sequences never generate 114.
+  constexpr int64_t eos_token_id = 114;
+  const int64_t batch_size = 4;
+  std::vector<int32_t> input_ids{
+      0, 0, 0, 52,
+      0, 0, 195, 731,
+      0, 195, 731, 731,
+      0, 0, 0, 52};
+  std::vector<int64_t> input_ids_shape{batch_size, 4};
+  constexpr int32_t max_length = 12;
+  auto run = [&](const std::string& model_data) {
+    return RunGenerationModel(model_data, input_ids, input_ids_shape, max_length);
+  };
+
+  const ORTCHAR_T* model_path = ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx");
+  const std::vector<int32_t> expected_output = run(MakeGenerationModel(model_path, eos_token_id, batch_size));
+
+  // Some sequences must finish before the others for the decoder inputs to be compacted.
+  size_t finished_sequences = 0;
+  for (int64_t i = 0; i < batch_size; i++) {
+    auto sequence = gsl::make_span(expected_output)
+                        .subspan(static_cast<size_t>(i * max_length), static_cast<size_t>(max_length));
+    finished_sequences += std::find(sequence.begin() + 4, sequence.end(), eos_token_id) != sequence.end() ? 1 : 0;
+  }
+  ASSERT_GT(finished_sequences, 0U);
+  ASSERT_LT(finished_sequences, static_cast<size_t>(batch_size));
+
+  ASSERT_EQ(expected_output, run(MakeGenerationModel(model_path, eos_token_id)));
+}
+
 }  // namespace test
 }  // namespace onnxruntime
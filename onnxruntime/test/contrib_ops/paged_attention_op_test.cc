@@ -0,0 +1,409 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+struct PagedAttentionConfig {
+  int num_heads;
+  int kv_num_heads;
+  int head_size;
+  int num_blocks;
+  int block_size;
+  int local_window_size = -1;
+  float softcap = 0.0f;
+  bool smooth_softmax = false;
+  int rotary_dim = 0;  // rotary is applied to the first rotary_dim elements of each head of Q and K when positive
+  bool rotary_interleaved = false;
+  std::vector<int32_t> cumulative_sequence_length;
+  std::vector<int32_t> past_seqlens;
+  std::vector<int32_t> block_table;  // (batch_size, max_num_blocks_per_seq)
+};
+
+// Rounds a float to the precision of T.
+template <typename T>
+float RoundTo(float value) {
+  if constexpr (std::is_same<T, MLFloat16>::value) {
+    return MLFloat16(value).ToFloat();
+  } else {
+    return value;
+  }
+}
+
+template <typename T>
+std::vector<float> RoundTo(std::vector<float> values) {
+  for (auto& value : values) {
+    value = RoundTo<T>(value);
+  }
+  return values;
+}
+
+// Rotate the first rotary_dim elements of each head of the token rows at the given positions, as RotaryEmbedding.
+template <typename T>
+void ApplyRotaryReference(const PagedAttentionConfig& config, int num_heads, const std::vector<int>& positions,
+                          const std::vector<float>& cos_cache, const std::vector<float>& sin_cache,
+                          std::vector<float>& data) {
+  const int half = config.rotary_dim / 2;
+  for (size_t t = 0; t < positions.size(); t++) {
+    for (int n = 0; n < num_heads; n++) {
+      float* head = data.data() + (t * num_heads + n) * config.head_size;
+      const std::vector<float> input(head, head + config.rotary_dim);
+      for (int i = 0; i < config.rotary_dim; i++) {
+        const int cache_index = config.rotary_interleaved ? i / 2 : i % half;
+        const bool second = config.rotary_interleaved ? (i % 2 == 1) : (i >= half);
+        const int j = config.rotary_interleaved ? (second ? i - 1 : i + 1) : (i + half) % config.rotary_dim;
+        const float cos = cos_cache[positions[t] * half + cache_index];
+        const float sin = sin_cache[positions[t] * half + cache_index];
+        head[i] = RoundTo<T>(input[i] * cos + (second ? 1.0f : -1.0f) * input[j] * sin);
+      }
+    }
+  }
+}
+
+// Write the new key/value into the cache and compute the attention output with plain loops.
+template <typename T>
+void ComputeReference(const PagedAttentionConfig& config,
+                      std::vector<float> query,
+                      std::vector<float> key,
+                      const std::vector<float>& value,
+                      const std::vector<float>& cos_cache,
+                      const std::vector<float>& sin_cache,
+                      std::vector<float>& key_cache,
+                      std::vector<float>& value_cache,
+                      std::vector<float>& output) {
+  const int batch_size = static_cast<int>(config.past_seqlens.size());
+  const int max_num_blocks_per_seq = static_cast<int>(config.block_table.size()) / batch_size;
+  const int kv_hidden_size = config.kv_num_heads * config.head_size;
+  const int hidden_size = config.num_heads * config.head_size;
+  const int group_size = config.num_heads / config.kv_num_heads;
+  const float scale = 1.0f / std::sqrt(static_cast<float>(config.head_size));
+
+  auto slot_of = [&](int b, int position) {
+    const int block = config.block_table[b * max_num_blocks_per_seq + position / config.block_size];
+    return (block * config.block_size + position % config.block_size) * kv_hidden_size;
+  };
+
+  if (config.rotary_dim > 0) {
+    std::vector<int> positions;
+    for (int b = 0; b < batch_size; b++) {
+      for (int t = config.cumulative_sequence_length[b]; t < config.cumulative_sequence_length[b + 1]; t++) {
+        positions.push_back(config.past_seqlens[b] + t - config.cumulative_sequence_length[b]);
+      }
+    }
+    ApplyRotaryReference<T>(config, config.num_heads, positions, cos_cache, sin_cache, query);
+    ApplyRotaryReference<T>(config, config.kv_num_heads, positions, cos_cache, sin_cache, key);
+  }
+
+  for (int b = 0; b < batch_size; b++) {
+    for (int t = config.cumulative_sequence_length[b]; t < config.cumulative_sequence_length[b + 1]; t++) {
+      const int slot = slot_of(b, config.past_seqlens[b] + t - config.cumulative_sequence_length[b]);
+      for (int i = 0; i < kv_hidden_size; i++) {
+        key_cache[slot + i] = key[t * kv_hidden_size + i];
+        value_cache[slot + i] = value[t * kv_hidden_size + i];
+      }
+    }
+  }
+
+  output.assign(query.size(), 0.0f);
+  for (int b = 0; b < batch_size; b++) {
+    for (int t = config.cumulative_sequence_length[b]; t < config.cumulative_sequence_length[b + 1]; t++) {
+      const int position = config.past_seqlens[b] + t - config.cumulative_sequence_length[b];
+      const int first = config.local_window_size >= 0 ? std::max(0, position - config.local_window_size) : 0;
+      for (int n = 0; n < config.num_heads; n++) {
+        const int kv_offset = (n / group_size) * config.head_size;
+        const float* q = query.data() + t * hidden_size + n * config.head_size;
+        std::vector<float> scores;
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int j = first; j <= position; j++) {
+          const float* k = key_cache.data() + slot_of(b, j) + kv_offset;
+          float score = 0.0f;
+          for (int h = 0; h < config.head_size; h++) {
+            score += q[h] * k[h];
+          }
+          score *= scale;
+          if (config.softcap > 0.0f) {
+            score = config.softcap * std::tanh(score / config.softcap);
+          }
+          scores.push_back(score);
+          max_score = std::max(max_score, score);
+        }
+        // smooth softmax adds a zero logit to the denominator
+        if (config.smooth_softmax) {
+          max_score = std::max(max_score, 0.0f);
+        }
+        float sum = config.smooth_softmax ? std::exp(-max_score) : 0.0f;
+        for (auto& score : scores) {
+          score = std::exp(score - max_score);
+          sum += score;
+        }
+        float* out = output.data() + t * hidden_size + n * config.head_size;
+        for (int j = first; j <= position; j++) {
+          const float* v = value_cache.data() + slot_of(b, j) + kv_offset;
+          for (int h = 0; h < config.head_size; h++) {
+            out[h] += scores[j - first] / sum * v[h];
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void AddInput(OpTester& test, const char* name, const std::vector<int64_t>& dims, const std::vector<float>& values) {
+  if constexpr (std::is_same<T, MLFloat16>::value) {
+    test.AddInput<MLFloat16>(name, dims, ToFloat16(values));
+  } else {
+    test.AddInput<float>(name, dims, values);
+  }
+}
+
+template <typename T>
+void AddOutput(OpTester& test, const char* name, const std::vector<int64_t>& dims, const std::vector<float>& values) {
+  if constexpr (std::is_same<T, MLFloat16>::value) {
+    test.AddOutput<MLFloat16>(name, dims, ToFloat16(values));
+  } else {
+    test.AddOutput<float>(name, dims, values);
+  }
+}
+
+template <typename T = float>
+void RunPagedAttentionTest(const PagedAttentionConfig& config, bool packed_qkv) {
+  const int batch_size = static_cast<int>(config.past_seqlens.size());
+  const int64_t token_count = config.cumulative_sequence_length.back();
+  const int64_t hidden_size = config.num_heads * config.head_size;
+  const int64_t kv_hidden_size = config.kv_num_heads * config.head_size;
+  const std::vector<int64_t> cache_dims = {config.num_blocks, config.block_size, config.kv_num_heads,
+                                           config.head_size};
+
+  const std::vector<int64_t> query_dims = {token_count, hidden_size};
+  const std::vector<int64_t> kv_dims = {token_count, kv_hidden_size};
+
+  // the values are rounded to T, so that the reference sees the inputs of the kernel
+  RandomValueGenerator random{};
+  const std::vector<float> query = RoundTo<T>(random.Uniform<float>(query_dims, -1.0f, 1.0f));
+  const std::vector<float> key = RoundTo<T>(random.Uniform<float>(kv_dims, -1.0f, 1.0f));
+  const std::vector<float> value = RoundTo<T>(random.Uniform<float>(kv_dims, -1.0f, 1.0f));
+  std::vector<float> key_cache = RoundTo<T>(random.Uniform<float>(cache_dims, -1.0f, 1.0f));
+  std::vector<float> value_cache = RoundTo<T>(random.Uniform<float>(cache_dims, -1.0f, 1.0f));
+
+  OpTester test("PagedAttention", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("num_heads", config.num_heads);
+  test.AddAttribute<int64_t>("kv_num_heads", config.kv_num_heads);
+  test.AddAttribute<int64_t>("local_window_size", config.local_window_size);
+  test.AddAttribute<float>("softcap", config.softcap);
+  test.AddAttribute<int64_t>("smooth_softmax", config.smooth_softmax ? 1 : 0);
+  test.AddAttribute<int64_t>("do_rotary", config.rotary_dim > 0 ? 1 : 0);
+  test.AddAttribute<int64_t>("rotary_interleaved", config.rotary_interleaved ? 1 : 0);
+
+  if (packed_qkv) {
+    std::vector<float> packed;
+    packed.reserve(query.size() + key.size() + value.size());
+    for (int64_t t = 0; t < token_count; t++) {
+      packed.insert(packed.end(), query.begin() + t * hidden_size, query.begin() + (t + 1) * hidden_size);
+      packed.insert(packed.end(), key.begin() + t * kv_hidden_size, key.begin() + (t + 1) * kv_hidden_size);
+      packed.insert(packed.end(), value.begin() + t * kv_hidden_size, value.begin() + (t + 1) * kv_hidden_size);
+    }
+    AddInput<T>(test, "query", {token_count, hidden_size + 2 * kv_hidden_size}, packed);
+    test.AddOptionalInputEdge<T>();
+    test.AddOptionalInputEdge<T>();
+  } else {
+    AddInput<T>(test, "query", query_dims, query);
+    AddInput<T>(test, "key", kv_dims, key);
+    AddInput<T>(test, "value", kv_dims, value);
+  }
+  AddInput<T>(test, "key_cache", cache_dims, key_cache);
+  AddInput<T>(test, "value_cache", cache_dims, value_cache);
+  test.AddInput<int32_t>("cumulative_sequence_length", {batch_size + 1}, config.cumulative_sequence_length);
+  test.AddInput<int32_t>("past_seqlens", {batch_size}, config.past_seqlens);
+  test.AddInput<int32_t>("block_table",
+                         {batch_size, static_cast<int64_t>(config.block_table.size()) / batch_size},
+                         config.block_table);
+
+  // cos and sin of the angles of the positions up to the longest sequence, as in the rotary embedding of llama
+  std::vector<float> cos_cache;
+  std::vector<float> sin_cache;
+  if (config.rotary_dim > 0) {
+    const int half = config.rotary_dim / 2;
+    int max_position = 0;
+    for (int b = 0; b < batch_size; b++) {
+      max_position = std::max(max_position, config.past_seqlens[b] + config.cumulative_sequence_length[b + 1] -
+                                                config.cumulative_sequence_length[b]);
+    }
+    for (int position = 0; position < max_position; position++) {
+      for (int i = 0; i < half; i++) {
+        const float angle = position * std::pow(10000.0f, -2.0f * i / config.rotary_dim);
+        cos_cache.push_back(RoundTo<T>(std::cos(angle)));
+        sin_cache.push_back(RoundTo<T>(std::sin(angle)));
+      }
+    }
+    AddInput<T>(test, "cos_cache", {max_position, half}, cos_cache);
+    AddInput<T>(test, "sin_cache", {max_position, half}, sin_cache);
+  }
+
+  std::vector<float> output;
+  ComputeReference<T>(config, query, key, value, cos_cache, sin_cache, key_cache, value_cache, output);
+
+  AddOutput<T>(test, "output", query_dims, output);
+  AddOutput<T>(test, "key_cache_out", cache_dims, key_cache);
+  AddOutput<T>(test, "value_cache_out", cache_dims, value_cache);
+  test.SetOutputTolerance(std::is_same<T, MLFloat16>::value ? 5e-3f : 1e-4f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+// Sequence 0 is a prompt of 5 tokens over a block boundary, sequence 1 generates one token after 6 past tokens.
+PagedAttentionConfig MakeOptionsConfig() {
+  PagedAttentionConfig config{};
+  config.num_heads = 4;
+  config.kv_num_heads = 2;
+  config.head_size = 16;
+  config.num_blocks = 8;
+  config.block_size = 4;
+  config.cumulative_sequence_length = {0, 5, 6};
+  config.past_seqlens = {0, 6};
+  config.block_table = {6, 2,
+                        0, 5};
+  return config;
+}
+
+}  // namespace
+
+TEST(PagedAttentionTest, PromptAndTokenGeneration) {
+  // Sequence 0 is a prompt of 6 tokens, sequence 1 generates one token after 9 past tokens.
+  PagedAttentionConfig config{};
+  config.num_heads = 4;
+  config.kv_num_heads = 2;
+  config.head_size = 8;
+  config.num_blocks = 8;
+  config.block_size = 4;
+  config.cumulative_sequence_length = {0, 6, 7};
+  config.past_seqlens = {0, 9};
+  config.block_table = {5, 1, 0,
+                        2, 7, 3};
+  RunPagedAttentionTest(config, false);
+  RunPagedAttentionTest(config, true);
+}
+
+TEST(PagedAttentionTest, ContinuedPrompt) {
+  // New tokens of one sequence span a block boundary after past tokens.
+  PagedAttentionConfig config{};
+  config.num_heads = 2;
+  config.kv_num_heads = 2;
+  config.head_size = 16;
+  config.num_blocks = 6;
+  config.block_size = 3;
+  config.cumulative_sequence_length = {0, 4};
+  config.past_seqlens = {2};
+  config.block_table = {4, 0, 3, 1};
+  RunPagedAttentionTest(config, false);
+}
+
+TEST(PagedAttentionTest, SharedPrefixBlocks) {
+  // Both sequences share the first two (full) blocks of their prefix.
+  PagedAttentionConfig config{};
+  config.num_heads = 2;
+  config.kv_num_heads = 1;
+  config.head_size = 8;
+  config.num_blocks = 6;
+  config.block_size = 2;
+  config.cumulative_sequence_length = {0, 1, 3};
+  config.past_seqlens = {4, 4};
+  config.block_table = {3, 0, 5,
+                        3, 0, 1};
+  RunPagedAttentionTest(config, false);
+}
+
+TEST(PagedAttentionTest, LocalWindow) {
+  PagedAttentionConfig config{};
+  config.num_heads = 2;
+  config.kv_num_heads = 1;
+  config.head_size = 8;
+  config.num_blocks = 5;
+  config.block_size = 2;
+  config.local_window_size = 3;
+  config.cumulative_sequence_length = {0, 2};
+  config.past_seqlens = {6};
+  config.block_table = {4, 2, 0, 1};
+  RunPagedAttentionTest(config, true);
+}
+
+TEST(PagedAttentionTest, Rotary) {
+  PagedAttentionConfig config = MakeOptionsConfig();
+  config.rotary_dim = config.head_size;
+  RunPagedAttentionTest(config, false);
+  RunPagedAttentionTest(config, true);
+
+  // partial rotary dimension, interleaved
+  config.rotary_dim = config.head_size / 2;
+  config.rotary_interleaved = true;
+  RunPagedAttentionTest(config, false);
+  RunPagedAttentionTest(config, true);
+}
+
+TEST(PagedAttentionTest, Softcap) {
+  PagedAttentionConfig config = MakeOptionsConfig();
+  // the scores of random inputs are around 1, so a small softcap changes them noticeably
+  config.softcap = 0.5f;
+  RunPagedAttentionTest(config, false);
+}
+
+TEST(PagedAttentionTest, SmoothSoftmax) {
+  PagedAttentionConfig config = MakeOptionsConfig();
+  config.smooth_softmax = true;
+  RunPagedAttentionTest(config, false);
+
+  config.local_window_size = 2;
+  RunPagedAttentionTest(config, true);
+}
+
+TEST(PagedAttentionTest, Float16) {
+  PagedAttentionConfig config = MakeOptionsConfig();
+  RunPagedAttentionTest<MLFloat16>(config, false);
+  RunPagedAttentionTest<MLFloat16>(config, true);
+
+  config.rotary_dim = config.head_size;
+  config.softcap = 0.5f;
+  config.smooth_softmax = true;
+  RunPagedAttentionTest<MLFloat16>(config, true);
+}
+
+TEST(PagedAttentionTest, InvalidBlockId) {
+  OpTester test("PagedAttention", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("num_heads", 1);
+  test.AddAttribute<int64_t>("kv_num_heads", 1);
+  std::vector<float> data(8, 0.5f);
+  std::vector<float> cache(2 * 2 * 8, 0.0f);
+  test.AddInput<float>("query", {1, 8}, data);
+  test.AddInput<float>("key", {1, 8}, data);
+  test.AddInput<float>("value", {1, 8}, data);
+  test.AddInput<float>("key_cache", {2, 2, 1, 8}, cache);
+  test.AddInput<float>("value_cache", {2, 2, 1, 8}, cache);
+  test.AddInput<int32_t>("cumulative_sequence_length", {2}, {0, 1});
+  test.AddInput<int32_t>("past_seqlens", {1}, {0});
+  test.AddInput<int32_t>("block_table", {1, 1}, {2});
+  test.AddOutput<float>("output", {1, 8}, data);
+  test.AddOutput<float>("key_cache_out", {2, 2, 1, 8}, cache);
+  test.AddOutput<float>("value_cache_out", {2, 2, 1, 8}, cache);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectFailure, "out of range block id", {}, nullptr, &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
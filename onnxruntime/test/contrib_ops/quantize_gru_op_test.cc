@@ -0,0 +1,316 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "core/providers/cpu/rnn/deep_cpu_gru.h"
+#include "core/util/qmath.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/util/include/default_providers.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+template <typename QType,
+          typename std::enable_if<is_quant_type<QType>::value, int>::type = 0>
+static std::vector<float> ApplyQDQ(const std::vector<float>& data, size_t channel_count, bool per_channel = false) {
+  std::vector<float> result(data.size());
+  size_t size_per_channel = data.size() / channel_count;
+
+  for (size_t channel_idx = 0; channel_idx < channel_count; channel_idx++) {
+    QType zp = 0;
+    float scale = 1.0f;
+    const float* data_buf = data.data() + size_per_channel * channel_idx;
+    if (per_channel) {
+      GetQuantizationParameter<QType, true, true>(data_buf, size_per_channel, scale, zp, nullptr);
+    } else {
+      GetQuantizationParameter<QType, true, false>(data_buf, size_per_channel, scale, zp, nullptr);
+    }
+
+    std::vector<QType> quant_data(size_per_channel);
+    MlasQuantizeLinear(data_buf, quant_data.data(), size_per_channel, scale, zp);
+
+    std::transform(quant_data.begin(),
+                   quant_data.end(),
+                   result.begin() + size_per_channel * channel_idx,
+                   [&zp, &scale](QType q) {
+                     return (static_cast<int32_t>(q) - zp) * scale;
+                   });
+  }
+
+  return result;
+}
+
+// Quantizes w of shape [num_direction, row, col] per direction or per row, and transposes each direction
+// to [col, row], the layout of the weights of DynamicQuantizeGRU.
+template <typename QType,
+          typename std::enable_if<is_quant_type<QType>::value, int>::type = 0>
+static void QuantizeWeight(std::vector<QType>& w_quant,
+                           std::vector<float>& scale,
+                           std::vector<QType>& zp,
+                           const std::vector<float>& w,
+                           size_t num_direction,
+                           size_t row,
+                           size_t col,
+                           bool per_channel) {
+  std::vector<QType> w_quant_tmp(w.size());
+
+  size_t quant_param_size = per_channel ? num_direction * row : num_direction;
+  size_t quant_span = per_channel ? col : row * col;
+  scale.resize(quant_param_size);
+  zp.resize(quant_param_size);
+
+  for (size_t quant_param_idx = 0; quant_param_idx < quant_param_size; quant_param_idx++) {
+    if (per_channel) {
+      GetQuantizationParameter<QType, true, true>(w.data() + quant_param_idx * quant_span, quant_span,
+                                                  scale[quant_param_idx], zp[quant_param_idx], nullptr);
+    } else {
+      GetQuantizationParameter<QType, true, false>(w.data() + quant_param_idx * quant_span, quant_span,
+                                                   scale[quant_param_idx], zp[quant_param_idx], nullptr);
+    }
+
+    MlasQuantizeLinear(w.data() + quant_param_idx * quant_span,
+                       w_quant_tmp.data() + quant_param_idx * quant_span,
+                       quant_span,
+                       scale[quant_param_idx],
+                       zp[quant_param_idx]);
+  }
+
+  w_quant.resize(w.size());
+  for (size_t dir_idx = 0; dir_idx < num_direction; dir_idx++) {
+    QType* w_quant_tmp_buf = w_quant_tmp.data() + dir_idx * row * col;
+    QType* w_quant_buf = w_quant.data() + dir_idx * row * col;
+    for (size_t c = 0; c < col; c++) {
+      for (size_t r = 0; r < row; r++) {
+        *w_quant_buf++ = *(w_quant_tmp_buf + r * col + c);
+      }
+    }
+  }
+}
+
+// Computes the output of a GRU step with sigmoid and tanh activations from the quantized and dequantized inputs and
+// weights. Like the operator, Ht-1 is quantized as a whole for the GEMMs with R, rt (.) Ht-1 is quantized as a whole
+// for the GEMM with Rh when the linear transformation is applied after the reset gate, and Ht-1 is used as is in
+// Ht = (1 - zt) (.) ht + zt (.) Ht-1.
+template <typename QType,
+          typename std::enable_if<is_quant_type<QType>::value, int>::type = 0>
+static void ComputeRefOutput(std::vector<float>& Y_data,
+                             std::vector<float>& Y_h_data,
+                             int64_t input_size,
+                             int64_t batch_size,
+                             int64_t hidden_size,
+                             const std::vector<float>& X_data,
+                             const std::vector<float>& W_data,
+                             const std::vector<float>& R_data,
+                             const std::vector<float>* B_data,
+                             const std::vector<float>& initial_h_data,
+                             const std::string& direction,
+                             bool linear_before_reset,
+                             bool per_channel) {
+  const int64_t num_directions = (direction == "bidirectional") ? 2 : 1;
+  const int64_t quant_channel_count = per_channel ? num_directions * 3 * hidden_size : num_directions;
+  const std::vector<float> X_dq = ApplyQDQ<uint8_t>(X_data, 1);
+  const std::vector<float> W_dq = ApplyQDQ<QType>(W_data, quant_channel_count, per_channel);
+  const std::vector<float> R_dq = ApplyQDQ<QType>(R_data, quant_channel_count, per_channel);
+
+  auto dot = [](const float* a, const float* b, int64_t size) {
+    float sum = 0.f;
+    for (int64_t i = 0; i < size; i++) {
+      sum += a[i] * b[i];
+    }
+    return sum;
+  };
+  auto sigmoid = [](float x) { return 1.f / (1.f + std::exp(-x)); };
+
+  const int64_t state_size = batch_size * hidden_size;
+  Y_data.resize(num_directions * state_size);
+  for (int64_t dir = 0; dir < num_directions; dir++) {
+    const float* W = W_dq.data() + dir * 3 * hidden_size * input_size;
+    const float* R = R_dq.data() + dir * 3 * hidden_size * hidden_size;
+    const float* Wb = B_data ? B_data->data() + dir * 6 * hidden_size : nullptr;
+    const float* Rb = B_data ? Wb + 3 * hidden_size : nullptr;
+    auto bias = [&](const float* b, int64_t gate, int64_t h) { return b ? b[gate * hidden_size + h] : 0.f; };
+
+    const std::vector<float> prev_h(initial_h_data.begin() + dir * state_size,
+                                    initial_h_data.begin() + (dir + 1) * state_size);
+    const std::vector<float> prev_h_dq = ApplyQDQ<uint8_t>(prev_h, 1);
+
+    // zt, rt, Xt*(Wh^T) + Wbh, and rt (.) Ht-1
+    std::vector<float> z(state_size), r(state_size), x_h(state_size), reset_h(state_size);
+    for (int64_t b = 0; b < batch_size; b++) {
+      const float* x = X_dq.data() + b * input_size;
+      const float* h_dq = prev_h_dq.data() + b * hidden_size;
+      for (int64_t h = 0; h < hidden_size; h++) {
+        const int64_t i = b * hidden_size + h;
+        z[i] = sigmoid(dot(x, W + h * input_size, input_size) + dot(h_dq, R + h * hidden_size, hidden_size) +
+                       bias(Wb, 0, h) + bias(Rb, 0, h));
+        r[i] = sigmoid(dot(x, W + (hidden_size + h) * input_size, input_size) +
+                       dot(h_dq, R + (hidden_size + h) * hidden_size, hidden_size) +
+                       bias(Wb, 1, h) + bias(Rb, 1, h));
+        x_h[i] = dot(x, W + (2 * hidden_size + h) * input_size, input_size) + bias(Wb, 2, h);
+        reset_h[i] = r[i] * prev_h[i];
+      }
+    }
+
+    const std::vector<float> reset_h_dq = ApplyQDQ<uint8_t>(reset_h, 1);
+    for (int64_t b = 0; b < batch_size; b++) {
+      for (int64_t h = 0; h < hidden_size; h++) {
+        const int64_t i = b * hidden_size + h;
+        const float* Rh = R + (2 * hidden_size + h) * hidden_size;
+        float ht;
+        if (linear_before_reset) {
+          // rt (.) (Ht-1*(Rh^T) + Rbh)
+          ht = r[i] * (dot(prev_h_dq.data() + b * hidden_size, Rh, hidden_size) + bias(Rb, 2, h));
+        } else {
+          // (rt (.) Ht-1)*(Rh^T) + Rbh
+          ht = dot(reset_h_dq.data() + b * hidden_size, Rh, hidden_size) + bias(Rb, 2, h);
+        }
+        ht = std::tanh(x_h[i] + ht);
+        Y_data[dir * state_size + i] = (1.f - z[i]) * ht + z[i] * prev_h[i];
+      }
+    }
+  }
+
+  // seq_length is 1, so Y_h is Y
+  Y_h_data = Y_data;
+}
+
+template <typename QType,
+          typename std::enable_if<std::is_same<QType, uint8_t>::value || std::is_same<QType, int8_t>::value, int>::type = 0>
+static void RunQuantGRU(int64_t input_size,
+                        int64_t batch_size,
+                        int64_t hidden_size,
+                        bool has_bias,
+                        bool is_initializer_W,
+                        bool is_initializer_R,
+                        bool per_channel,
+                        const std::string& direction,
+                        bool linear_before_reset) {
+  OpTester test("DynamicQuantizeGRU", 1 /*opset_version*/, onnxruntime::kMSDomain /*domain*/);
+
+  int num_directions = (direction == "bidirectional") ? 2 : 1;
+
+  std::vector<std::string> activations;
+  if (num_directions == 2) {
+    activations = {"sigmoid", "tanh", "sigmoid", "tanh"};
+  } else {
+    activations = {"sigmoid", "tanh"};
+  }
+  test.AddAttribute<std::vector<std::string>>("activations", activations);
+
+  test.AddAttribute("direction", direction);
+  test.AddAttribute("hidden_size", hidden_size);
+  test.AddAttribute<int64_t>("linear_before_reset", linear_before_reset);
+
+  RandomValueGenerator rand_gen;
+
+  // X
+  int64_t seq_len = 1;  // only use seq length 1 to model the test
+  std::vector<int64_t> X_dims = {seq_len, batch_size, input_size};
+  std::vector<float> X_data = rand_gen.Gaussian<float>(std::array<int64_t, 3>{seq_len, batch_size, input_size}, 0.0f, 0.25f);
+  test.AddInput<float>("X", X_dims, X_data);
+
+  // W
+  std::vector<int64_t> W_dims = {num_directions, input_size, 3 * hidden_size};
+  std::vector<float> W_data = rand_gen.Gaussian<float>(std::array<int64_t, 3>{num_directions, 3 * hidden_size, input_size}, 0.0f, 0.25f);
+
+  std::vector<float> w_scale;
+  std::vector<QType> w_zp;
+  std::vector<QType> w_quant;
+  QuantizeWeight(w_quant, w_scale, w_zp, W_data, num_directions, 3 * hidden_size, input_size, per_channel);
+  test.AddInput<QType>("W", W_dims, w_quant, is_initializer_W);
+
+  // R
+  std::vector<int64_t> R_dims = {num_directions, hidden_size, 3 * hidden_size};
+  std::vector<float> R_data = rand_gen.Gaussian<float>(std::array<int64_t, 3>{num_directions, 3 * hidden_size, hidden_size}, 0.0f, 0.25f);
+
+  std::vector<float> r_scale;
+  std::vector<QType> r_zp;
+  std::vector<QType> r_quant;
+  QuantizeWeight(r_quant, r_scale, r_zp, R_data, num_directions, 3 * hidden_size, hidden_size, per_channel);
+  test.AddInput<QType>("R", R_dims, r_quant, is_initializer_R);
+
+  std::vector<float> B_data;
+  if (has_bias) {
+    std::vector<int64_t> B_dims = {num_directions, 6 * hidden_size};
+    B_data = rand_gen.Gaussian<float>(B_dims, 0.0f, 0.25f);
+
+    test.AddInput<float>("B", B_dims, B_data);
+  } else {
+    test.AddOptionalInputEdge<float>();
+  }
+
+  // sequence_lens
+  test.AddOptionalInputEdge<int>();
+
+  // initial_h
+  std::vector<int64_t> initial_h_dims = {num_directions, batch_size, hidden_size};
+  std::vector<float> initial_h_data = rand_gen.Gaussian<float>(initial_h_dims, 0.0f, 0.25f);
+  test.AddInput<float>("initial_h", initial_h_dims, initial_h_data);
+
+  std::vector<int64_t> per_tensor_dims = {num_directions};
+  std::vector<int64_t> per_channel_dims = {num_directions, 3 * hidden_size};
+  test.AddInput<float>("W_scale", per_channel ? per_channel_dims : per_tensor_dims, w_scale);
+  test.AddInput<QType>("W_zero_point", per_channel ? per_channel_dims : per_tensor_dims, w_zp);
+
+  test.AddInput<float>("R_scale", per_channel ? per_channel_dims : per_tensor_dims, r_scale);
+  test.AddInput<QType>("R_zero_point", per_channel ? per_channel_dims : per_tensor_dims, r_zp);
+
+  std::vector<float> Y_data;
+  std::vector<float> Y_h_data;
+  ComputeRefOutput<QType>(Y_data, Y_h_data,
+                          input_size, batch_size, hidden_size,
+                          X_data, W_data, R_data,
+                          has_bias ? &B_data : nullptr,
+                          initial_h_data,
+                          direction, linear_before_reset, per_channel);
+
+  std::vector<int64_t> Y_dims = {seq_len, num_directions, batch_size, hidden_size};
+  test.AddOutput<float>("Y", Y_dims, Y_data);
+
+  std::vector<int64_t> Y_h_dims{num_directions, batch_size, hidden_size};
+  test.AddOutput<float>("Y_h", Y_h_dims, Y_h_data);
+
+  test.Run();
+}
+
+template <typename QType,
+          typename std::enable_if<std::is_same<QType, uint8_t>::value || std::is_same<QType, int8_t>::value, int>::type = 0>
+static void RunQuantGRU(int64_t input_size,
+                        int64_t batch_size,
+                        int64_t hidden_size,
+                        bool per_channel = false) {
+  for (bool has_bias : {false, true}) {
+    for (bool is_initializer : {false, true}) {
+      for (const char* direction : {"forward", "reverse", "bidirectional"}) {
+        for (bool linear_before_reset : {false, true}) {
+          RunQuantGRU<QType>(input_size, batch_size, hidden_size,
+                             has_bias,
+                             is_initializer /*is_initializer_W*/, is_initializer /*is_initializer_R*/,
+                             per_channel, direction, linear_before_reset);
+        }
+      }
+    }
+  }
+}
+
+TEST(DynamicQuantGRUTest, SmallSize) {
+  RunQuantGRU<int8_t>(2, 1, 16);
+  RunQuantGRU<int8_t>(2, 1, 16, true /*per_channel*/);
+  RunQuantGRU<uint8_t>(2, 1, 16);
+}
+
+TEST(DynamicQuantGRUTest, LargeSize) {
+  RunQuantGRU<int8_t>(12, 3, 278);
+  RunQuantGRU<int8_t>(12, 3, 278, true /*per_channel*/);
+  RunQuantGRU<uint8_t>(12, 3, 278);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
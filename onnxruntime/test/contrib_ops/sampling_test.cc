@@ -2,11 +2,13 @@
 // Licensed under the MIT License.
 
 #include <memory>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include <gsl/gsl>
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test/common/cuda_op_test_utils.h"
+#include "test/contrib_ops/generation_test_utils.h"
 
 #ifdef USE_CUDA
 #include "core/providers/cuda/cuda_provider_options.h"
@@ -162,6 +164,30 @@ TEST(SamplingTest, Gpt2Sampling_CPU) {
 
   ASSERT_TRUE(std::equal(expected_output.cbegin(), expected_output.cend(), result_span.begin(), result_span.end()));
 }
+
+TEST(SamplingTest, Gpt2SamplingCompactFinishedSequences_CPU) {
+  // The first sequence samples 125 then 669 (see Gpt2Sampling_CPU), so it finishes before the other two. The tokens
+  // sampled for each sequence don't depend on the rows still in the decoder inputs.
+  constexpr int64_t eos_token_id = 669;
+  const int64_t batch_size = 3;
+  const int64_t sequence_length = 12;
+  std::vector<int32_t> input_ids{
+      0, 0, 0, 0, 0, 52, 195, 731, 321, 301, 734, 620,
+      41, 554, 74, 622, 206, 222, 75, 223, 221, 198, 224, 572,
+      0, 0, 0, 52, 328, 219, 328, 206, 288, 227, 896, 328};
+  std::vector<int64_t> input_ids_shape{batch_size, sequence_length};
+  constexpr int32_t max_length = 20;
+  auto run = [&](const std::string& model_data) {
+    return RunGenerationModel(model_data, input_ids, input_ids_shape, max_length);
+  };
+
+  const ORTCHAR_T* model_path = ORT_TSTR("testdata/transformers/tiny_gpt2_sampling.onnx");
+  const std::vector<int32_t> expected_output = run(MakeGenerationModel(model_path, eos_token_id, batch_size));
+  ASSERT_EQ(expected_output[sequence_length + 1], eos_token_id);
+
+  ASSERT_EQ(expected_output, run(MakeGenerationModel(model_path, eos_token_id)));
+}
+
 #endif
 }  // namespace test
 }  // namespace onnxruntime
@@ -4,6 +4,10 @@
 
 #include "core/framework/allocator.h"
 #include "core/framework/allocator_utils.h"
+#include "core/framework/numa_allocator.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/env.h"
+#include "core/providers/cpu/cpu_execution_provider.h"
 
 #include "test_utils.h"
 #include "gtest/gtest.h"
@@ -31,6 +35,52 @@ TEST(AllocatorTest, CPUAllocatorTest) {
   cpu_arena->Free(bytes);
   // todo: test the used / max api.
 }
+
+TEST(AllocatorTest, NumaCPUAllocatorTest) {
+  if (Env::Default().GetNumaNodeThreadAffinities(0).empty()) {
+    GTEST_SKIP() << "NUMA information is not available";
+  }
+
+  NumaCPUAllocator numa_allocator(0);
+  ASSERT_STREQ(numa_allocator.Info().name, CPU);
+  EXPECT_EQ(numa_allocator.Info().alloc_type, OrtAllocatorType::OrtDeviceAllocator);
+
+  const size_t size = 3 * 4096 + 5;
+  auto* bytes = static_cast<uint8_t*>(numa_allocator.Alloc(size));
+  ASSERT_NE(bytes, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(bytes) % MlasGetPreferredBufferAlignment(), 0U);
+  memset(bytes, -1, size);
+  EXPECT_EQ(bytes[size - 1], 0xFF);
+  numa_allocator.Free(bytes);
+
+  // the arena of a CPU EP pinned to the node is backed by it
+  CPUExecutionProviderInfo info;
+  info.numa_node = 0;
+  auto cpu_arena = CPUExecutionProvider(info).CreatePreferredAllocators()[0];
+  ASSERT_STREQ(cpu_arena->Info().name, CPU);
+  auto* arena_bytes = cpu_arena->Alloc(1024);
+  ASSERT_NE(arena_bytes, nullptr);
+  memset(arena_bytes, -1, 1024);
+  cpu_arena->Free(arena_bytes);
+
+  // a node that doesn't exist
+  EXPECT_TRUE(Env::Default().GetNumaNodeThreadAffinities(1 << 20).empty());
+}
+
+TEST(AllocatorTest, NumaCPUAllocatorWithoutNumaPlacement) {
+  if (Env::Default().IsNumaAllocationSupported()) {
+    GTEST_SKIP() << "NUMA placement of memory is supported";
+  }
+
+  // the memory comes from the CPU allocator
+  NumaCPUAllocator numa_allocator(0);
+  auto* bytes = static_cast<uint8_t*>(numa_allocator.Alloc(1024));
+  ASSERT_NE(bytes, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(bytes) % MlasGetPreferredBufferAlignment(), 0U);
+  memset(bytes, -1, 1024);
+  numa_allocator.Free(bytes);
+}
+
 #if defined(_MSC_VER) && !defined(__clang__)
 #pragma warning(disable : 26400)
 #endif
@@ -7,6 +7,9 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <cstdlib>
+#include <cstring>
+#include <future>
+#include <thread>
 #include "core/framework/stream_handles.h"
 
 namespace onnxruntime {
@@ -416,6 +419,123 @@ TEST(StreamAwareArenaTest, TestSecureTheChunk) {
 }
 #endif
 
+TEST(BFCArenaTest, TestThreadCache) {
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, ArenaExtendStrategy::kNextPowerOfTwo,
+             BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+             BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+             64 * 1024);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; i++) {
+    ptrs.push_back(a.Alloc(1000));
+  }
+  for (void* p : ptrs) {
+    a.Free(p);
+  }
+  // The freed chunks are kept by the thread cache but not counted as in use.
+  CheckStats(&a, 64, 0, 64 * 1024, 1024);
+
+  // Allocations of the same rounded size are served from the thread cache.
+  std::vector<void*> cached_ptrs;
+  for (int i = 0; i < 64; i++) {
+    cached_ptrs.push_back(a.Alloc(1024));
+  }
+  std::sort(ptrs.begin(), ptrs.end());
+  std::sort(cached_ptrs.begin(), cached_ptrs.end());
+  EXPECT_EQ(ptrs, cached_ptrs);
+  CheckStats(&a, 128, 64 * 1024, 64 * 1024, 1024);
+
+  for (void* p : cached_ptrs) {
+    a.Free(p);
+  }
+  EXPECT_EQ(a.Shrink(), Status::OK());
+  CheckStats(&a, 128, 0, 64 * 1024, 1024);
+}
+
+TEST(BFCArenaTest, TestThreadCacheConcurrentAllocations) {
+  OrtArenaCfg config(0, -1, -1, -1, -1, -1L, 16 * 1024);
+  AllocatorCreationInfo device_info{
+      [](OrtDevice::DeviceId) { return std::make_unique<CPUAllocator>(); },
+      0, true, config};
+  auto allocator = CreateAllocator(device_info);
+  BFCArena& a = *static_cast<BFCArena*>(allocator.get());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&a, t]() {
+      std::vector<std::pair<unsigned char*, size_t>> live;
+      for (int i = 0; i < 2000; i++) {
+        const size_t size = static_cast<size_t>((i * 37 + t * 101) % 6000 + 1);
+        auto* p = static_cast<unsigned char*>(a.Alloc(size));
+        memset(p, t, size);
+        live.emplace_back(p, size);
+        if (live.size() > 16 || i % 3 == 0) {
+          // Free the oldest allocation after checking that no other thread has written to it.
+          auto [oldest, oldest_size] = live.front();
+          for (size_t j = 0; j < oldest_size; j++) {
+            ASSERT_EQ(oldest[j], static_cast<unsigned char>(t));
+          }
+          a.Free(oldest);
+          live.erase(live.begin());
+        }
+      }
+      for (auto& [p, size] : live) {
+        a.Free(p);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The thread caches are returned to the arena when the threads exit.
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.num_allocs, 8 * 2000);
+}
+
+TEST(BFCArenaTest, TestThreadCacheDefersSmallFreesOnly) {
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, ArenaExtendStrategy::kNextPowerOfTwo,
+             BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+             BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+             64 * 1024);
+
+  // Another thread frees a small and a large chunk, then waits while this thread checks the stats. GetStats only
+  // flushes the cache of the calling thread, so the pending small free of the other thread is still in use.
+  std::promise<void> freed;
+  std::promise<void> checked;
+  std::thread thread([&a, &freed, &checked]() {
+    void* small = a.Alloc(1000);
+    void* large = a.Alloc(1 << 20);
+    a.Free(small);
+    a.Free(large);
+    freed.set_value();
+    checked.get_future().wait();
+  });
+
+  freed.get_future().wait();
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 1024);
+  checked.set_value();
+  thread.join();
+
+  // The thread cache is returned to the arena when the thread exits.
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
+
+#ifdef ORT_ENABLE_STREAM
+TEST(StreamAwareArenaTest, RejectThreadCache) {
+  OrtArenaCfg config(0, -1, -1, -1, -1, -1L, 16 * 1024);
+  AllocatorCreationInfo device_info{
+      [](OrtDevice::DeviceId) { return std::make_unique<CPUAllocator>(); },
+      0, true, config, true};
+  EXPECT_THROW(CreateAllocator(device_info), OnnxRuntimeException);
+}
+#endif
+
 TEST(BFCArenaTest, TestExtendStrategy) {
   int64_t extend_delta_bytes = 0;
   {
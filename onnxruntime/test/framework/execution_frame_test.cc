@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <functional>
+
 #include "core/common/span_utils.h"
 #include "core/framework/execution_frame.h"
 #include "core/framework/op_kernel.h"
@@ -8,6 +10,7 @@
 #include "core/graph/model.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test_utils.h"
 #include "test/test_environment.h"
 #include "test/framework/TestAllocatorManager.h"
@@ -370,6 +373,117 @@ TEST_F(ExecutionFrameTest, MemPatternTest) {
   ASSERT_EQ(p->GetBlock(4)->offset_, kAllocAlignment);
 }
 
+TEST_F(ExecutionFrameTest, MemPatternShapeBucketingTest) {
+  auto cpu_xp = CreateCPUExecutionProvider();
+  auto xp_type = cpu_xp->Type();
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  onnxruntime::Model model("test", true, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           domain_to_version, {}, DefaultLoggingManager().DefaultLogger());
+  onnxruntime::Graph& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  onnxruntime::NodeArg input_def1("X1", &tensor_float),
+      input_def2("X2", &tensor_float),
+      gemm_out_def("T1", &tensor_float),
+      clip_out_def("T2", &tensor_float);
+
+  graph.AddNode("node1", "MatMul", "gemm1", ArgMap{&input_def1, &input_def2}, ArgMap{&gemm_out_def})
+      .SetExecutionProviderType(xp_type);
+  graph.AddNode("node2", "Clip", "clip1", ArgMap{&gemm_out_def}, ArgMap{&clip_out_def})
+      .SetExecutionProviderType(xp_type);
+
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  KernelRegistryManager kernel_registry_manager;
+
+  ExecutionProviders execution_providers;
+  ASSERT_STATUS_OK(execution_providers.Add(xp_type, std::move(cpu_xp)));
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+
+  DataTransferManager dtm;
+  ExternalDataLoaderManager edlm;
+  profiling::Profiler profiler;
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.enable_mem_reuse = true;
+  ASSERT_STATUS_OK(sess_options.config_options.AddConfigEntry(kOrtSessionOptionsMemoryPatternShapeBucketing, "1"));
+
+  SessionState state(graph, execution_providers, &tp_, nullptr, dtm, edlm,
+                     DefaultLoggingManager().DefaultLogger(), profiler, sess_options);
+
+  ASSERT_STATUS_OK(state.FinalizeSessionState(ORT_TSTR(""), kernel_registry_manager));
+  ASSERT_TRUE(state.GetMemoryPatternShapeBucketing());
+
+  const OrtValueNameIdxMap& mlvalue_name_idx_map(state.GetOrtValueNameIdxMap());
+  int x1_idx = -1, x2_idx = -1, t1_idx = -1, t2_idx = -1;
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X1", x1_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("X2", x2_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("T1", t1_idx));
+  ASSERT_STATUS_OK(mlvalue_name_idx_map.GetIdx("T2", t2_idx));
+
+  auto cpu_allocator = execution_providers.Get(xp_type)->CreatePreferredAllocators()[0];
+  OrtValue x2;
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{64, 64}, std::vector<float>(64 * 64, 1.0f), &x2);
+
+  // Run the "graph" with X1 of shape {rows, 64} and allocate T1 like the MatMul kernel would.
+  auto run = [&](int64_t rows, std::function<void(ExecutionFrame&)> check) {
+    OrtValue x1;
+    CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{rows, 64}, std::vector<float>(rows * 64, 1.0f), &x1);
+    std::vector<OrtValue> feeds{x1, x2};
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(AsSpan({x1_idx, x2_idx}), feeds, AsSpan({t2_idx}), outputs, {},
+#ifdef ORT_ENABLE_STREAM
+                         {},
+#endif
+                         state);
+    OrtValue& t1 = *frame.GetMutableNodeInputOrOutputMLValue(t1_idx);
+    ASSERT_STATUS_OK(frame.AllocateMLValueTensorSelfOwnBuffer(t1, t1_idx, DataTypeImpl::GetType<float>(),
+                                                              cpu_allocator->Info().device,
+                                                              TensorShape(std::vector<int64_t>{rows, 64})));
+    check(frame);
+
+    MemoryPatternGroup mem_patterns;
+    if (frame.HasMemoryPatternPlanner()) {
+      ASSERT_STATUS_OK(frame.GeneratePatterns(mem_patterns));
+    }
+    ASSERT_STATUS_OK(state.UpdateBucketedMemoryPatternGroupCache(feeds, std::move(mem_patterns),
+                                                                 frame.GetOutgrownMemoryPatternSizes()));
+  };
+
+  auto block_size_of_t1 = [&](int64_t rows) -> size_t {
+    OrtValue x1;
+    CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{rows, 64}, std::vector<float>(rows * 64, 1.0f), &x1);
+    InlinedHashMap<int, size_t> planned_sizes;
+    auto patterns = state.GetBucketedMemoryPatternGroup(AsSpan({x1, x2}), planned_sizes);
+    return patterns ? patterns->GetPatterns(cpu_allocator->Info().device)->GetBlock(t1_idx)->size_ : 0;
+  };
+
+  // The first run of the bucket of 5 to 8 rows traces the pattern.
+  run(5, [](ExecutionFrame& frame) { EXPECT_TRUE(frame.HasMemoryPatternPlanner()); });
+  EXPECT_EQ(block_size_of_t1(8), 5u * 64 * sizeof(float));
+
+  // T1 of 7 rows outgrows the block, so the pattern is planned again with it.
+  run(7, [&](ExecutionFrame& frame) {
+    EXPECT_FALSE(frame.HasMemoryPatternPlanner());
+    EXPECT_EQ(frame.GetOutgrownMemoryPatternSizes().at(t1_idx), 7u * 64 * sizeof(float));
+  });
+  EXPECT_EQ(block_size_of_t1(8), 0u);
+  run(6, [](ExecutionFrame& frame) { EXPECT_TRUE(frame.HasMemoryPatternPlanner()); });
+  EXPECT_EQ(block_size_of_t1(8), 7u * 64 * sizeof(float));
+
+  // Smaller runs of the bucket use the pattern.
+  run(5, [](ExecutionFrame& frame) {
+    EXPECT_FALSE(frame.HasMemoryPatternPlanner());
+    EXPECT_TRUE(frame.GetOutgrownMemoryPatternSizes().empty());
+  });
+
+  // Other buckets have their own patterns.
+  EXPECT_EQ(block_size_of_t1(9), 0u);
+}
+
 #ifdef ENABLE_TRAINING
 TEST_F(ExecutionFrameTest, MemPatternWithExternalOutputsTest) {
   auto cpu_xp = CreateCPUExecutionProvider();
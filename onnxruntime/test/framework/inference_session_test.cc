@@ -18,6 +18,7 @@
 #include "core/common/logging/logging.h"
 #include "core/common/logging/sinks/clog_sink.h"
 #include "core/common/profiler.h"
+#include "core/framework/allocator_utils.h"
 #include "core/framework/compute_capability.h"
 #include "core/framework/data_transfer_manager.h"
 #include "core/framework/execution_provider.h"
@@ -1148,6 +1149,288 @@ TEST(InferenceSessionTests, TestIOBindingReuse) {
   }
 }
 
+// state_out = state + X, Y = state_out * X
+static void CreateStatefulModel(std::unique_ptr<onnxruntime::Model>& p_model) {
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  std::vector<ONNX_NAMESPACE::FunctionProto> model_specific_functions;
+  p_model = std::make_unique<Model>("test", true, ModelMetaData(), PathString(),
+                                    IOnnxRuntimeOpSchemaRegistryList(), domain_to_version,
+                                    model_specific_functions, DefaultLoggingManager().DefaultLogger(),
+                                    ModelOptions(true, true));
+  onnxruntime::Graph& graph = p_model->MainGraph();
+
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& x_arg = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& state_arg = graph.GetOrCreateNodeArg("state", &tensor_float);
+  auto& state_out_arg = graph.GetOrCreateNodeArg("state_out", &tensor_float);
+  auto& y_arg = graph.GetOrCreateNodeArg("Y", &tensor_float);
+
+  graph.AddNode("add", "Add", "update state", {&state_arg, &x_arg}, {&state_out_arg});
+  graph.AddNode("mul", "Mul", "output", {&state_out_arg, &x_arg}, {&y_arg});
+  graph.SetInputs({&x_arg, &state_arg});
+  graph.SetOutputs({&state_out_arg, &y_arg});
+
+  ASSERT_STATUS_OK(graph.Resolve());
+}
+
+TEST(InferenceSessionTests, StatefulOutputInputPairs) {
+  std::unique_ptr<Model> p_model;
+  CreateStatefulModel(p_model);
+  std::string model_str;
+  p_model->ToProto().SerializeToString(&model_str);
+
+  auto allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const std::vector<int64_t> dims{2};
+  auto make_value = [&](const std::vector<float>& values) {
+    OrtValue value;
+    CreateMLValue<float>(allocator, dims, values, &value);
+    return value;
+  };
+
+  {
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsStatefulOutputInputPairs, "state_out:state"));
+    InferenceSession session_object{so, GetEnvironment()};
+    std::stringstream sstr(model_str);
+    ASSERT_STATUS_OK(session_object.Load(sstr));
+    ASSERT_STATUS_OK(session_object.Initialize());
+
+    RunOptions run_options;
+    const std::vector<std::string> output_names{"Y"};
+    std::vector<OrtValue> fetches;
+
+    // the first run feeds the state
+    NameMLValMap feeds{{"X", make_value({1.f, 2.f})}, {"state", make_value({0.f, 0.f})}};
+    ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+    VerifyOutputs(fetches, dims, {1.f, 4.f});
+
+    // the next runs use the carried state, and reuse the buffers of the previous states
+    const std::vector<std::vector<float>> x_values{{2.f, 1.f}, {1.f, 1.f}, {3.f, 0.f}};
+    const std::vector<std::vector<float>> y_values{{6.f, 3.f}, {4.f, 4.f}, {21.f, 0.f}};
+    for (size_t i = 0; i < x_values.size(); ++i) {
+      fetches.clear();
+      feeds = NameMLValMap{{"X", make_value(x_values[i])}};
+      ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+      VerifyOutputs(fetches, dims, y_values[i]);
+    }
+
+    // fetching the carried output returns the new state
+    fetches.clear();
+    feeds = NameMLValMap{{"X", make_value({1.f, 1.f})}};
+    const std::vector<std::string> state_output_names{"state_out"};
+    ASSERT_STATUS_OK(session_object.Run(run_options, feeds, state_output_names, &fetches));
+    VerifyOutputs(fetches, dims, {8.f, 5.f});
+
+    // after a reset the state must be fed
+    ASSERT_STATUS_OK(run_options.config_options.AddConfigEntry(kOrtRunOptionsConfigResetSessionState, "1"));
+    fetches.clear();
+    ASSERT_STATUS_NOT_OK_AND_HAS_SUBSTR(session_object.Run(run_options, feeds, output_names, &fetches),
+                                        "Stateful input 'state' has no value");
+
+    fetches.clear();
+    feeds = NameMLValMap{{"X", make_value({1.f, 2.f})}, {"state", make_value({10.f, 10.f})}};
+    ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+    VerifyOutputs(fetches, dims, {11.f, 24.f});
+
+    RunOptions no_reset_run_options;
+    fetches.clear();
+    feeds = NameMLValMap{{"X", make_value({1.f, 1.f})}};
+    ASSERT_STATUS_OK(session_object.Run(no_reset_run_options, feeds, output_names, &fetches));
+    VerifyOutputs(fetches, dims, {12.f, 13.f});
+  }
+
+  for (const char* invalid_pairs : {"state_out:missing", "missing:state", "state_out"}) {
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsStatefulOutputInputPairs, invalid_pairs));
+    InferenceSession session_object{so, GetEnvironment()};
+    std::stringstream sstr(model_str);
+    ASSERT_STATUS_OK(session_object.Load(sstr));
+    ASSERT_FALSE(session_object.Initialize().IsOK()) << invalid_pairs;
+  }
+}
+
+// a_out = b + X, b_out = a, Y = a + b
+static void CreateSwappingStatefulModel(std::unique_ptr<onnxruntime::Model>& p_model) {
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  std::vector<ONNX_NAMESPACE::FunctionProto> model_specific_functions;
+  p_model = std::make_unique<Model>("test", true, ModelMetaData(), PathString(),
+                                    IOnnxRuntimeOpSchemaRegistryList(), domain_to_version,
+                                    model_specific_functions, DefaultLoggingManager().DefaultLogger(),
+                                    ModelOptions(true, true));
+  onnxruntime::Graph& graph = p_model->MainGraph();
+
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& x_arg = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& a_arg = graph.GetOrCreateNodeArg("a", &tensor_float);
+  auto& b_arg = graph.GetOrCreateNodeArg("b", &tensor_float);
+  auto& a_out_arg = graph.GetOrCreateNodeArg("a_out", &tensor_float);
+  auto& b_out_arg = graph.GetOrCreateNodeArg("b_out", &tensor_float);
+  auto& y_arg = graph.GetOrCreateNodeArg("Y", &tensor_float);
+
+  graph.AddNode("add_a", "Add", "update a", {&b_arg, &x_arg}, {&a_out_arg});
+  graph.AddNode("copy_b", "Identity", "update b", {&a_arg}, {&b_out_arg});
+  graph.AddNode("add_y", "Add", "output", {&a_arg, &b_arg}, {&y_arg});
+  graph.SetInputs({&x_arg, &a_arg, &b_arg});
+  graph.SetOutputs({&a_out_arg, &b_out_arg, &y_arg});
+
+  ASSERT_STATUS_OK(graph.Resolve());
+}
+
+// the buffers of the carried values are reused while each pair feeds its output to the input of the other one
+TEST(InferenceSessionTests, StatefulOutputInputPairsSwap) {
+  std::unique_ptr<Model> p_model;
+  CreateSwappingStatefulModel(p_model);
+  std::string model_str;
+  p_model->ToProto().SerializeToString(&model_str);
+
+  auto allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const std::vector<int64_t> dims{2};
+  auto make_value = [&](const std::vector<float>& values) {
+    OrtValue value;
+    CreateMLValue<float>(allocator, dims, values, &value);
+    return value;
+  };
+
+  SessionOptions so;
+  // no memory pattern block, so the allocations of a run are the ones of its outputs
+  so.enable_mem_pattern = false;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsStatefulOutputInputPairs, "a_out:a;b_out:b"));
+  InferenceSession session_object{so, GetEnvironment()};
+  std::stringstream sstr(model_str);
+  ASSERT_STATUS_OK(session_object.Load(sstr));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  auto cpu_allocator = session_object.GetAllocator(OrtMemoryInfo(CPU, OrtArenaAllocator));
+  ASSERT_NE(cpu_allocator, nullptr);
+  auto num_allocs = [&cpu_allocator]() {
+    AllocatorStats stats;
+    cpu_allocator->GetStats(&stats);
+    return stats.num_allocs;
+  };
+
+  RunOptions run_options;
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<OrtValue> fetches;
+
+  std::vector<float> a{1.f, 2.f};
+  std::vector<float> b{10.f, 20.f};
+
+  // the first run feeds the state, the next ones use the carried values
+  for (int run = 0; run < 6; ++run) {
+    const std::vector<float> x{static_cast<float>(run), 1.f};
+    NameMLValMap feeds{{"X", make_value(x)}};
+    if (run == 0) {
+      feeds.emplace("a", make_value(a));
+      feeds.emplace("b", make_value(b));
+    }
+
+    const auto num_allocs_before_run = num_allocs();
+    fetches.clear();
+    ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+    VerifyOutputs(fetches, dims, {a[0] + b[0], a[1] + b[1]});
+
+    // once the shapes are stable, the carried outputs are written in the buffers fed two runs before and only Y
+    // is allocated
+    if (run >= 2 && DoesCpuAllocatorSupportArenaUsage()) {
+      EXPECT_EQ(num_allocs() - num_allocs_before_run, 1) << "run " << run;
+    }
+
+    std::vector<float> new_a{b[0] + x[0], b[1] + x[1]};
+    b = std::move(a);
+    a = std::move(new_a);
+  }
+}
+
+// state_out = state + X, Y = state_out * X, with shapes only known at run time
+static void CreateUnshapedStatefulModel(std::unique_ptr<onnxruntime::Model>& p_model) {
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  std::vector<ONNX_NAMESPACE::FunctionProto> model_specific_functions;
+  p_model = std::make_unique<Model>("test", true, ModelMetaData(), PathString(),
+                                    IOnnxRuntimeOpSchemaRegistryList(), domain_to_version,
+                                    model_specific_functions, DefaultLoggingManager().DefaultLogger(),
+                                    ModelOptions(true, true));
+  onnxruntime::Graph& graph = p_model->MainGraph();
+
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+  auto& x_arg = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& state_arg = graph.GetOrCreateNodeArg("state", &tensor_float);
+  auto& state_out_arg = graph.GetOrCreateNodeArg("state_out", &tensor_float);
+  auto& y_arg = graph.GetOrCreateNodeArg("Y", &tensor_float);
+
+  graph.AddNode("add", "Add", "update state", {&state_arg, &x_arg}, {&state_out_arg});
+  graph.AddNode("mul", "Mul", "output", {&state_out_arg, &x_arg}, {&y_arg});
+  graph.SetInputs({&x_arg, &state_arg});
+  graph.SetOutputs({&state_out_arg, &y_arg});
+
+  ASSERT_STATUS_OK(graph.Resolve());
+}
+
+// the carried output changes shape after runs that kept it, and a failed run doesn't break the next ones
+TEST(InferenceSessionTests, StatefulOutputInputPairsShapeChange) {
+  std::unique_ptr<Model> p_model;
+  CreateUnshapedStatefulModel(p_model);
+  std::string model_str;
+  p_model->ToProto().SerializeToString(&model_str);
+
+  auto allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  auto make_value = [&](const std::vector<int64_t>& dims, const std::vector<float>& values) {
+    OrtValue value;
+    CreateMLValue<float>(allocator, dims, values, &value);
+    return value;
+  };
+
+  SessionOptions so;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsStatefulOutputInputPairs, "state_out:state"));
+  InferenceSession session_object{so, GetEnvironment()};
+  std::stringstream sstr(model_str);
+  ASSERT_STATUS_OK(session_object.Load(sstr));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  RunOptions run_options;
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<OrtValue> fetches;
+
+  NameMLValMap feeds{{"X", make_value({2}, {1.f, 2.f})}, {"state", make_value({2}, {0.f, 0.f})}};
+  ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+  VerifyOutputs(fetches, {2}, {1.f, 4.f});
+
+  // the state keeps its shape
+  const std::vector<std::vector<float>> y_values{{2.f, 3.f}, {3.f, 4.f}, {4.f, 5.f}};
+  for (const auto& y : y_values) {
+    fetches.clear();
+    feeds = NameMLValMap{{"X", make_value({2}, {1.f, 1.f})}};
+    ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+    VerifyOutputs(fetches, {2}, y);
+  }
+
+  // X broadcasts the state to a new shape
+  fetches.clear();
+  feeds = NameMLValMap{{"X", make_value({2, 2}, {1.f, 1.f, 2.f, 2.f})}};
+  ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+  VerifyOutputs(fetches, {2, 2}, {5.f, 6.f, 12.f, 14.f});
+
+  // a run failing on an invalid X keeps the state
+  fetches.clear();
+  feeds = NameMLValMap{{"X", make_value({3}, {1.f, 1.f, 1.f})}};
+  ASSERT_FALSE(session_object.Run(run_options, feeds, output_names, &fetches).IsOK());
+
+  fetches.clear();
+  feeds = NameMLValMap{{"X", make_value({2, 2}, {1.f, 0.f, 0.f, 1.f})}};
+  ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+  VerifyOutputs(fetches, {2, 2}, {6.f, 0.f, 0.f, 8.f});
+}
+
 TEST(InferenceSessionTests, InvalidInputTypeOfTensorElement) {
   SessionOptions so;
 
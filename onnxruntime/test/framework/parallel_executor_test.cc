@@ -1,10 +1,19 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 #include "core/framework/data_types.h"
 #include "core/framework/op_kernel.h"
+#include "core/framework/parallel_executor.h"
+#include "core/graph/model.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/test_environment.h"
 #include "test_utils.h"
+#include "asserts.h"
 #include "core/session/inference_session.h"
 
 #include "gtest/gtest.h"
@@ -117,6 +126,160 @@ TEST(ParallelExecutor, TestStatusPropagation) {
   }
 }
 
+// Towers of Add nodes that double their input, summed up at the end. Node "tower<t>_<i>" is the i-th node of tower t.
+static void CreateTowersModel(std::unique_ptr<Model>& model, const std::vector<int>& tower_lengths) {
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 12;
+  model = std::make_unique<Model>("towers", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                                  domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>{},
+                                  DefaultLoggingManager().DefaultLogger());
+  Graph& graph = model->MainGraph();
+
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+  NodeArg& input = graph.GetOrCreateNodeArg("X", &tensor_float);
+  std::vector<NodeArg*> tower_outputs;
+  for (size_t t = 0; t < tower_lengths.size(); ++t) {
+    NodeArg* prev = &input;
+    for (int i = 0; i < tower_lengths[t]; ++i) {
+      NodeArg& output = graph.GetOrCreateNodeArg(MakeString("tower", t, "_", i, "_out"), &tensor_float);
+      graph.AddNode(MakeString("tower", t, "_", i), "Add", "", {prev, prev}, {&output});
+      prev = &output;
+    }
+    tower_outputs.push_back(prev);
+  }
+  NodeArg& output = graph.GetOrCreateNodeArg("Y", &tensor_float);
+  graph.AddNode("sum", "Sum", "", tower_outputs, {&output});
+
+  ASSERT_STATUS_OK(graph.Resolve());
+}
+
+static NodeIndex GetNodeIndex(const GraphViewer& graph_viewer, const std::string& name) {
+  for (const auto& node : graph_viewer.Nodes()) {
+    if (node.Name() == name) {
+      return node.Index();
+    }
+  }
+  ORT_THROW("Node ", name, " is not found");
+}
+
+TEST(ParallelExecutor, ScheduleCriticalPath) {
+  std::unique_ptr<Model> model;
+  CreateTowersModel(model, {3, 1});
+  GraphViewer graph_viewer(model->MainGraph());
+  const auto& nodes = graph_viewer.GetNodesInTopologicalOrder();
+
+  const NodeIndex tower0_0 = GetNodeIndex(graph_viewer, "tower0_0");
+  const NodeIndex tower0_1 = GetNodeIndex(graph_viewer, "tower0_1");
+  const NodeIndex tower1_0 = GetNodeIndex(graph_viewer, "tower1_0");
+  const NodeIndex sum = GetNodeIndex(graph_viewer, "sum");
+
+  {
+    // unit costs: the longer tower goes first.
+    ParallelExecutionSchedule schedule(graph_viewer, nodes, {});
+    EXPECT_EQ(schedule.NumNodes(), 5u);
+    EXPECT_DOUBLE_EQ(schedule.Priority(tower0_0), 4.0);
+    EXPECT_DOUBLE_EQ(schedule.Priority(tower1_0), 2.0);
+    EXPECT_DOUBLE_EQ(schedule.Priority(sum), 1.0);
+    ASSERT_EQ(schedule.RootNodes().size(), 2u);
+    EXPECT_EQ(schedule.RootNodes()[0], tower0_0);
+    EXPECT_EQ(schedule.RootNodes()[1], tower1_0);
+
+    // tower0_1 reads the output of tower0_0 twice.
+    ASSERT_EQ(schedule.Consumers(tower0_0).size(), 1u);
+    EXPECT_EQ(schedule.Consumers(tower0_0)[0], tower0_1);
+    EXPECT_EQ(schedule.NumProducers(tower0_1), 1);
+    EXPECT_EQ(schedule.NumProducers(sum), 2);
+  }
+
+  {
+    // the single node of tower 1 is slower than all of tower 0. nodes without cost get the average.
+    InlinedHashMap<std::string, double> node_costs{{"tower0_0", 1.0}, {"tower0_1", 1.0}, {"tower1_0", 100.0}};
+    ParallelExecutionSchedule schedule(graph_viewer, nodes, node_costs);
+    EXPECT_DOUBLE_EQ(schedule.Priority(sum), 34.0);
+    EXPECT_DOUBLE_EQ(schedule.Priority(tower0_0), 70.0);
+    EXPECT_DOUBLE_EQ(schedule.Priority(tower1_0), 134.0);
+    EXPECT_EQ(schedule.RootNodes()[0], tower1_0);
+  }
+}
+
+TEST(ParallelExecutor, LoadNodeCosts) {
+  const std::string profile_file = "parallel_executor_test_profile.json";
+  {
+    std::ofstream file(profile_file);
+    file << R"([{"cat" : "Session","pid" :1,"tid" :1,"dur" :100,"ts" :0,"ph" : "X","name" :"model_run","args" : {}},)"
+         << R"({"cat" : "Node","pid" :1,"tid" :1,"dur" :10,"ts" :1,"ph" : "X","name" :"a_kernel_time","args" : {}},)"
+         << R"({"cat" : "Node","pid" :1,"tid" :1,"dur" :2,"ts" :1,"ph" : "X","name" :"a_fence_before","args" : {}},)"
+         << R"({"cat" : "Node","pid" :1,"tid" :1,"dur" :30,"ts" :20,"ph" : "X","name" :"a_kernel_time","args" : {}},)"
+         << R"({"cat" : "Node","pid" :1,"tid" :1,"dur" :5,"ts" :50,"ph" : "X","name" :"Add_3_kernel_time","args" : {}}])";
+  }
+
+  InlinedHashMap<std::string, double> node_costs;
+  ASSERT_STATUS_OK(ParallelExecutionSchedule::LoadNodeCosts(ToPathString(profile_file), node_costs));
+  EXPECT_EQ(node_costs.size(), 2u);
+  EXPECT_DOUBLE_EQ(node_costs["a"], 20.0);
+  EXPECT_DOUBLE_EQ(node_costs["Add_3"], 5.0);
+
+  {
+    std::ofstream file(profile_file);
+    file << "not json";
+  }
+  EXPECT_FALSE(ParallelExecutionSchedule::LoadNodeCosts(ToPathString(profile_file), node_costs).IsOK());
+  std::remove(profile_file.c_str());
+}
+
+TEST(ParallelExecutor, RunTowers) {
+  std::unique_ptr<Model> model;
+  const std::vector<int> tower_lengths{8, 3, 5, 1, 8, 2};
+  CreateTowersModel(model, tower_lengths);
+  std::string model_data;
+  model->ToProto().SerializeToString(&model_data);
+
+  float expected = 0.0f;
+  for (int length : tower_lengths) {
+    expected += static_cast<float>(1 << length);
+  }
+
+  for (bool with_costs : {false, true}) {
+    SessionOptions so;
+    so.session_logid = "ParallelExecutor.RunTowers";
+    so.execution_mode = ExecutionMode::ORT_PARALLEL;
+    so.inter_op_param.thread_pool_size = 4;
+    const std::string profile_file = "parallel_executor_run_towers_profile.json";
+    if (with_costs) {
+      std::ofstream file(profile_file);
+      file << R"([{"cat" : "Node","pid" :1,"tid" :1,"dur" :500,"ts" :0,"ph" : "X","name" :"tower3_0_kernel_time"}])";
+      file.close();
+      ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsParallelExecutorNodeCostsFile,
+                                                        profile_file.c_str()));
+    }
+
+    InferenceSession session{so, GetEnvironment()};
+    std::stringstream model_stream(model_data);
+    ASSERT_STATUS_OK(session.Load(model_stream));
+    ASSERT_STATUS_OK(session.Initialize());
+    if (with_costs) {
+      std::remove(profile_file.c_str());
+    }
+
+    OrtValue input;
+    CreateMLValue<float>(TestCPUExecutionProvider()->CreatePreferredAllocators()[0], std::vector<int64_t>{3},
+                         std::vector<float>{1.0f, 2.0f, -1.0f}, &input);
+    NameMLValMap feeds{{"X", input}};
+    for (int run = 0; run < 10; ++run) {
+      std::vector<OrtValue> fetches;
+      ASSERT_STATUS_OK(session.Run(RunOptions{}, feeds, {"Y"}, &fetches));
+      ASSERT_EQ(fetches.size(), 1u);
+      auto output = fetches[0].Get<Tensor>().DataAsSpan<float>();
+      ASSERT_EQ(output.size(), 3u);
+      EXPECT_EQ(output[0], expected);
+      EXPECT_EQ(output[1], 2 * expected);
+      EXPECT_EQ(output[2], -expected);
+    }
+  }
+}
+
 class ParallelExecutorThreadPoolTest : public testing::TestWithParam<int> {
 };
 
@@ -17,6 +17,7 @@
 #include "core/graph/model.h"
 #include "core/graph/model_saving_options.h"
 #include "core/graph/op.h"
+#include "core/platform/env.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/util/thread_utils.h"
@@ -1104,6 +1105,68 @@ TEST_F(SessionStateTestSharedInitalizersWithPrePacking, test3) {
   ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(1));
 }
 
+// Pre-packing enabled + shared initializers + pre-packed weights container + sessions pinned to a NUMA node with
+// replication = the sessions share a replica of the pre-packed weight placed on the node
+TEST_F(SessionStateTestSharedInitalizersWithPrePacking, NumaReplicatedPrePackedWeights) {
+  if (Env::Default().GetNumaNodeThreadAffinities(0).empty()) {
+    GTEST_SKIP() << "NUMA information is not available";
+  }
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "0";
+  sess_options.config_options.configurations[kOrtSessionOptionsNumaNode] = "0";
+  sess_options.config_options.configurations[kOrtSessionOptionsNumaReplicatePrepackedWeights] = "1";
+
+  OrtMemoryInfo mem_info(CPU, OrtDeviceAllocator);
+  std::vector<float> float_data(1, 1);
+  auto value = std::make_unique<OrtValue>();
+  Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), TensorShape(std::vector<int64_t>{1}),
+                       reinterpret_cast<void*>(float_data.data()), mem_info, *value);
+  ASSERT_STATUS_OK(sess_options.AddInitializer("node_0_input_1", value.get()));
+
+  PrepackedWeightsContainer prepacked_weights_container;
+
+  std::vector<const void*> packed_weights_used;
+  for (int i = 0; i < 2; ++i) {
+    Model model("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+                DefaultLoggingManager().DefaultLogger());
+    CreateSimpleGraph(model.MainGraph());
+    PlaceAllNodesToCPUEP(model.MainGraph());
+    SessionState session_state(model.MainGraph(),
+                               execution_providers,
+                               tp.get(),
+                               nullptr, /*inter_op_thread_pool*/
+                               dtm,
+                               edlm,
+                               DefaultLoggingManager().DefaultLogger(),
+                               profiler,
+                               sess_options,
+                               &prepacked_weights_container);
+    ASSERT_STATUS_OK(session_state.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                        kernel_registry_manager));
+
+    const auto* kernel = reinterpret_cast<const PrePackingTestOpKernel*>(session_state.GetKernel(0));
+    ASSERT_EQ(kernel->store_pre_packed_weight_calls_count, 1);
+    const auto* packed_weight = static_cast<const float*>(kernel->weight_packed_.get());
+    ASSERT_NE(packed_weight, nullptr);
+    EXPECT_EQ(packed_weight[0], 1.2345f);
+    EXPECT_EQ(packed_weight[1], 1.2345f * 2.f);
+    packed_weights_used.push_back(packed_weight);
+  }
+
+  // a single primary copy and a single replica on node 0, used by both sessions
+  ASSERT_EQ(prepacked_weights_container.GetNumberOfElements(), static_cast<size_t>(1));
+  ASSERT_EQ(prepacked_weights_container.GetNumberOfNumaReplicas(), static_cast<size_t>(1));
+  EXPECT_EQ(packed_weights_used[0], packed_weights_used[1]);
+  const auto& primary = prepacked_weights_container.prepacked_weights_map_.begin()->second;
+  EXPECT_NE(primary.buffers_[0].get(), packed_weights_used[0]);
+}
+
 // Pre-packing enabled + shared initializers +
 // pre-packed weights container + subgraphs =
 // caching enabled in pre-packed weights used in subgraphs
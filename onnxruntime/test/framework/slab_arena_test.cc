@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "core/framework/allocator_utils.h"
+#include "core/framework/slab_arena.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(SlabArenaTest, SmallAllocationsReuseBlocks) {
+  SlabArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30);
+
+  std::vector<void*> ptrs;
+  for (size_t size = 1; size <= 100; size++) {
+    void* p = a.Alloc(size);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % SlabArena::kMinBlockSize, 0u);
+    ptrs.push_back(p);
+  }
+
+  std::vector<void*> sorted_ptrs = ptrs;
+  std::sort(sorted_ptrs.begin(), sorted_ptrs.end());
+  EXPECT_EQ(std::adjacent_find(sorted_ptrs.begin(), sorted_ptrs.end()), sorted_ptrs.end());
+
+  // Sizes up to 64 bytes share the first class and larger ones the 128 bytes class.
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_allocs, 100);
+  EXPECT_EQ(stats.bytes_in_use, 64 * 64 + 36 * 128);
+  ASSERT_EQ(stats.size_class_stats.size(), SlabArena::kNumSizeClasses);
+  EXPECT_EQ(stats.size_class_stats[0].block_size, 64);
+  EXPECT_EQ(stats.size_class_stats[0].num_allocs, 64);
+  EXPECT_EQ(stats.size_class_stats[0].num_hits, 63);
+  EXPECT_EQ(stats.size_class_stats[1].num_allocs, 36);
+  EXPECT_EQ(stats.size_class_stats[1].num_hits, 35);
+
+  for (void* p : ptrs) {
+    a.Free(p);
+  }
+
+  // Freed blocks are handed out again without new slabs.
+  void* p = a.Alloc(16);
+  EXPECT_NE(std::find(ptrs.begin(), ptrs.end(), p), ptrs.end());
+  a.Free(p);
+
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.size_class_stats[0].num_allocs, 65);
+  EXPECT_EQ(stats.size_class_stats[0].num_hits, 64);
+}
+
+TEST(SlabArenaTest, LargeAllocationsUseBFCArena) {
+  SlabArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30);
+
+  void* small = a.Alloc(SlabArena::kMaxBlockSize);
+  void* large = a.Alloc(SlabArena::kMaxBlockSize + 1);
+  ASSERT_NE(small, nullptr);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(a.AllocatedSize(large), 4352u);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_allocs, 2);
+  EXPECT_EQ(stats.bytes_in_use, 4096 + 4352);
+  EXPECT_EQ(stats.size_class_stats.back().num_allocs, 1);
+
+  a.Free(large);
+  a.Free(small);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
+
+TEST(SlabArenaTest, CreateFromArenaConfig) {
+  OrtArenaCfg config(0, -1, -1, -1, -1, -1L, -1L, 1);
+  AllocatorCreationInfo device_info{
+      [](OrtDevice::DeviceId) { return std::make_unique<CPUAllocator>(); },
+      0, true, config};
+  auto allocator = CreateAllocator(device_info);
+  ASSERT_NE(allocator, nullptr);
+  EXPECT_EQ(allocator->Info().alloc_type, OrtArenaAllocator);
+
+  auto* arena = SlabArena::FromBFCArena(*static_cast<BFCArena*>(allocator.get()));
+  ASSERT_NE(arena, nullptr);
+
+  // Fill more than one slab group of the smallest class.
+  const size_t num_blocks = SlabArena::kSlabsPerGroup * SlabArena::kSlabSize / SlabArena::kMinBlockSize + 1;
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < num_blocks; i++) {
+    ptrs.push_back(arena->Alloc(8));
+  }
+  for (void* p : ptrs) {
+    arena->Free(p);
+  }
+
+  AllocatorStats stats;
+  arena->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.num_allocs, static_cast<int64_t>(num_blocks));
+  EXPECT_EQ(stats.size_class_stats[0].num_hits,
+            static_cast<int64_t>(num_blocks - SlabArena::kSlabsPerGroup - 1));
+}
+
+TEST(SlabArenaTest, RejectThreadCache) {
+  OrtArenaCfg config(0, -1, -1, -1, -1, -1L, 16 * 1024, 1);
+  AllocatorCreationInfo device_info{
+      [](OrtDevice::DeviceId) { return std::make_unique<CPUAllocator>(); },
+      0, true, config};
+  EXPECT_THROW(CreateAllocator(device_info), OnnxRuntimeException);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
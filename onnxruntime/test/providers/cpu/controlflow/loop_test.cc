@@ -1041,6 +1041,75 @@ TEST(Loop, IterationCountAsOutput) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
 }
 
+// Loop carried variables which swap their values, so the buffer allocated for one of them two iterations ago
+// is still used by the other one and the loop output, and can't be overwritten.
+TEST(Loop, LoopCarriedVarsSharingBuffers) {
+  auto create_subgraph = []() {
+    Model model("Fibonacci in subgraph", false, DefaultLoggingManager().DefaultLogger());
+    auto& graph = model.MainGraph();
+
+    /* Inputs: iter_num, cond_in, a_in, b_in.
+
+         a_in   b_in      a_in        a_in       cond_in
+           \    /          |           |           |
+           [Add]       [Identity]  [Identity]  [Identity]
+             |             |           |           |
+           a_out         b_out       a_scan     cond_out
+    */
+
+    TypeProto int64_scalar;
+    int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+    int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto bool_scalar;
+    bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+    bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+    auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+    auto& a_in = graph.GetOrCreateNodeArg("a_in", &float_tensor);
+    auto& b_in = graph.GetOrCreateNodeArg("b_in", &float_tensor);
+
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+    auto& a_out = graph.GetOrCreateNodeArg("a_out", &float_tensor);
+    auto& b_out = graph.GetOrCreateNodeArg("b_out", &float_tensor);
+    auto& a_scan = graph.GetOrCreateNodeArg("a_scan", &float_tensor);
+
+    graph.AddNode("add", "Add", "a + b", {&a_in, &b_in}, {&a_out});
+    graph.AddNode("b_identity", "Identity", "Forward a_in to b_out", {&a_in}, {&b_out});
+    graph.AddNode("scan_identity", "Identity", "Forward a_in to a_scan", {&a_in}, {&a_scan});
+    graph.AddNode("cond_identity", "Identity", "Forward cond_in to cond_out", {&cond_in}, {&cond_out});
+
+    graph.SetInputs({&iter_num_in, &cond_in, &a_in, &b_in});
+    graph.SetOutputs({&cond_out, &a_out, &b_out, &a_scan});
+
+    auto status = graph.Resolve();
+    EXPECT_EQ(status, Status::OK());
+
+    return graph.ToGraphProto();
+  };
+
+  OpTester test("Loop", 11);
+  auto body = create_subgraph();
+  test.AddAttribute<GraphProto>("body", body);
+  test.AddInput<int64_t>("M", {1}, {8});
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("a", {2}, {1.f, 2.f});
+  test.AddInput<float>("b", {2}, {0.f, 0.f});
+
+  test.AddOutput<float>("a_final", {2}, {34.f, 68.f});
+  test.AddOutput<float>("b_final", {2}, {21.f, 42.f});
+  test.AddOutput<float>("a_scan", {8, 2}, {1.f, 2.f, 1.f, 2.f, 2.f, 4.f, 3.f, 6.f,
+                                           5.f, 10.f, 8.f, 16.f, 13.f, 26.f, 21.f, 42.f});
+
+  // Disable TensorRT on unsupported data type BOOL
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+}
+
 #if defined(USE_CUDA) || defined(USE_ROCM)
 // test that when part of the subgraph run on CUDA/ROCm it executes successfully
 TEST(Loop, MixedExecutionProviders) {
@@ -907,6 +907,136 @@ TEST(Scan9, TransposeOutputDim2) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", RunOptions().excluded_provider_types);
 }
 
+// Body without loop state variables, so the iterations after the first one can run in parallel.
+// The output has a symbolic dimension so that its shape is only known once the first iteration ran.
+TEST(Scan9, StatelessBodyLongSequence) {
+  // scan-in-1 + scan-in-2 => scan-out-1
+  Model model("ScanBody", false, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  TypeProto float_tensor_symbolic;
+  float_tensor_symbolic.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor_symbolic.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("size");
+
+  auto& scan_in_1 = graph.GetOrCreateNodeArg("scan_in_1", &float_tensor);
+  auto& scan_in_2 = graph.GetOrCreateNodeArg("scan_in_2", &float_tensor);
+  auto& scan_out_1 = graph.GetOrCreateNodeArg("scan_out_1", &float_tensor_symbolic);
+
+  graph.AddNode("add", "Add", "Add scan_in_1 and scan_in_2", {&scan_in_1, &scan_in_2}, {&scan_out_1});
+
+  auto status = graph.Resolve();
+  EXPECT_EQ(status, Status::OK());
+
+  auto& scan_body = graph.ToGraphProto();
+
+  constexpr int64_t sequence_len = 100;
+  std::vector<float> input_1(sequence_len * 2);
+  std::vector<float> input_2(sequence_len * 2);
+  for (int64_t i = 0; i < sequence_len * 2; ++i) {
+    input_1[i] = static_cast<float>(i);
+    input_2[i] = static_cast<float>(1000 * i);
+  }
+
+  // the second input is read in reverse
+  std::vector<float> output_1(sequence_len * 2);
+  for (int64_t t = 0; t < sequence_len; ++t) {
+    for (int64_t j = 0; j < 2; ++j) {
+      output_1[t * 2 + j] = input_1[t * 2 + j] + input_2[(sequence_len - 1 - t) * 2 + j];
+    }
+  }
+
+  ScanOpTester test{9};
+  test.AddAttribute("body", scan_body);
+  test.AddAttribute<int64_t>("num_scan_inputs", 2);
+  test.AddAttribute<std::vector<int64_t>>("scan_input_directions", {0, 1});
+
+  test.AddInput<float>("scan_input_1", {sequence_len, 2}, input_1);
+  test.AddInput<float>("scan_input_2", {sequence_len, 2}, input_2);
+  test.AddOutput<float>("scan_output_1", {sequence_len, 2}, output_1);
+
+  // the iterations only run in parallel with more than one intra-op thread
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess, "", RunOptions().excluded_provider_types);
+}
+
+// Stateless body containing a nested Scan, so the nested subgraph runs inside the parallel iterations of the outer
+// Scan and must not use the intra-op thread pool that runs them.
+TEST(Scan9, StatelessBodyWithNestedScan) {
+  constexpr int64_t sequence_len = 16;
+  constexpr int64_t inner_sequence_len = 4;
+  constexpr int64_t size = 1024;
+
+  // inner body: inner-scan-in-1 + inner-scan-in-2 => inner-scan-out-1
+  Model inner_model("InnerScanBody", false, DefaultLoggingManager().DefaultLogger());
+  auto& inner_graph = inner_model.MainGraph();
+  {
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(size);
+
+    auto& inner_in_1 = inner_graph.GetOrCreateNodeArg("inner_scan_in_1", &float_tensor);
+    auto& inner_in_2 = inner_graph.GetOrCreateNodeArg("inner_scan_in_2", &float_tensor);
+    auto& inner_out_1 = inner_graph.GetOrCreateNodeArg("inner_scan_out_1", &float_tensor);
+    inner_graph.AddNode("add", "Add", "Add inner_scan_in_1 and inner_scan_in_2", {&inner_in_1, &inner_in_2},
+                        {&inner_out_1});
+
+    auto status = inner_graph.Resolve();
+    ASSERT_EQ(status, Status::OK());
+  }
+
+  // outer body: Scan(scan-in-1, scan-in-2) => scan-out-1
+  Model model("ScanBody", false, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  {
+    TypeProto float_tensor;
+    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(inner_sequence_len);
+    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(size);
+
+    auto& scan_in_1 = graph.GetOrCreateNodeArg("scan_in_1", &float_tensor);
+    auto& scan_in_2 = graph.GetOrCreateNodeArg("scan_in_2", &float_tensor);
+    auto& scan_out_1 = graph.GetOrCreateNodeArg("scan_out_1", &float_tensor);
+
+    auto& inner_scan = graph.AddNode("inner_scan", "Scan", "Scan over scan_in_1 and scan_in_2",
+                                     {&scan_in_1, &scan_in_2}, {&scan_out_1});
+    inner_scan.AddAttribute("body", inner_graph.ToGraphProto());
+    inner_scan.AddAttribute("num_scan_inputs", static_cast<int64_t>(2));
+
+    auto status = graph.Resolve();
+    ASSERT_EQ(status, Status::OK());
+  }
+
+  auto& scan_body = graph.ToGraphProto();
+
+  constexpr int64_t total = sequence_len * inner_sequence_len * size;
+  std::vector<float> input_1(total);
+  std::vector<float> input_2(total);
+  std::vector<float> output_1(total);
+  for (int64_t i = 0; i < total; ++i) {
+    input_1[i] = static_cast<float>(i % 1000);
+    input_2[i] = static_cast<float>(i % 7);
+    output_1[i] = input_1[i] + input_2[i];
+  }
+
+  ScanOpTester test{9};
+  test.AddAttribute("body", scan_body);
+  test.AddAttribute<int64_t>("num_scan_inputs", 2);
+
+  test.AddInput<float>("scan_input_1", {sequence_len, inner_sequence_len, size}, input_1);
+  test.AddInput<float>("scan_input_2", {sequence_len, inner_sequence_len, size}, input_2);
+  test.AddOutput<float>("scan_output_1", {sequence_len, inner_sequence_len, size}, output_1);
+
+  // the outer iterations only run in parallel with more than one intra-op thread
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess, "", RunOptions().excluded_provider_types);
+}
+
 static void InvalidInput(bool is_v8) {
   constexpr int64_t batch_size = 1;
   constexpr int64_t sequence_len = 2;
@@ -645,6 +645,38 @@ TEST(TopKOperator, NthElement_double) {
   RunTest(11, 4, input_vals, input_dimensions, expected_vals, expected_indices, expected_dimensions, false);
 }
 
+// test path where the top k of a long row is found by radix selection, which is used for float when there are
+// fewer rows than threads. values are repeated to check that ties are broken by index.
+static void top_k_radix_select(int64_t largest) {
+  const int64_t n = 100000;
+  const int64_t k = 100;
+  std::vector<float> input_vals(n);
+  for (int64_t i = 0; i < n; ++i) {
+    input_vals[i] = static_cast<float>((i * 7919) % 1001 - 500) / 4.0f;
+  }
+
+  std::vector<int64_t> order(n);
+  std::iota(order.begin(), order.end(), int64_t{0});
+  std::stable_sort(order.begin(), order.end(), [&](int64_t lhs, int64_t rhs) {
+    return largest ? input_vals[lhs] > input_vals[rhs] : input_vals[lhs] < input_vals[rhs];
+  });
+  std::vector<float> expected_vals(k);
+  std::vector<int64_t> expected_indices(order.begin(), order.begin() + k);
+  for (int64_t i = 0; i < k; ++i) {
+    expected_vals[i] = input_vals[expected_indices[i]];
+  }
+
+  RunTest(11, k, input_vals, {n}, expected_vals, expected_indices, {k}, false, -1, largest);
+}
+
+TEST(TopKOperator, RadixSelectLargestElements) {
+  top_k_radix_select(1);
+}
+
+TEST(TopKOperator, RadixSelectSmallestElements) {
+  top_k_radix_select(0);
+}
+
 TEST(TopKOperator, NthElementHalf) {
   if (!HasCudaEnvironment(600)) {
     return;
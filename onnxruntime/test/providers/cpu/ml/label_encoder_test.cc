@@ -511,5 +511,37 @@ TEST(LabelEncoder, DoubleNaNsMappedTogetherOpset4) {
   test.Run();
 }
 
+// Enough keys for the lookup table to grow several times and an input longer than a lookup batch.
+TEST(LabelEncoder, LargeVocabularyStringToInt64Opset2) {
+  constexpr int64_t num_keys = 5000;
+  std::vector<std::string> keys;
+  std::vector<int64_t> values;
+  for (int64_t i = 0; i < num_keys; ++i) {
+    keys.push_back("token_" + std::to_string(i));
+    values.push_back(i * 7);
+  }
+  // a repeated key keeps the value of its first occurrence
+  keys.push_back("token_3");
+  values.push_back(-3);
+
+  std::vector<std::string> input;
+  std::vector<int64_t> output;
+  for (int64_t i = 0; i < 2 * num_keys; i += 3) {
+    input.push_back("token_" + std::to_string(i));
+    output.push_back(i < num_keys ? i * 7 : 42);
+  }
+
+  OpTester test("LabelEncoder", 2, onnxruntime::kMLDomain);
+  test.AddAttribute("keys_strings", keys);
+  test.AddAttribute("values_int64s", values);
+  test.AddAttribute<int64_t>("default_int64", 42);
+
+  const std::vector<int64_t> dims{static_cast<int64_t>(input.size())};
+  test.AddInput<std::string>("X", dims, input);
+  test.AddOutput<int64_t>("Y", dims, output);
+
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
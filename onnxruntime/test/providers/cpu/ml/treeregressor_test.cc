@@ -1,6 +1,9 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cmath>
+#include <limits>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -844,5 +847,118 @@ TEST(MLOpTest, TreeRegressorTrueNodeBeforeNode) {
   test.Run();
 }
 
+// Ensemble of n_trees complete trees of depth 4 on 5 features, node k having the children 2k+1 (true) and
+// 2k+2 (false). Each tree has 16 leaves, so with 16 trees or more the ensemble has the 128 leaves the bitvector
+// evaluator needs, and it is evaluated with bitvectors for BRANCH_LEQ and BRANCH_LT. The expected scores come from
+// walking the trees.
+static void RunTreeRegressorCompleteTreesTest(const std::string& mode, int64_t n_targets, bool missing_tracks,
+                                              int64_t n_rows, int64_t n_trees = 40) {
+  constexpr int64_t n_nodes = 31;
+  constexpr int64_t first_leaf = 15;
+  constexpr int64_t n_features = 5;
+
+  std::vector<int64_t> nodes_treeids, nodes_nodeids, nodes_featureids, nodes_truenodeids, nodes_falsenodeids;
+  std::vector<int64_t> nodes_missing_value_tracks_true;
+  std::vector<float> nodes_values;
+  std::vector<std::string> nodes_modes;
+  std::vector<int64_t> target_treeids, target_nodeids, target_ids;
+  std::vector<float> target_weights;
+  for (int64_t t = 0; t < n_trees; ++t) {
+    for (int64_t k = 0; k < n_nodes; ++k) {
+      const bool is_leaf = k >= first_leaf;
+      nodes_treeids.push_back(t);
+      nodes_nodeids.push_back(k);
+      nodes_featureids.push_back(is_leaf ? 0 : (t * 7 + k) % n_features);
+      nodes_values.push_back(is_leaf ? 0.f : static_cast<float>((t * 13 + k * 7) % 11) * 0.5f - 2.5f);
+      nodes_modes.push_back(is_leaf ? "LEAF" : mode);
+      nodes_truenodeids.push_back(is_leaf ? 0 : 2 * k + 1);
+      nodes_falsenodeids.push_back(is_leaf ? 0 : 2 * k + 2);
+      nodes_missing_value_tracks_true.push_back(!is_leaf && missing_tracks && k % 3 == 0 ? 1 : 0);
+      if (is_leaf) {
+        for (int64_t target = 0; target < n_targets; ++target) {
+          target_treeids.push_back(t);
+          target_nodeids.push_back(k);
+          target_ids.push_back(target);
+          target_weights.push_back(static_cast<float>((t * 31 + k * 17 + target * 5) % 19) * 0.25f - 2.f);
+        }
+      }
+    }
+  }
+
+  std::vector<float> X;
+  for (int64_t r = 0; r < n_rows; ++r) {
+    for (int64_t f = 0; f < n_features; ++f) {
+      X.push_back(missing_tracks && r % 9 == 0 && f == r % n_features
+                      ? std::numeric_limits<float>::quiet_NaN()
+                      : static_cast<float>((r * 3 + f * 5) % 13) * 0.5f - 3.f);
+    }
+  }
+
+  std::vector<float> Y(onnxruntime::narrow<size_t>(n_rows * n_targets), 0.f);
+  for (int64_t r = 0; r < n_rows; ++r) {
+    const float* x = X.data() + r * n_features;
+    for (int64_t t = 0; t < n_trees; ++t) {
+      int64_t k = 0;
+      while (k < first_leaf) {
+        const size_t node = onnxruntime::narrow<size_t>(t * n_nodes + k);
+        const float val = x[nodes_featureids[node]];
+        const float threshold = nodes_values[node];
+        bool go_true = mode == "BRANCH_LEQ"   ? val <= threshold
+                       : mode == "BRANCH_LT"  ? val < threshold
+                       : mode == "BRANCH_GTE" ? val >= threshold
+                                              : val > threshold;
+        go_true = go_true || (nodes_missing_value_tracks_true[node] == 1 && std::isnan(val));
+        k = go_true ? 2 * k + 1 : 2 * k + 2;
+      }
+      for (int64_t target = 0; target < n_targets; ++target) {
+        Y[onnxruntime::narrow<size_t>(r * n_targets + target)] +=
+            static_cast<float>((t * 31 + k * 17 + target * 5) % 19) * 0.25f - 2.f;
+      }
+    }
+  }
+
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+  test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+  test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+  test.AddAttribute("nodes_treeids", nodes_treeids);
+  test.AddAttribute("nodes_nodeids", nodes_nodeids);
+  test.AddAttribute("nodes_featureids", nodes_featureids);
+  test.AddAttribute("nodes_values", nodes_values);
+  test.AddAttribute("nodes_modes", nodes_modes);
+  test.AddAttribute("nodes_missing_value_tracks_true", nodes_missing_value_tracks_true);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", n_targets);
+  test.AddAttribute("aggregate_function", std::string("SUM"));
+  test.AddInput<float>("X", {n_rows, n_features}, X);
+  test.AddOutput<float>("Y", {n_rows, n_targets}, Y);
+  test.Run();
+}
+
+TEST(MLOpTest, TreeRegressorBitvectorSingleTarget) {
+  RunTreeRegressorCompleteTreesTest("BRANCH_LEQ", 1, false, 1);
+  RunTreeRegressorCompleteTreesTest("BRANCH_LEQ", 1, false, 64);
+  RunTreeRegressorCompleteTreesTest("BRANCH_LT", 1, false, 64);
+}
+
+TEST(MLOpTest, TreeRegressorBitvectorMultiTarget) {
+  RunTreeRegressorCompleteTreesTest("BRANCH_LEQ", 3, false, 1);
+  RunTreeRegressorCompleteTreesTest("BRANCH_LT", 3, false, 64);
+}
+
+TEST(MLOpTest, TreeRegressorBitvectorMissingTracks) {
+  RunTreeRegressorCompleteTreesTest("BRANCH_LEQ", 1, true, 64);
+  RunTreeRegressorCompleteTreesTest("BRANCH_LT", 2, true, 64);
+}
+
+TEST(MLOpTest, TreeRegressorFlatTrees) {
+  // walked in batches of rows
+  RunTreeRegressorCompleteTreesTest("BRANCH_GTE", 1, false, 37);
+  RunTreeRegressorCompleteTreesTest("BRANCH_GT", 2, true, 70);
+  RunTreeRegressorCompleteTreesTest("BRANCH_LEQ", 1, true, 53, 3);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -576,6 +576,30 @@ TEST(TfIdfVectorizerTest, String_TFIDF_onlyBigrams_Skip5) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+// n-grams which overlap or are suffixes of each other, the scan must resume
+// from the longest matching suffix after (1, 2) is not followed by 4.
+TEST(TfIdfVectorizerTest, Int64_TF_OverlappingNgrams_Skip0) {
+  OpTester test("TfIdfVectorizer", opset_ver);
+  InitTestAttr(test, "TF", 1, 3, 0,
+               {0, 2, 6},
+               {0, 1, 2, 3, 4, 5},  // 6 output indexes
+               {},
+               {1, 2,               // 1-grams
+                2, 3, 1, 2,         // bi-grams
+                1, 2, 4, 2, 3, 4},  // tri-grams
+               {});
+
+  std::vector<int64_t> dims{7};
+  std::vector<int64_t> input = {1, 2, 3, 4, 1, 2, 4};
+  test.AddInput<int64_t>("T", dims, input);
+
+  std::vector<int64_t> out_dims{6};
+  std::vector<float> output = {2, 2, 1, 2, 1, 1};
+  test.AddOutput<float>("Y", out_dims, output);
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 TEST(TfIdfVectorizerTest, Int32_IDFWeights_onlyBigrams_Skip5) {
   OpTester test("TfIdfVectorizer", opset_ver);
   // s=5, Min=Max=2, weights specified, int32
@@ -304,6 +304,46 @@ TEST(NonMaxSuppressionOpTest, SelectFromIdenticalBoxes) {
   test.Run();
 }
 
+// more selected boxes than checked at once against a candidate, and enough classes to be processed in parallel
+TEST(NonMaxSuppressionOpTest, ManyClassesManySelectedBoxes) {
+  constexpr int64_t num_batches = 2;
+  constexpr int64_t num_classes = 8;
+  constexpr int64_t num_pairs = 40;
+
+  // box 2 * i is at x = 2 * i, box 2 * i + 1 is a copy shifted by 0.1 with a lower score, which it suppresses
+  std::vector<float> boxes;
+  for (int64_t batch_index = 0; batch_index < num_batches; ++batch_index) {
+    for (int64_t i = 0; i < num_pairs; ++i) {
+      const float x = 2.0f * i;
+      boxes.insert(boxes.end(), {0.0f, x, 1.0f, x + 1.0f, 0.0f, x + 0.1f, 1.0f, x + 1.1f});
+    }
+  }
+
+  // the scores decrease with i in even classes and increase in odd classes
+  std::vector<float> scores;
+  std::vector<int64_t> selected_indices;
+  for (int64_t batch_index = 0; batch_index < num_batches; ++batch_index) {
+    for (int64_t class_index = 0; class_index < num_classes; ++class_index) {
+      for (int64_t i = 0; i < num_pairs; ++i) {
+        const float score = 0.01f * static_cast<float>(class_index % 2 == 0 ? num_pairs - i : i + 1);
+        scores.insert(scores.end(), {score, score - 0.005f});
+      }
+      for (int64_t i = 0; i < num_pairs; ++i) {
+        const int64_t box_index = 2 * (class_index % 2 == 0 ? i : num_pairs - 1 - i);
+        selected_indices.insert(selected_indices.end(), {batch_index, class_index, box_index});
+      }
+    }
+  }
+
+  OpTester test("NonMaxSuppression", 11, kOnnxDomain);
+  test.AddInput<float>("boxes", {num_batches, 2 * num_pairs, 4}, boxes);
+  test.AddInput<float>("scores", {num_batches, num_classes, 2 * num_pairs}, scores);
+  test.AddInput<int64_t>("max_output_boxes_per_class", {}, {100L});
+  test.AddInput<float>("iou_threshold", {}, {0.5f});
+  test.AddOutput<int64_t>("selected_indices", {num_batches * num_classes * num_pairs, 3}, selected_indices);
+  test.Run();
+}
+
 TEST(NonMaxSuppressionOpTest, InconsistentBoxAndScoreShapes) {
   OpTester test("NonMaxSuppression", 10, kOnnxDomain);
   test.AddInput<float>("boxes", {1, 6, 4},
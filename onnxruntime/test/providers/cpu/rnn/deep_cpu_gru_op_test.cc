@@ -3,11 +3,14 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <iterator>
+#include <string>
 #include <vector>
 
 #include "core/providers/cpu/rnn/deep_cpu_gru.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/providers/cpu/rnn/rnn_test_utils.h"
 #include "test/util/include/default_providers.h"
 using namespace std;
 namespace onnxruntime {
@@ -1024,6 +1027,31 @@ TEST(GRUTest, ONNXRuntime_TestGRUOpSingleBatchMultipleHiddenThreads) {
   ctx.RunTest(X, batch_size, seq_length, sequence_length, &initial_h, expected_Y, expected_Y_h);
 }
 
+static void BidirectionalMultiThreaded(int64_t batch_size, int64_t input_size, int64_t hidden_size) {
+  for (int64_t linear_before_reset : {0, 1}) {
+    RunBidirectionalMultiThreaded(
+        "GRU", 3, [linear_before_reset](OpTester& test) {
+          test.AddAttribute<int64_t>("linear_before_reset", linear_before_reset);
+        },
+        batch_size, input_size, hidden_size);
+  }
+}
+
+// the directions are computed at the same time, each one on a single thread
+TEST(GRUTest, BidirectionalMultiThreadedSmallHidden) {
+  BidirectionalMultiThreaded(2, 8, 16);
+}
+
+// the GEMMs of the steps are split between threads, so the directions are computed one after the other
+TEST(GRUTest, BidirectionalMultiThreadedLargeHidden) {
+  BidirectionalMultiThreaded(4, 8, 128);
+}
+
+// the GEMM of the input projection is split between threads, so the directions are computed one after the other
+TEST(GRUTest, BidirectionalMultiThreadedLargeInput) {
+  BidirectionalMultiThreaded(2, 1024, 16);
+}
+
 TEST(GRUTest, ONNXRuntime_TestGRUPositiveActivationClipping) {
   const std::string direction = "forward";
   const std::vector<std::string> activations = {"Sigmoid", "Tanh"};
@@ -3,11 +3,14 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <iterator>
+#include <string>
 #include <vector>
 
 #include "core/providers/cpu/rnn/deep_cpu_lstm.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/providers/cpu/rnn/rnn_test_utils.h"
 #include "default_providers.h"
 
 using namespace std;
@@ -529,6 +532,25 @@ TEST(LSTMTest, LargeBatchWithClip) {
   LargeBatchWithClip(Y_h_data, 4.f);
 }
 
+static void BidirectionalMultiThreaded(int64_t batch_size, int64_t input_size, int64_t hidden_size) {
+  RunBidirectionalMultiThreaded("LSTM", 4, [](OpTester&) {}, batch_size, input_size, hidden_size);
+}
+
+// the directions are computed at the same time, each one on a single thread
+TEST(LSTMTest, BidirectionalMultiThreadedSmallHidden) {
+  BidirectionalMultiThreaded(2, 8, 16);
+}
+
+// the GEMMs of the steps are split between threads, so the directions are computed one after the other
+TEST(LSTMTest, BidirectionalMultiThreadedLargeHidden) {
+  BidirectionalMultiThreaded(4, 8, 128);
+}
+
+// the GEMM of the input projection is split between threads, so the directions are computed one after the other
+TEST(LSTMTest, BidirectionalMultiThreadedLargeInput) {
+  BidirectionalMultiThreaded(2, 1024, 16);
+}
+
 // ONNXRuntime tests
 class LstmOpContext2x1x2x2 {
  public:
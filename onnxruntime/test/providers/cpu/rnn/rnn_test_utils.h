@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+
+namespace onnxruntime {
+namespace test {
+
+// Runs a forward or reverse RNN of op_type ("LSTM", "GRU") with num_gates gates on one thread, and returns Y and Y_h.
+// add_attributes adds the attributes specific to op_type.
+inline void ComputeRnnDirection(const std::string& op_type, int64_t num_gates, const std::string& direction,
+                                const std::function<void(OpTester&)>& add_attributes, int64_t seq_length,
+                                int64_t batch_size, int64_t input_size, int64_t hidden_size,
+                                const std::vector<float>& X_data, const std::vector<float>& W_data,
+                                const std::vector<float>& R_data, const std::vector<float>& B_data,
+                                std::vector<float>& Y_data, std::vector<float>& Y_h_data) {
+  OpTester test(op_type.c_str(), 7 /*opset_version*/, onnxruntime::kOnnxDomain /*domain*/, false /*verify_output*/);
+  test.AddAttribute("direction", direction);
+  test.AddAttribute("hidden_size", hidden_size);
+  add_attributes(test);
+
+  test.AddInput<float>("X", {seq_length, batch_size, input_size}, X_data);
+  test.AddInput<float>("W", {1, num_gates * hidden_size, input_size}, W_data, true);
+  test.AddInput<float>("R", {1, num_gates * hidden_size, hidden_size}, R_data, true);
+  test.AddInput<float>("B", {1, 2 * num_gates * hidden_size}, B_data, true);
+
+  Y_data.resize(seq_length * batch_size * hidden_size);
+  Y_h_data.resize(batch_size * hidden_size);
+  test.AddOutput<float>("Y", {seq_length, 1, batch_size, hidden_size}, Y_data);
+  test.AddOutput<float>("Y_h", {1, batch_size, hidden_size}, Y_h_data);
+
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 1;
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+
+  std::vector<OrtValue> outputs = test.GetFetches();
+  const auto& Y = outputs[0].Get<Tensor>();
+  std::copy(Y.Data<float>(), Y.Data<float>() + Y_data.size(), Y_data.begin());
+  const auto& Y_h = outputs[1].Get<Tensor>();
+  std::copy(Y_h.Data<float>(), Y_h.Data<float>() + Y_h_data.size(), Y_h_data.begin());
+}
+
+// Runs a bidirectional RNN of op_type with num_gates gates on several threads and compares it with the forward and
+// reverse RNNs of each half of the weights run on one thread.
+inline void RunBidirectionalMultiThreaded(const std::string& op_type, int64_t num_gates,
+                                          const std::function<void(OpTester&)>& add_attributes,
+                                          int64_t batch_size, int64_t input_size, int64_t hidden_size) {
+  constexpr int64_t seq_length = 3;
+
+  int n = 0;
+  auto generate = [&n](size_t size) {
+    std::vector<float> data(size);
+    std::generate(data.begin(), data.end(), [&n]() { return static_cast<float>((n++ * 37) % 101 - 50) / 500.f; });
+    return data;
+  };
+
+  const std::vector<float> X_data = generate(seq_length * batch_size * input_size);
+  const std::vector<float> W_data = generate(2 * num_gates * hidden_size * input_size);
+  const std::vector<float> R_data = generate(2 * num_gates * hidden_size * hidden_size);
+  const std::vector<float> B_data = generate(2 * 2 * num_gates * hidden_size);
+  auto half = [](const std::vector<float>& data, int64_t direction) {
+    const auto size = static_cast<int64_t>(data.size()) / 2;
+    return std::vector<float>(data.begin() + direction * size, data.begin() + (direction + 1) * size);
+  };
+
+  const int64_t step_size = batch_size * hidden_size;
+  std::vector<float> Y_data(seq_length * 2 * step_size);
+  std::vector<float> Y_h_data;
+  for (int64_t direction = 0; direction < 2; ++direction) {
+    std::vector<float> direction_Y;
+    std::vector<float> direction_Y_h;
+    ComputeRnnDirection(op_type, num_gates, direction == 0 ? "forward" : "reverse", add_attributes, seq_length,
+                        batch_size, input_size, hidden_size, X_data, half(W_data, direction),
+                        half(R_data, direction), half(B_data, direction), direction_Y, direction_Y_h);
+    for (int64_t t = 0; t < seq_length; ++t) {
+      std::copy_n(direction_Y.begin() + t * step_size, step_size, Y_data.begin() + (t * 2 + direction) * step_size);
+    }
+    Y_h_data.insert(Y_h_data.end(), direction_Y_h.begin(), direction_Y_h.end());
+  }
+
+  OpTester test(op_type.c_str());
+  test.AddAttribute("direction", "bidirectional");
+  test.AddAttribute("hidden_size", hidden_size);
+  add_attributes(test);
+
+  test.AddInput<float>("X", {seq_length, batch_size, input_size}, X_data);
+  test.AddInput<float>("W", {2, num_gates * hidden_size, input_size}, W_data, true);
+  test.AddInput<float>("R", {2, num_gates * hidden_size, hidden_size}, R_data, true);
+  test.AddInput<float>("B", {2, 2 * num_gates * hidden_size}, B_data, true);
+  test.AddOutput<float>("Y", {seq_length, 2, batch_size, hidden_size}, Y_data);
+  test.AddOutput<float>("Y_h", {2, batch_size, hidden_size}, Y_h_data);
+  test.SetOutputTolerance(0.0001f);
+
+  SessionOptions so;
+  so.intra_op_param.thread_pool_size = 4;
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
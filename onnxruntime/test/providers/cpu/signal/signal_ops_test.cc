@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cmath>
 #include <functional>
 #include <vector>
 
@@ -116,6 +117,43 @@ TEST(SignalOpsTest, DFT20_Float_inverse) {
   TestInverseFloat(kOpsetVersion20);
 }
 
+// Lengths which are not powers of 2: mixed radix (12 = 4 * 3, 400 = 4 * 4 * 5 * 5) and Bluestein (37, 2 * 37),
+// compared with a naive DFT.
+TEST(SignalOpsTest, DFT20_Float_mixed_radix) {
+  for (int64_t n : {12, 37, 74, 400}) {
+    for (bool inverse : {false, true}) {
+      OpTester test("DFT", kOpsetVersion20);
+      vector<float> input(static_cast<size_t>(n) * 2);
+      for (int64_t j = 0; j < n; j++) {
+        input[j * 2] = std::cos(0.1f * j) + 0.5f;
+        input[j * 2 + 1] = std::sin(0.3f * j);
+      }
+
+      const double sign = inverse ? 1.0 : -1.0;
+      vector<float> expected_output(static_cast<size_t>(n) * 2);
+      for (int64_t k = 0; k < n; k++) {
+        double real = 0, imag = 0;
+        for (int64_t j = 0; j < n; j++) {
+          const double angle = sign * 2 * M_PI * static_cast<double>((j * k) % n) / static_cast<double>(n);
+          real += input[j * 2] * std::cos(angle) - input[j * 2 + 1] * std::sin(angle);
+          imag += input[j * 2] * std::sin(angle) + input[j * 2 + 1] * std::cos(angle);
+        }
+        const double scale = inverse ? 1.0 / static_cast<double>(n) : 1.0;
+        expected_output[k * 2] = static_cast<float>(real * scale);
+        expected_output[k * 2 + 1] = static_cast<float>(imag * scale);
+      }
+
+      test.AddInput<float>("input", {1, n, 2}, input);
+      test.AddInput<int64_t>("dft_length", {}, {n});
+      test.AddInput<int64_t>("axis", {}, {1});
+      test.AddAttribute<int64_t>("inverse", static_cast<int64_t>(inverse));
+      test.AddOutput<float>("output", {1, n, 2}, expected_output);
+      test.SetOutputAbsErr("output", 0.001f);
+      test.Run();
+    }
+  }
+}
+
 // Tests that FFT(FFT(x), inverse=true) == x
 static void TestDFTInvertible(bool complex, int since_version) {
   // TODO: test dft_length
@@ -233,6 +271,26 @@ TEST(SignalOpsTest, STFTFloat) {
   test.Run();
 }
 
+TEST(SignalOpsTest, STFTFloat_bluestein) {
+  OpTester test("STFT", kMinOpsetVersion);
+
+  vector<float> signal(2 * 100, 1);
+  test.AddInput<float>("signal", {2, 100, 1}, signal);
+  test.AddInput<int64_t>("frame_step", {}, {9});
+  vector<float> window(37, 1);
+  test.AddInput<float>("window", {37}, window);
+  test.AddInput<int64_t>("frame_length", {}, {37});
+
+  // 2 batches of 8 frames of 19 bins, only the first bin of each frame is not zero.
+  vector<float> expected_output(2 * 8 * 19 * 2, 0);
+  for (size_t frame = 0; frame < 2 * 8; frame++) {
+    expected_output[frame * 19 * 2] = 37.f;
+  }
+  test.AddOutput<float>("output", {2, 8, 19, 2}, expected_output);
+  test.SetOutputAbsErr("output", 0.0001f);
+  test.Run();
+}
+
 TEST(SignalOpsTest, HannWindowFloat) {
   OpTester test("HannWindow", kMinOpsetVersion);
 
@@ -1,7 +1,12 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <exception>
+#include <string>
+#include <vector>
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 #include "test/util/include/default_providers.h"
@@ -837,6 +842,42 @@ TEST(ResizeOpTest, ResizeOpLinearUpSampleTest_2DBilinear_align_corners) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", ExcludeTrtOnA100());
 }
 
+// enough channels and rows to be split between threads. bilinear interpolation of a linear function is exact.
+TEST(ResizeOpTest, ResizeOpLinearUpSampleTest_4DBilinear_align_corners_MultiChannel) {
+  OpTester test("Resize", 13);
+  std::vector<float> roi{};
+  std::vector<float> scales{1.0f, 1.0f, 1.8f, 1.8f};
+  test.AddAttribute("mode", "linear");
+  test.AddAttribute("coordinate_transformation_mode", "align_corners");
+
+  constexpr int64_t N = 2, C = 4, H = 5, W = 5, OH = 9, OW = 9;
+  std::vector<float> X;
+  for (int64_t c = 0; c < N * C; ++c) {
+    for (int64_t y = 0; y < H; ++y) {
+      for (int64_t x = 0; x < W; ++x) {
+        X.push_back(static_cast<float>(100 * c + 10 * y + x));
+      }
+    }
+  }
+
+  // output (y, x) is at (y / 2, x / 2) in the input
+  std::vector<float> Y;
+  for (int64_t c = 0; c < N * C; ++c) {
+    for (int64_t y = 0; y < OH; ++y) {
+      for (int64_t x = 0; x < OW; ++x) {
+        Y.push_back(static_cast<float>(100 * c) + 5.0f * y + 0.5f * x);
+      }
+    }
+  }
+
+  test.AddInput<float>("X", {N, C, H, W}, X);
+  test.AddInput<float>("roi", {0}, roi);
+  test.AddInput<float>("scales", {4}, scales);
+
+  test.AddOutput<float>("Y", {N, C, OH, OW}, Y);
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", ExcludeTrtOnA100());
+}
+
 TEST(ResizeOpTest, ResizeOpLinearDownSampleTest_3DTrilinear_pytorch_half_pixel) {
   // TODO: Unskip when fixed #41968513
   if (DefaultDmlExecutionProvider().get() != nullptr) {
@@ -1598,6 +1639,142 @@ TEST(ResizeOpTest, ResizeOpCubicUpSampleTest_tf_half_pixel_for_nn) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", ExcludeTrtOnA100());
 }
 
+// Bicubic resize of a NCHW float tensor computed pixel by pixel, as the CPU kernel did before it interpolated in
+// separable passes. coordinate_transformation_mode is one of half_pixel, asymmetric and tf_crop_and_resize.
+static std::vector<float> ResizeBicubicReference(const std::vector<float>& X, const std::vector<int64_t>& dims,
+                                                 const std::vector<float>& scales, const std::vector<float>& roi,
+                                                 const std::string& coordinate_transformation_mode,
+                                                 float cubic_coeff_a, bool exclude_outside,
+                                                 float extrapolation_value) {
+  const int64_t planes = dims[0] * dims[1];
+  const int64_t in_sizes[] = {dims[2], dims[3]};
+  const int64_t out_sizes[] = {static_cast<int64_t>(dims[2] * scales[2]), static_cast<int64_t>(dims[3] * scales[3])};
+  const bool use_extrapolation = coordinate_transformation_mode == "tf_crop_and_resize";
+
+  // original coordinate, input positions and normalized coefficients of each output position of an axis
+  struct AxisCoeffs {
+    std::vector<float> original;
+    std::vector<std::array<int64_t, 4>> index;
+    std::vector<std::array<float, 4>> coeff;
+    std::vector<float> coeff_sum;
+  };
+  AxisCoeffs axes[2];
+  for (size_t axis = 0; axis < 2; ++axis) {
+    const float scale = scales[axis + 2];
+    const auto in_size = static_cast<float>(in_sizes[axis]);
+    const auto out_size = static_cast<float>(out_sizes[axis]);
+    for (int64_t o = 0; o < out_sizes[axis]; ++o) {
+      const auto x = static_cast<float>(o);
+      float in = ((x + 0.5f) / scale) - 0.5f;
+      if (coordinate_transformation_mode == "asymmetric") {
+        in = x / scale;
+      } else if (use_extrapolation) {
+        const float roi_start = roi[axis + 2];
+        const float roi_end = roi[axis + 6];
+        in = static_cast<float>(out_size > 1 ? roi_start * (in_size - 1) +
+                                                   (x * (roi_end - roi_start) * (in_size - 1)) / (out_size - 1)
+                                             : 0.5 * (roi_start + roi_end) * (in_size - 1));
+      }
+
+      const auto in_int = static_cast<int64_t>(std::floor(in));
+      const float s = std::abs(in - static_cast<float>(in_int));
+      const float a = cubic_coeff_a;
+      std::array<float, 4> coeff{
+          ((a * (s + 1) - 5 * a) * (s + 1) + 8 * a) * (s + 1) - 4 * a,
+          ((a + 2) * s - (a + 3)) * s * s + 1,
+          ((a + 2) * (1 - s) - (a + 3)) * (1 - s) * (1 - s) + 1,
+          ((a * (2 - s) - 5 * a) * (2 - s) + 8 * a) * (2 - s) - 4 * a};
+      std::array<int64_t, 4> index;
+      float coeff_sum = exclude_outside ? 0.0f : 1.0f;
+      for (int64_t i = 0; i < 4; ++i) {
+        const int64_t in_val = in_int - 1 + i;
+        if (exclude_outside) {
+          coeff[i] = (in_val < 0 || in_val >= in_sizes[axis]) ? 0.0f : coeff[i];
+          coeff_sum += coeff[i];
+        }
+        index[i] = std::max<int64_t>(0, std::min(in_val, in_sizes[axis] - 1));
+      }
+      axes[axis].original.push_back(in);
+      axes[axis].index.push_back(index);
+      axes[axis].coeff.push_back(coeff);
+      axes[axis].coeff_sum.push_back(coeff_sum);
+    }
+  }
+
+  std::vector<float> Y;
+  for (int64_t p = 0; p < planes; ++p) {
+    const float* plane = X.data() + p * in_sizes[0] * in_sizes[1];
+    for (int64_t y = 0; y < out_sizes[0]; ++y) {
+      for (int64_t x = 0; x < out_sizes[1]; ++x) {
+        const float in_y = axes[0].original[y];
+        const float in_x = axes[1].original[x];
+        if (use_extrapolation && (in_y < 0 || in_y > static_cast<float>(in_sizes[0] - 1) ||
+                                  in_x < 0 || in_x > static_cast<float>(in_sizes[1] - 1))) {
+          Y.push_back(extrapolation_value);
+          continue;
+        }
+        float result = 0;
+        for (size_t i = 0; i < 4; ++i) {
+          const float* row = plane + axes[0].index[y][i] * in_sizes[1];
+          float x_result = 0;
+          for (size_t j = 0; j < 4; ++j) {
+            x_result += axes[1].coeff[x][j] / axes[1].coeff_sum[x] * row[axes[1].index[x][j]];
+          }
+          result += x_result * axes[0].coeff[y][i] / axes[0].coeff_sum[y];
+        }
+        Y.push_back(result);
+      }
+    }
+  }
+  return Y;
+}
+
+// Resizes enough channels and rows to be split between threads with the bicubic CPU kernel, and compares the result
+// with ResizeBicubicReference.
+static void TestResizeBicubicWithReference(const std::vector<float>& scales, const std::vector<float>& roi,
+                                           const std::string& coordinate_transformation_mode, float cubic_coeff_a,
+                                           bool exclude_outside, float extrapolation_value) {
+  const std::vector<int64_t> dims{2, 3, 10, 12};
+  std::vector<float> X(static_cast<size_t>(dims[0] * dims[1] * dims[2] * dims[3]));
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i] = static_cast<float>((i * 37) % 101) / 10.0f - 5.0f;
+  }
+
+  OpTester test("Resize", 13);
+  test.AddAttribute("mode", "cubic");
+  test.AddAttribute("coordinate_transformation_mode", coordinate_transformation_mode);
+  test.AddAttribute("cubic_coeff_a", cubic_coeff_a);
+  test.AddAttribute("exclude_outside", static_cast<int64_t>(exclude_outside ? 1 : 0));
+  test.AddAttribute("extrapolation_value", extrapolation_value);
+
+  test.AddInput<float>("X", dims, X);
+  test.AddInput<float>("roi", {static_cast<int64_t>(roi.size())}, roi);
+  test.AddInput<float>("scales", {4}, scales);
+
+  const std::vector<int64_t> output_dims{dims[0], dims[1], static_cast<int64_t>(dims[2] * scales[2]),
+                                         static_cast<int64_t>(dims[3] * scales[3])};
+  test.AddOutput<float>("Y", output_dims,
+                        ResizeBicubicReference(X, dims, scales, roi, coordinate_transformation_mode, cubic_coeff_a,
+                                               exclude_outside, extrapolation_value));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+TEST(ResizeOpTest, ResizeOpCubicTest_exclude_outside_MultiChannel) {
+  TestResizeBicubicWithReference({1.0f, 1.0f, 0.75f, 1.5f}, {}, "half_pixel", -0.5f, true, 0.0f);
+}
+
+TEST(ResizeOpTest, ResizeOpCubicTest_tf_crop_and_resize_extrapolation_MultiChannel) {
+  TestResizeBicubicWithReference({1.0f, 1.0f, 1.25f, 1.25f}, {0.0f, 0.0f, -0.2f, 0.1f, 1.0f, 1.0f, 0.9f, 1.3f},
+                                 "tf_crop_and_resize", -0.75f, false, 10.0f);
+}
+
+TEST(ResizeOpTest, ResizeOpCubicTest_coeff_MultiChannel) {
+  TestResizeBicubicWithReference({1.0f, 1.0f, 1.75f, 0.625f}, {}, "asymmetric", -0.6f, false, 0.0f);
+}
+
 TEST(ResizeOpTest, ResizeOpLinearDownSampleTest_4DBilinear_Ver10) {
   // TODO: Unskip when fixed #41968513
   if (DefaultDmlExecutionProvider().get() != nullptr) {
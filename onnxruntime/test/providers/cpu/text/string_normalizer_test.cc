@@ -194,6 +194,27 @@ TEST(ContribOpTest, StringNormalizerInsensitiveFilterOutUpperWithLocale) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+TEST(ContribOpTest, StringNormalizerInsensitiveFilterOutLowerManyRows) {
+  // - case-INSENSITIVE approach en_US locale
+  // - enough rows to be split across threads, a mix of ASCII and non-ASCII strings
+  // - filter out Monday and École in any case
+  // - LOWER
+  OpTester test("StringNormalizer", opset_ver, domain);
+  InitTestAttr(test, "LOWER", false, {"Monday", "école"}, test_locale);
+
+  const std::vector<std::string> words = {"MONDAY", "Tuesday", "ÉCOLE", "Besançon", "WEDNESDAY", "Понедельник"};
+  const std::vector<std::string> expected = {"tuesday", "besançon", "wednesday", "понедельник"};
+  std::vector<std::string> input;
+  std::vector<std::string> output;
+  for (int i = 0; i < 200; ++i) {
+    input.insert(input.end(), words.begin(), words.end());
+    output.insert(output.end(), expected.begin(), expected.end());
+  }
+  test.AddInput<std::string>("T", {static_cast<int64_t>(input.size())}, input);
+  test.AddOutput<std::string>("Y", {static_cast<int64_t>(output.size())}, output);
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 TEST(ContribOpTest, StringNormalizerSensitiveFilterOutUpperEmptyCase) {
   // Empty output case
   // - casesensitive approach
@@ -2829,6 +2829,43 @@ TEST(CApiTest, fill_string_tensor_directly) {
   }
 }
 
+TEST(CApiTest, fill_string_tensor_from_buffer) {
+  constexpr std::string_view s[] = {"This", "is", "", "a", "test"};
+  constexpr int64_t expected_len = 5;
+  const std::string buffer = "Thisisatest";
+  const size_t offsets[] = {0, 4, 6, 6, 7};
+
+  MockedOrtAllocator default_allocator;
+  Ort::Value tensor = Ort::Value::CreateTensor(&default_allocator, &expected_len, 1U,
+                                               ONNX_TENSOR_ELEMENT_DATA_TYPE_STRING);
+  tensor.FillStringTensorFromBuffer(buffer.data(), buffer.size(), offsets, expected_len);
+
+  for (size_t i = 0; i < expected_len; i++) {
+    ASSERT_EQ(s[i], tensor.GetStringTensorElement(i));
+  }
+
+  // round trip through GetStringTensorContent
+  std::string content(tensor.GetStringTensorDataLength(), '\0');
+  std::vector<size_t> content_offsets(expected_len);
+  tensor.GetStringTensorContent(content.data(), content.size(), content_offsets.data(), content_offsets.size());
+  ASSERT_EQ(buffer, content);
+  ASSERT_TRUE(std::equal(content_offsets.begin(), content_offsets.end(), std::begin(offsets)));
+
+  // decreasing offsets are rejected
+  const size_t bad_offsets[] = {0, 4, 2, 6, 7};
+  ASSERT_THROW(tensor.FillStringTensorFromBuffer(buffer.data(), buffer.size(), bad_offsets, expected_len),
+               Ort::Exception);
+  ASSERT_EQ(s[1], tensor.GetStringTensorElement(1));
+
+  // so are offsets past the end of the buffer and a count that doesn't match the tensor
+  const size_t out_of_range_offsets[] = {0, 4, 6, 6, 12};
+  ASSERT_THROW(tensor.FillStringTensorFromBuffer(buffer.data(), buffer.size(), out_of_range_offsets, expected_len),
+               Ort::Exception);
+  ASSERT_THROW(tensor.FillStringTensorFromBuffer(buffer.data(), buffer.size(), offsets, expected_len - 1),
+               Ort::Exception);
+  ASSERT_EQ(s[4], tensor.GetStringTensorElement(4));
+}
+
 TEST(CApiTest, get_string_tensor_element) {
   const char* s[] = {"abc", "kmp"};
   constexpr int64_t expected_len = 2;